@@ -0,0 +1,650 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "pid.hpp"
+#include "pid_schedule.hpp"
+
+extern "C"
+{
+#include "pid_cascade.h"
+#include "pid_checkpoint.h"
+#include "pid_farm.h"
+#include "pid_pool.h"
+#include "pid_seqlock.h"
+#include "pid_shm.h"
+#include "pid_simd.h"
+#include "pid_state.h"
+#include "pid_steal.h"
+#include "pid_swap.h"
+#include "pid_trace.h"
+}
+
+/**
+ * @brief Microbenchmarks of the controller hot path. Results are written to stdout as JSON, one object per
+ *        benchmark, and as a table to stderr. Usage: pidBench [--filter <substring>] [--min-time <ms>]
+ */
+
+struct Result
+{
+    std::string name;
+    uint64_t controllers;
+    uint64_t steps;
+    double nsPerStep;
+    double stepsPerSec;
+    double cyclesPerStep;
+};
+
+static std::vector<Result> results;
+static std::string filter;
+static double minTimeNs = 100e6;
+static volatile float sink;
+
+static uint64_t read_cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Runs pass() until at least minTimeNs have elapsed and records the cost of one controller step.
+ *
+ * @param name benchmark name
+ * @param controllers number of controller steps performed by one call of pass()
+ * @param pass runs one step of every controller
+ */
+template <typename Pass> static void measure(const std::string &name, uint64_t controllers, Pass pass)
+{
+    if (!filter.empty() && (name.find(filter) == std::string::npos))
+    {
+        return;
+    }
+
+    // Warm up caches and branch predictors
+    pass(0);
+
+    uint64_t passes = 0;
+    uint64_t batch = 1;
+    double ns = 0;
+    uint64_t cycles = 0;
+    while (ns < minTimeNs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t startCycles = read_cycles();
+        for (uint64_t i = 0; i < batch; i++)
+        {
+            pass(passes + i);
+        }
+        cycles += read_cycles() - startCycles;
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        passes += batch;
+        batch *= 2;
+    }
+
+    uint64_t steps = passes * controllers;
+    Result result = {name, controllers, steps, ns / steps, 1e9 * steps / ns, double(cycles) / steps};
+    fprintf(stderr, "%-40s %9.3f ns/step %14.0f steps/s %8.2f cycles/step\n", result.name.c_str(), result.nsPerStep,
+            result.stepsPerSec, result.cyclesPerStep);
+    results.push_back(result);
+}
+
+static const PIDTypeDef_t VOLTAGE_STAGE = {
+    .kI = 0.01, .KP = 0.5, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+static const PIDTypeDef_t CURRENT_STAGE = {.kI = 0.05, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+
+/**
+ * @brief Measurement of a bay at a given pass, moving slightly so that no state settles into a fixed point or
+ *        decays into subnormals
+ */
+static inline float voltage_at(uint64_t pass, uint64_t controller)
+{
+    return 45.0f + (0.004f * float(controller & 1023)) + (0.001f * float(pass & 7));
+}
+
+static void bench_scalar()
+{
+    // Single controller, each step depends on the previous one: latency of one step
+    PIDTypeDef_t single = VOLTAGE_STAGE;
+    measure("scalar/single", 1, [&](uint64_t pass) { sink = calc_pid_output(&single, voltage_at(pass, 0)); });
+
+    // Independent controllers: throughput of one step
+    const uint32_t count = 1024;
+    std::vector<PIDTypeDef_t> bank(count, VOLTAGE_STAGE);
+    measure("scalar/throughput", count, [&](uint64_t pass) {
+        float acc = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            acc += calc_pid_output(&bank[i], voltage_at(pass, i));
+        }
+        sink = acc;
+    });
+
+    std::vector<PIDTypeDef_t> pid(count, VOLTAGE_STAGE);
+    std::vector<PIDDerivativeTypeDef_t> derivative(count, {.filterCoefficient = 0.2});
+    for (PIDTypeDef_t &pidObject : pid)
+    {
+        pidObject.kD = 2;
+    }
+    measure("scalar/derivative", count, [&](uint64_t pass) {
+        float acc = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            acc += calc_pid_output_derivative(&pid[i], &derivative[i], voltage_at(pass, i));
+        }
+        sink = acc;
+    });
+
+    std::vector<pid::Controller<float, pid::Mode::PI>> templatePi(count, pid::Controller<float>(VOLTAGE_STAGE));
+    measure("template/pi", count, [&](uint64_t pass) {
+        float acc = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            acc += templatePi[i].step(voltage_at(pass, i));
+        }
+        sink = acc;
+    });
+
+    // A measurement held for 1000 samples, stepped in closed form: cost per simulated step
+    PIDTypeDef_t held = VOLTAGE_STAGE;
+    measure("advance/1000", 1000, [&](uint64_t pass) { sink = advance_pid_output(&held, voltage_at(pass, 0), 1000); });
+}
+
+static void bench_saturation()
+{
+    const uint32_t count = 1024;
+
+    // Measurement far below the reference: both saturations clamp to the upper limit every step
+    std::vector<PIDTypeDef_t> saturated(count, VOLTAGE_STAGE);
+    measure("saturation/upper", count, [&](uint64_t pass) {
+        float acc = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            acc += calc_pid_output(&saturated[i], 39.6f + (0.001f * float(pass & 7)));
+        }
+        sink = acc;
+    });
+
+    // Limits far away: neither saturation ever clamps
+    PIDTypeDef_t wide = VOLTAGE_STAGE;
+    wide.upperLimit = 1e30f;
+    wide.lowerLimit = -1e30f;
+    std::vector<PIDTypeDef_t> unsaturated(count, wide);
+    measure("saturation/none", count, [&](uint64_t pass) {
+        float acc = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            acc += calc_pid_output(&unsaturated[i], voltage_at(pass, i));
+            unsaturated[i].previousOutput = 0;
+        }
+        sink = acc;
+    });
+
+    // Alternating per controller so the branch predictor cannot learn the pattern
+    std::vector<PIDTypeDef_t> mixed(count, VOLTAGE_STAGE);
+    measure("saturation/mixed", count, [&](uint64_t pass) {
+        float acc = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float measurement = (((i * 2654435761u) >> 7) & 1) ? 39.6f : 60.0f;
+            acc += calc_pid_output(&mixed[i], measurement + (0.001f * float(pass & 7)));
+        }
+        sink = acc;
+    });
+}
+
+static void bench_cascade()
+{
+    const uint32_t count = 1024;
+
+    std::vector<PIDTypeDef_t> voltageStages(count, VOLTAGE_STAGE);
+    std::vector<PIDTypeDef_t> currentStages(count, CURRENT_STAGE);
+    measure("cascade/hand_wired", count, [&](uint64_t pass) {
+        float acc = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            currentStages[i].referencePoint = calc_pid_output(&voltageStages[i], voltage_at(pass, i));
+            acc += calc_pid_output(&currentStages[i], 1.5f);
+        }
+        sink = acc;
+    });
+
+    std::vector<PIDCascadeTypeDef_t> cascades(count);
+    for (PIDCascadeTypeDef_t &cascade : cascades)
+    {
+        load_cascade_stages(&cascade, &VOLTAGE_STAGE, &CURRENT_STAGE);
+    }
+    std::vector<float> voltage(count);
+    std::vector<float> current(count, 1.5f);
+    std::vector<float> phase(count);
+    measure("cascade/fused_batch", count, [&](uint64_t pass) {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            voltage[i] = voltage_at(pass, i);
+        }
+        calc_cascade_output_batch(cascades.data(), count, voltage.data(), current.data(), phase.data());
+        sink = phase[count - 1];
+    });
+}
+
+/**
+ * @brief Structure-of-arrays bank with its own storage
+ */
+struct Bank
+{
+    std::vector<float> kI, KP, upperLimit, lowerLimit, error, referencePoint, previousError, previousOutput;
+    std::vector<float> measurement, output;
+    PIDBankTypeDef_t bank;
+
+    explicit Bank(uint32_t count)
+        : kI(count, VOLTAGE_STAGE.kI), KP(count, VOLTAGE_STAGE.KP), upperLimit(count, VOLTAGE_STAGE.upperLimit),
+          lowerLimit(count, VOLTAGE_STAGE.lowerLimit), error(count), referencePoint(count, VOLTAGE_STAGE.referencePoint),
+          previousError(count), previousOutput(count), measurement(count), output(count)
+    {
+        bank = {kI.data(), KP.data(), upperLimit.data(), lowerLimit.data(), error.data(), referencePoint.data(),
+                previousError.data(), previousOutput.data(), count};
+        for (uint32_t i = 0; i < count; i++)
+        {
+            measurement[i] = voltage_at(0, i);
+        }
+    }
+};
+
+static const char *simd_level_name(PIDSimdLevel_t level)
+{
+    switch (level)
+    {
+    case PID_SIMD_NEON:
+        return "neon";
+    case PID_SIMD_AVX2:
+        return "avx2";
+    case PID_SIMD_AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+static void bench_batch()
+{
+    const PIDSimdLevel_t original = get_pid_simd_level();
+    const PIDSimdLevel_t levels[] = {PID_SIMD_SCALAR, PID_SIMD_NEON, PID_SIMD_AVX2, PID_SIMD_AVX512};
+
+    for (uint32_t count = 1; count <= (1u << 20); count *= 16)
+    {
+        Bank bank(count);
+        for (PIDSimdLevel_t level : levels)
+        {
+            if (!set_pid_simd_level(level))
+            {
+                continue;
+            }
+
+            std::string name = std::string("batch/") + simd_level_name(level) + "/" + std::to_string(count);
+            measure(name, count, [&](uint64_t pass) {
+                bank.measurement[pass % count] += (pass & 1) ? 0.001f : -0.001f;
+                calc_pid_output_batch(&bank.bank, bank.measurement.data(), bank.output.data());
+                sink = bank.output[0];
+            });
+        }
+
+        std::vector<PIDGainProfileTypeDef_t> profiles(1);
+        std::vector<PIDStateTypeDef_t> states(count);
+        PIDTypeDef_t voltageStage = VOLTAGE_STAGE;
+        split_pid_object(&voltageStage, 0, &profiles[0], &states[0]);
+        for (PIDStateTypeDef_t &state : states)
+        {
+            state = states[0];
+        }
+        measure("hot_state/" + std::to_string(count), count, [&](uint64_t pass) {
+            bank.measurement[pass % count] += (pass & 1) ? 0.001f : -0.001f;
+            calc_pid_state_output_batch(profiles.data(), states.data(), count, NULL, bank.measurement.data(),
+                                        bank.output.data());
+            sink = bank.output[0];
+        });
+    }
+
+    set_pid_simd_level(original);
+}
+
+static void bench_quiescent()
+{
+    // Idle bays sit saturated at a constant voltage, busy ones move around the reference every pass
+    const uint32_t count = 4096;
+    const uint32_t idlePercents[] = {0, 50, 90, 100};
+    for (uint32_t idlePercent : idlePercents)
+    {
+        Bank bank(count);
+        const uint32_t idleBays = count * idlePercent / 100;
+        std::vector<uint32_t> active(count);
+        std::vector<uint32_t> idle(count);
+        std::vector<float> cachedOutput(count);
+        PIDBankQuiescenceTypeDef_t quiescence = {active.data(), 0, idle.data(), 0, cachedOutput.data(), 0};
+        reset_pid_bank_quiescence(&quiescence, count);
+
+        measure("quiescent/" + std::to_string(idlePercent) + "%idle", count, [&](uint64_t pass) {
+            for (uint32_t i = idleBays; i < count; i++)
+            {
+                bank.measurement[i] = 49.6f + (0.001f * float((pass + i) & 7)) - 0.004f;
+            }
+            calc_pid_output_batch_quiescent(&bank.bank, &quiescence, bank.measurement.data(), bank.output.data());
+            sink = bank.output[0];
+        });
+    }
+}
+
+static void bench_schedule()
+{
+    static constexpr PIDScheduleBreakpointTypeDef_t breakpoints[] = {
+        {40, {.kI = 1.0, .KP = 6, .upperLimit = 3, .lowerLimit = 0}},
+        {48, {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0}},
+        {56, {.kI = 0.5, .KP = 2, .upperLimit = 1, .lowerLimit = -1}},
+    };
+    static constexpr auto schedule = pid::make_schedule<64>(40.0f, 56.0f, breakpoints);
+    const PIDScheduleTableTypeDef_t table = schedule.view();
+
+    PIDTypeDef_t voltageStage = VOLTAGE_STAGE;
+    measure("schedule/scalar", 1, [&](uint64_t pass) {
+        float voltage = voltage_at(pass, 0);
+        apply_pid_schedule(&table, &voltageStage, voltage);
+        sink = calc_pid_output(&voltageStage, voltage);
+    });
+
+    const uint32_t count = 4096;
+    Bank bank(count);
+    measure("schedule/batch/" + std::to_string(count), count, [&](uint64_t pass) {
+        bank.measurement[pass % count] += (pass & 1) ? 0.001f : -0.001f;
+        apply_pid_schedule_batch(&table, &bank.bank, bank.measurement.data());
+        calc_pid_output_batch(&bank.bank, bank.measurement.data(), bank.output.data());
+        sink = bank.output[0];
+    });
+}
+
+static void bench_trace()
+{
+    PIDTypeDef_t plain = VOLTAGE_STAGE;
+    measure("trace/off", 1, [&](uint64_t pass) { sink = calc_pid_output(&plain, voltage_at(pass, 0)); });
+
+    // A large ring polled inline keeps the consumer out of the measurement
+    PIDTraceRingTypeDef_t *ring = create_pid_trace_ring(1 << 16);
+    std::vector<PIDTraceRecordTypeDef_t> drained(1 << 16);
+    PIDTypeDef_t traced = VOLTAGE_STAGE;
+    measure("trace/on", 1, [&](uint64_t pass) {
+        sink = calc_pid_output_traced(&traced, voltage_at(pass, 0), ring, 0);
+        if ((pass & 0xFFFF) == 0xFFFF)
+        {
+            pop_pid_trace_batch(ring, drained.data(), drained.size());
+        }
+    });
+
+    destroy_pid_trace_ring(ring);
+}
+
+static void bench_seqlock()
+{
+    PIDTypeDef_t plain = VOLTAGE_STAGE;
+    measure("seqlock/off", 1, [&](uint64_t pass) { sink = calc_pid_output(&plain, voltage_at(pass, 0)); });
+
+    PIDSeqlockTypeDef_t *seqlock = create_pid_seqlock(1);
+    PIDTypeDef_t published = VOLTAGE_STAGE;
+    measure("seqlock/on", 1, [&](uint64_t pass) {
+        sink = calc_pid_output_published(&published, voltage_at(pass, 0), seqlock, 0);
+    });
+
+    // A monitoring thread polling the slot pulls its cache line away from the writer
+    std::atomic<bool> done(false);
+    std::thread reader([&]() {
+        PIDSnapshotTypeDef_t snapshot;
+        while (!done.load(std::memory_order_relaxed))
+        {
+            read_pid_snapshot(seqlock, 0, &snapshot);
+        }
+    });
+    measure("seqlock/on+reader", 1, [&](uint64_t pass) {
+        sink = calc_pid_output_published(&published, voltage_at(pass, 0), seqlock, 0);
+    });
+    done.store(true, std::memory_order_relaxed);
+    reader.join();
+
+    destroy_pid_seqlock(seqlock);
+}
+
+static void bench_swap()
+{
+    PIDTypeDef_t plain = VOLTAGE_STAGE;
+    measure("swap/off", 1, [&](uint64_t pass) { sink = calc_pid_output(&plain, voltage_at(pass, 0)); });
+
+    PIDGainProfileTypeDef_t profile;
+    PIDStateTypeDef_t state;
+    split_pid_object(&VOLTAGE_STAGE, 0, &profile, &state);
+    PIDProfileSwapTypeDef_t *swap = create_pid_profile_swap(&profile, 1);
+    PIDTypeDef_t swapped = VOLTAGE_STAGE;
+    measure("swap/on", 1, [&](uint64_t pass) {
+        sink = calc_pid_output_profile(&swapped, acquire_pid_profile(swap, 0), voltage_at(pass, 0));
+    });
+
+    // A new profile every 1024 steps, published from the loop itself to keep the measurement single threaded
+    measure("swap/publish-every-1024", 1, [&](uint64_t pass) {
+        if ((pass & 1023) == 0)
+        {
+            profile.KP = (pass & 1024) ? 4.0f : 3.5f;
+            publish_pid_profile(swap, &profile);
+        }
+        sink = calc_pid_output_profile(&swapped, acquire_pid_profile(swap, 0), voltage_at(pass, 0));
+    });
+
+    destroy_pid_profile_swap(swap);
+}
+
+static void bench_shm()
+{
+    // Producer and consumer in one thread: the cost of the rings themselves, without scheduling, per channel
+    const uint32_t channels = 64;
+    const std::string name = "/pidBench-" + std::to_string(getpid());
+    PIDShmTypeDef_t shm;
+    if (create_pid_shm(name.c_str(), channels, 1024, &shm) != 0)
+    {
+        return;
+    }
+
+    Bank bank(channels);
+    measure("shm/loopback/" + std::to_string(channels), channels, [&](uint64_t pass) {
+        PIDShmFrameTypeDef_t *frame = begin_pid_shm_write(&shm, PID_SHM_MEASUREMENT);
+        float *values = pid_shm_frame_values(frame);
+        for (uint32_t i = 0; i < channels; i++)
+        {
+            values[i] = voltage_at(pass, i);
+        }
+        commit_pid_shm_write(&shm, PID_SHM_MEASUREMENT, pass);
+
+        step_pid_shm_batch(&bank.bank, &shm, 1);
+        sink = pid_shm_frame_const_values(peek_pid_shm_frame(&shm, PID_SHM_OUTPUT))[0];
+        release_pid_shm_frame(&shm, PID_SHM_OUTPUT);
+    });
+
+    close_pid_shm(&shm);
+    unlink_pid_shm(name.c_str());
+}
+
+static void bench_checkpoint()
+{
+    const uint32_t count = 4096;
+    const std::string path = "/tmp/pidBench-" + std::to_string(getpid()) + ".ckpt";
+    PIDCheckpointTypeDef_t checkpoint;
+    if (create_pid_checkpoint(path.c_str(), count, &checkpoint) != 0)
+    {
+        return;
+    }
+
+    Bank bank(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        load_pid_bank_entry(&checkpoint.bank, i, &VOLTAGE_STAGE);
+    }
+
+    // Stepping in place in the mapping against the same bank in anonymous memory
+    measure("checkpoint/step/" + std::to_string(count), count, [&](uint64_t pass) {
+        bank.measurement[pass % count] += (pass & 1) ? 0.001f : -0.001f;
+        calc_pid_output_batch(&checkpoint.bank, bank.measurement.data(), bank.output.data());
+        sink = bank.output[0];
+    });
+    close_pid_checkpoint(&checkpoint);
+
+    // A restart: map, check the header, and seal again with the column checksum on close
+    measure("checkpoint/open-close/" + std::to_string(count), count, [&](uint64_t) {
+        open_pid_checkpoint(path.c_str(), &checkpoint);
+        sink = checkpoint.bank.previousOutput[0];
+        close_pid_checkpoint(&checkpoint);
+    });
+
+    unlink(path.c_str());
+}
+
+static void bench_pool()
+{
+    const uint32_t count = 4096;
+
+    // Controllers malloc'd one by one between other allocations and stepped in plug-in order, as bays come and go
+    std::vector<PIDTypeDef_t *> scattered(count);
+    std::vector<void *> other;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        other.push_back(malloc(16 + ((i * 37) % 200)));
+        scattered[i] = static_cast<PIDTypeDef_t *>(malloc(sizeof(PIDTypeDef_t)));
+        *scattered[i] = VOLTAGE_STAGE;
+    }
+    for (uint32_t i = count - 1; i > 0; i--)
+    {
+        std::swap(scattered[i], scattered[(i * 2654435761u) % (i + 1)]);
+    }
+
+    Bank bank(count);
+    measure("pool/malloc/" + std::to_string(count), count, [&](uint64_t pass) {
+        bank.measurement[pass % count] += (pass & 1) ? 0.001f : -0.001f;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            bank.output[i] = calc_pid_output(scattered[i], bank.measurement[i]);
+        }
+        sink = bank.output[0];
+    });
+
+    // The same churn through the pool leaves the survivors dense
+    PIDPoolTypeDef_t *pool = create_pid_pool(2 * count);
+    std::vector<PIDPoolHandleTypeDef_t> handles;
+    for (uint32_t i = 0; i < 2 * count; i++)
+    {
+        handles.push_back(add_pid_pool_controller(pool, &VOLTAGE_STAGE));
+    }
+    for (uint32_t i = 0; i < 2 * count; i += 2)
+    {
+        remove_pid_pool_controller(pool, handles[i]);
+    }
+
+    measure("pool/dense/" + std::to_string(count), count, [&](uint64_t pass) {
+        bank.measurement[pass % count] += (pass & 1) ? 0.001f : -0.001f;
+        calc_pid_pool_output(pool, bank.measurement.data(), bank.output.data());
+        sink = bank.output[0];
+    });
+
+    destroy_pid_pool(pool);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        free(scattered[i]);
+        free(other[i]);
+    }
+}
+
+static void bench_farm()
+{
+    // Bays grow with the workers, so a flat ns/step times bays per worker means a flat tick completion time
+    const uint32_t baysPerWorker = 4096;
+    for (uint32_t workers = 1; workers <= get_pid_hardware_threads(); workers *= 2)
+    {
+        const uint32_t bays = workers * baysPerWorker;
+        PIDFarmConfigTypeDef_t config = {.workers = workers, .capacity = bays, .pin = 1};
+        PIDFarmTypeDef_t *farm = create_pid_farm(&config);
+        if (farm == NULL)
+        {
+            continue;
+        }
+
+        std::vector<float> measurement(bays);
+        std::vector<float> output(bays);
+        for (uint32_t i = 0; i < bays; i++)
+        {
+            add_pid_farm_bay(farm, &VOLTAGE_STAGE);
+            measurement[i] = voltage_at(0, i);
+        }
+
+        measure("farm/" + std::to_string(workers) + "/" + std::to_string(bays), bays, [&](uint64_t pass) {
+            measurement[pass % bays] += (pass & 1) ? 0.001f : -0.001f;
+            run_pid_farm_tick(farm, measurement.data(), output.data());
+            sink = output[0];
+        });
+
+        destroy_pid_farm(farm);
+    }
+}
+
+static void write_json()
+{
+    printf("{\n  \"simd_level\": \"%s\",\n  \"benchmarks\": [\n", simd_level_name(get_pid_simd_level()));
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        printf("    {\"name\": \"%s\", \"controllers\": %llu, \"steps\": %llu, \"ns_per_step\": %.4f, "
+               "\"steps_per_sec\": %.1f, \"cycles_per_step\": %.4f}%s\n",
+               r.name.c_str(), (unsigned long long)r.controllers, (unsigned long long)r.steps, r.nsPerStep,
+               r.stepsPerSec, r.cyclesPerStep, (i + 1 < results.size()) ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--filter") == 0) && (i + 1 < argc))
+        {
+            filter = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--min-time") == 0) && (i + 1 < argc))
+        {
+            minTimeNs = atof(argv[++i]) * 1e6;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--filter <substring>] [--min-time <ms>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bench_scalar();
+    bench_saturation();
+    bench_cascade();
+    bench_batch();
+    bench_quiescent();
+    bench_schedule();
+    bench_trace();
+    bench_seqlock();
+    bench_swap();
+    bench_shm();
+    bench_checkpoint();
+    bench_pool();
+    bench_farm();
+
+    write_json();
+    return 0;
+}
@@ -1,4 +1,8 @@
 #include "pid.h"
+#include "pid_instr.h"
+#include "pid_internal.h"
+
+#include <math.h>
 
 static float calc_error(float reference, float currentOutput)
 {
@@ -7,21 +11,7 @@ static float calc_error(float reference, float currentOutput)
 
 static float saturate_output(PIDTypeDef_t *pidObject, float unsatOutput)
 {
-    float ret = 0;
-    if (unsatOutput > pidObject->upperLimit)
-    {
-        ret = pidObject->upperLimit;
-    }
-    else if (unsatOutput < pidObject->lowerLimit)
-    {
-        ret = pidObject->lowerLimit;
-    }
-    else
-    {
-        ret = unsatOutput;
-    }
-
-    return ret;
+    return pid_saturate(unsatOutput, pidObject->lowerLimit, pidObject->upperLimit);
 }
 
 static float calc_proportional(PIDTypeDef_t *pidObject)
@@ -44,6 +34,20 @@ static float calc_integral(PIDTypeDef_t *pidObject)
     return newOutput;
 }
 
+static float calc_derivative(PIDTypeDef_t *pidObject, PIDDerivativeTypeDef_t *derivativeObject, float currentOutput)
+{
+    // Derivative on measurement so that a reference step does not kick the output
+    float rawDerivative = -pidObject->kD * (currentOutput - derivativeObject->previousMeasurement);
+
+    float filtered = derivativeObject->derivative;
+    filtered += derivativeObject->filterCoefficient * (rawDerivative - filtered);
+
+    derivativeObject->derivative = filtered;
+    derivativeObject->previousMeasurement = currentOutput;
+
+    return filtered;
+}
+
 /**
  * @brief performs proportional and integral calculation based on a given pidObject and the current
  *        output.
@@ -54,6 +58,8 @@ static float calc_integral(PIDTypeDef_t *pidObject)
  */
 float calc_pid_output(PIDTypeDef_t *pidObject, float currentOutput)
 {
+    PID_INSTR_STEP_BEGIN(start);
+
     float error = calc_error(pidObject->referencePoint, currentOutput);
     pidObject->error = error;
 
@@ -62,9 +68,255 @@ float calc_pid_output(PIDTypeDef_t *pidObject, float currentOutput)
     float sum = proportional + integral;
     sum = saturate_output(pidObject, sum);
 
+    PID_INSTR_STEP_END(start);
     return sum;
 }
 
+/**
+ * @brief calc_pid_output that skips the step while the controller is quiescent. A recomputed step that leaves the
+ *        controller at a fixed point makes it quiescent; it stays so as long as the error stays within the deadband
+ *        of the error of that step, which also catches reference changes.
+ *
+ * @param pidObject representing a generic type which can be the voltage or the current stage
+ * @param quiescenceObject deadband and cached output of the controller
+ * @param currentOutput representing the current system output
+ * @param recomputed set to 1 if the step was computed, 0 if the cached output was returned, may be NULL
+ * @return float same as calc_pid_output with a deadband of 0
+ * @note call reset_pid_quiescence after changing gains or limits, the check only looks at the error
+ */
+float calc_pid_output_quiescent(PIDTypeDef_t *pidObject, PIDQuiescenceTypeDef_t *quiescenceObject,
+                                float currentOutput, uint8_t *recomputed)
+{
+    float error = calc_error(pidObject->referencePoint, currentOutput);
+    uint8_t skip = quiescenceObject->quiescent && (fabsf(error - pidObject->error) <= quiescenceObject->deadband);
+
+    if (recomputed != NULL)
+    {
+        *recomputed = !skip;
+    }
+
+    if (skip)
+    {
+        return quiescenceObject->output;
+    }
+
+    quiescenceObject->output = calc_pid_output(pidObject, currentOutput);
+    quiescenceObject->quiescent = pid_is_stable(pidObject->kI, pidObject->lowerLimit, pidObject->upperLimit,
+                                                pidObject->error, pidObject->previousError,
+                                                pidObject->previousOutput);
+
+    return quiescenceObject->output;
+}
+
+/**
+ * @brief performs proportional, integral and filtered derivative calculation. The derivative is taken on the
+ *        measurement, first-order low-pass filtered and added before the output saturation. There is no branch on
+ *        kD, with kD = 0 the result is the same as calc_pid_output.
+ *
+ * @param pidObject representing a generic type which can be the voltage or the current stage, provides kD
+ * @param derivativeObject memory of the derivative term
+ * @param currentOutput representing the current system output
+ * @return float
+ * @note call reset_pid_derivative_memory with the first measurement before the first step to avoid a derivative kick.
+ *       With a constant measurement the filtered derivative decays through subnormal values, enable flush-to-zero
+ *       on targets where those are slow.
+ */
+float calc_pid_output_derivative(PIDTypeDef_t *pidObject, PIDDerivativeTypeDef_t *derivativeObject,
+                                 float currentOutput)
+{
+    PID_INSTR_STEP_BEGIN(start);
+
+    float error = calc_error(pidObject->referencePoint, currentOutput);
+    pidObject->error = error;
+
+    float proportional = calc_proportional(pidObject);
+    float integral = calc_integral(pidObject);
+    float derivative = calc_derivative(pidObject, derivativeObject, currentOutput);
+    float sum = proportional + integral + derivative;
+    sum = saturate_output(pidObject, sum);
+
+    PID_INSTR_STEP_END(start);
+    return sum;
+}
+
+/**
+ * @brief whether a step from x to y stayed within one binade, where the float grid has a constant spacing. y must
+ *        not be the power of two at either end, there the rounding of the sum may have used the other spacing.
+ */
+static uint8_t is_same_binade(float x, float y)
+{
+    int xExponent = 0;
+    int yExponent = 0;
+    float yMantissa = frexpf(y, &yExponent);
+    frexpf(x, &xExponent);
+
+    return (x != 0) && (y != 0) && isfinite(x) && isfinite(y) && ((x < 0) == (y < 0)) && (xExponent == yExponent) &&
+           (fabsf(yMantissa) != 0.5f);
+}
+
+/**
+ * @brief gives the result of steps repetitions of output = saturate(increment + output), the integral step once
+ *        previousError holds kI * error, bit for bit. Within a binade the grid spacing is constant, so once two
+ *        consecutive steps inside it moved the output by the same amount every further step does, up to the binade
+ *        or the limit ahead; those steps are taken at once. Ties rounded to even can only repeat an even multiple
+ *        of the spacing, which keeps the parity and so the amount. An increment below half an ulp of the output
+ *        leaves it unchanged, as does a limit, and the loop stops at such a fixed point.
+ *
+ * @param pidObject provides the limits, not inverted
+ * @param output integral after the first step
+ * @param increment 2 * kI * error, exact in float
+ * @param steps number of further steps
+ * @return float integral after the steps
+ */
+static float advance_ramp(PIDTypeDef_t *pidObject, float output, float increment, uint64_t steps)
+{
+    double previousDelta = 0;
+    while (steps > 0)
+    {
+        float next = saturate_output(pidObject, increment + output);
+        steps--;
+
+        // Stalled, pinned at a limit or NaN: every further step gives the same
+        if ((next == output) || (next != next))
+        {
+            output = next;
+            break;
+        }
+
+        double delta = (double)next - (double)output;
+        uint8_t inBinade = is_same_binade(output, next);
+        uint8_t steady = inBinade && (delta == previousDelta);
+        previousDelta = inBinade ? delta : 0;
+        output = next;
+        if (!steady || (steps == 0))
+        {
+            continue;
+        }
+
+        // Stop short of the power of two ahead, the grid spacing changes there
+        int exponent = 0;
+        frexpf(output, &exponent);
+        uint8_t growing = (delta > 0) == (output > 0);
+        double boundary = copysign(ldexp(1.0, growing ? exponent : exponent - 1), (double)output);
+        double room = (boundary - (double)output) / delta;
+        double count = ceil(room) - 1;
+
+        // And do not pass the limit ahead, reaching it exactly is not a saturation
+        double limit = (delta > 0) ? (double)pidObject->upperLimit : (double)pidObject->lowerLimit;
+        count = fmin(count, floor((limit - (double)output) / delta));
+        count = fmin(count, (double)steps);
+        if (count > 0)
+        {
+            // Fewer than 2^24 multiples of the spacing, exact in double
+            output = (float)((double)output + (count * delta));
+            steps -= (uint64_t)count;
+        }
+    }
+
+    return output;
+}
+
+/**
+ * @brief advances the integral memories by steps steps with a constant error. After the first step previousError
+ *        holds kI * error, so every later step adds 2 * kI * error to the saturated integral, rounded to float as the
+ *        stepped controller does; see advance_ramp.
+ *
+ * @param pidObject controller with the error of the steps already set, limits must not be inverted
+ * @param steps number of steps, at least 1
+ */
+static void advance_integral(PIDTypeDef_t *pidObject, uint64_t steps)
+{
+    float newIntegral = pidObject->kI * pidObject->error;
+
+    // First step exactly as calc_integral
+    float output = newIntegral + pidObject->previousError + pidObject->previousOutput;
+    output = saturate_output(pidObject, output);
+
+    // Doubling is exact, newIntegral + previousError is this sum on every later step
+    output = advance_ramp(pidObject, output, newIntegral + newIntegral, steps - 1);
+
+    pidObject->previousError = newIntegral;
+    pidObject->previousOutput = output;
+}
+
+/**
+ * @brief returns the output of the last of steps calls of calc_pid_output with the same measurement and leaves the
+ *        controller in the state those calls would, in time that depends on the number of binades the integral
+ *        crosses rather than on steps. Meant for simulations that hold a measurement for many samples, e.g. a pinned
+ *        CC stage or a long CV tail.
+ *
+ * @param pidObject representing a generic type which can be the voltage or the current stage
+ * @param currentOutput system output held for all steps
+ * @param steps number of steps to advance, 0 leaves the controller untouched and returns 0
+ * @return float output of the last step, equal to the stepped result
+ * @note with inverted limits the steps are taken one by one
+ */
+float advance_pid_output(PIDTypeDef_t *pidObject, float currentOutput, uint64_t steps)
+{
+    if ((pidObject == NULL) || (steps == 0))
+    {
+        return 0;
+    }
+
+    if (pidObject->lowerLimit > pidObject->upperLimit)
+    {
+        float ret = 0;
+        for (uint64_t i = 0; i < steps; i++)
+        {
+            ret = calc_pid_output(pidObject, currentOutput);
+        }
+        return ret;
+    }
+
+    pidObject->error = calc_error(pidObject->referencePoint, currentOutput);
+    advance_integral(pidObject, steps);
+
+    return saturate_output(pidObject, calc_proportional(pidObject) + pidObject->previousOutput);
+}
+
+/**
+ * @brief same as advance_pid_output for calc_pid_output_derivative. With a constant measurement the raw derivative
+ *        is non-zero on the first step only, after which the filtered derivative decays by (1 - filterCoefficient)
+ *        per step.
+ *
+ * @param pidObject representing a generic type which can be the voltage or the current stage, provides kD
+ * @param derivativeObject memory of the derivative term
+ * @param currentOutput system output held for all steps
+ * @param steps number of steps to advance, 0 leaves the controller untouched and returns 0
+ * @return float output of the last step; the integral memories equal the stepped ones, the decayed derivative is
+ *         within float rounding of the stepped one
+ */
+float advance_pid_output_derivative(PIDTypeDef_t *pidObject, PIDDerivativeTypeDef_t *derivativeObject,
+                                    float currentOutput, uint64_t steps)
+{
+    if ((pidObject == NULL) || (derivativeObject == NULL) || (steps == 0))
+    {
+        return 0;
+    }
+
+    if (pidObject->lowerLimit > pidObject->upperLimit)
+    {
+        float ret = 0;
+        for (uint64_t i = 0; i < steps; i++)
+        {
+            ret = calc_pid_output_derivative(pidObject, derivativeObject, currentOutput);
+        }
+        return ret;
+    }
+
+    pidObject->error = calc_error(pidObject->referencePoint, currentOutput);
+    advance_integral(pidObject, steps);
+
+    float derivative = calc_derivative(pidObject, derivativeObject, currentOutput);
+    if (steps > 1)
+    {
+        derivative *= powf(1.0f - derivativeObject->filterCoefficient, (float)(steps - 1));
+        derivativeObject->derivative = derivative;
+    }
+
+    return saturate_output(pidObject, calc_proportional(pidObject) + pidObject->previousOutput + derivative);
+}
+
 /**
  * @brief This function resets the memory elements of the integral controller
  *
@@ -81,4 +333,36 @@ void reset_pid_memory(PIDTypeDef_t *pidObject)
     pidObject->error = 0;
     pidObject->previousOutput = 0;
     pidObject->previousError = 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief This function resets the memory elements of the derivative term, the filter coefficient is kept
+ *
+ * @param derivativeObject memory of the derivative term
+ * @param currentOutput measurement the next step is differentiated against, normally the latest measurement
+ */
+void reset_pid_derivative_memory(PIDDerivativeTypeDef_t *derivativeObject, float currentOutput)
+{
+    if (derivativeObject == NULL)
+    {
+        return;
+    }
+
+    derivativeObject->previousMeasurement = currentOutput;
+    derivativeObject->derivative = 0;
+}
+
+/**
+ * @brief makes the next calc_pid_output_quiescent recompute, the deadband is kept
+ *
+ * @param quiescenceObject quiescence tracking of a controller
+ */
+void reset_pid_quiescence(PIDQuiescenceTypeDef_t *quiescenceObject)
+{
+    if (quiescenceObject == NULL)
+    {
+        return;
+    }
+
+    quiescenceObject->quiescent = 0;
+}
@@ -1,6 +1,17 @@
+#ifndef PID_H
+#define PID_H
+
 #include <stdint.h>
 #include <stdio.h>
 
+#define PID_CACHE_LINE_SIZE 64
+
+#if defined(_MSC_VER)
+#define PID_CACHE_ALIGNED __declspec(align(PID_CACHE_LINE_SIZE))
+#else
+#define PID_CACHE_ALIGNED __attribute__((aligned(PID_CACHE_LINE_SIZE)))
+#endif
+
 typedef struct
 {
     float kI;
@@ -14,5 +25,38 @@ typedef struct
     float previousOutput;
 } PIDTypeDef_t;
 
+/**
+ * @brief Memory of the derivative term, kept next to a PIDTypeDef_t that provides kD. The derivative is taken on the
+ *        measurement and low-pass filtered with derivative += filterCoefficient * (raw - derivative).
+ */
+typedef struct
+{
+    float filterCoefficient; // 1 for an unfiltered derivative, smaller values filter harder
+    float previousMeasurement;
+    float derivative;
+} PIDDerivativeTypeDef_t;
+
+/**
+ * @brief Quiescence tracking of a controller. Once a step leaves the controller at a fixed point, further steps whose
+ *        error is within deadband of the error of that step return the cached output without recomputing.
+ */
+typedef struct
+{
+    float deadband; // 0 skips only steps that would give exactly the same result
+    float output;
+    uint8_t quiescent;
+} PIDQuiescenceTypeDef_t;
+
 float calc_pid_output(PIDTypeDef_t *pidObject, float currentOutput);
-void reset_pid_memory(PIDTypeDef_t *pidObject);
\ No newline at end of file
+float calc_pid_output_quiescent(PIDTypeDef_t *pidObject, PIDQuiescenceTypeDef_t *quiescenceObject,
+                                float currentOutput, uint8_t *recomputed);
+float calc_pid_output_derivative(PIDTypeDef_t *pidObject, PIDDerivativeTypeDef_t *derivativeObject,
+                                 float currentOutput);
+float advance_pid_output(PIDTypeDef_t *pidObject, float currentOutput, uint64_t steps);
+float advance_pid_output_derivative(PIDTypeDef_t *pidObject, PIDDerivativeTypeDef_t *derivativeObject,
+                                    float currentOutput, uint64_t steps);
+void reset_pid_memory(PIDTypeDef_t *pidObject);
+void reset_pid_derivative_memory(PIDDerivativeTypeDef_t *derivativeObject, float currentOutput);
+void reset_pid_quiescence(PIDQuiescenceTypeDef_t *quiescenceObject);
+
+#endif
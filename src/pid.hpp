@@ -0,0 +1,273 @@
+#ifndef PID_HPP
+#define PID_HPP
+
+extern "C"
+{
+#include "pid.h"
+}
+
+namespace pid
+{
+
+/**
+ * @brief Terms of the control law that are compiled in
+ */
+enum class Mode
+{
+    P,
+    I,
+    PI,
+    PID,
+};
+
+/**
+ * @brief Whether the integral and the output are clamped to [lowerLimit, upperLimit]
+ */
+enum class Saturation
+{
+    None,
+    Clamp,
+};
+
+namespace detail
+{
+
+constexpr bool has_proportional(Mode mode)
+{
+    return (mode == Mode::P) || (mode == Mode::PI) || (mode == Mode::PID);
+}
+
+constexpr bool has_integral(Mode mode)
+{
+    return (mode == Mode::I) || (mode == Mode::PI) || (mode == Mode::PID);
+}
+
+constexpr bool has_derivative(Mode mode)
+{
+    return mode == Mode::PID;
+}
+
+/**
+ * @brief Gains and memories of one term of the control law. The specializations for a term that is not compiled in
+ *        are empty bases, so a Controller only carries the fields its Mode uses.
+ */
+template <typename T, bool Enabled>
+struct ProportionalTerm
+{
+    T KP = 0;
+};
+
+template <typename T>
+struct ProportionalTerm<T, false>
+{
+};
+
+template <typename T, bool Enabled>
+struct IntegralTerm
+{
+    T kI = 0;
+    T previousError = 0;
+    T previousOutput = 0;
+};
+
+template <typename T>
+struct IntegralTerm<T, false>
+{
+};
+
+/**
+ * @brief see PIDDerivativeTypeDef_t
+ */
+template <typename T, bool Enabled>
+struct DerivativeTerm
+{
+    T kD = 0;
+    T filterCoefficient = 1;
+    T previousMeasurement = 0;
+    T derivative = 0;
+};
+
+template <typename T>
+struct DerivativeTerm<T, false>
+{
+};
+
+} // namespace detail
+
+/**
+ * @brief Header-only, compile-time specialized version of calc_pid_output. Terms disabled by Mode and the clamping
+ *        disabled by Saturation are removed at compile time and step() inlines into the caller. The gains and
+ *        memories of a disabled term are not members either: kI, previousError and previousOutput only exist with
+ *        an integral, KP with a proportional term and kD, filterCoefficient, previousMeasurement and derivative
+ *        with Mode::PID.
+ *
+ *        Controller<float, Mode::PI, Saturation::Clamp> gives exactly the results of calc_pid_output and
+ *        Controller<float, Mode::PID, Saturation::Clamp> those of calc_pid_output_derivative, provided the caller
+ *        is compiled with -ffp-contract=off like the library; linking pidLib adds the flag with GCC and Clang.
+ *        Mode::I matches calc_pid_output with KP = 0 for finite errors; an infinite error gives NaN in C (0 * inf)
+ *        and the saturated integral here. Mode::P matches calc_pid_output with kI = 0 and cleared
+ *        integral memories, provided 0 lies within the limits.
+ *
+ * @tparam T arithmetic type, e.g. float or double
+ * @tparam M terms of the control law
+ * @tparam S saturation policy
+ */
+template <typename T, Mode M = Mode::PI, Saturation S = Saturation::Clamp>
+struct Controller : detail::ProportionalTerm<T, detail::has_proportional(M)>,
+                    detail::IntegralTerm<T, detail::has_integral(M)>,
+                    detail::DerivativeTerm<T, detail::has_derivative(M)>
+{
+    static constexpr bool hasProportional = detail::has_proportional(M);
+    static constexpr bool hasIntegral = detail::has_integral(M);
+    static constexpr bool hasDerivative = detail::has_derivative(M);
+
+    T upperLimit = 0;
+    T lowerLimit = 0;
+    T error = 0;
+    T referencePoint = 0;
+
+    constexpr Controller() = default;
+
+    /**
+     * @brief copies the gains of the compiled-in terms, limits, reference and integral memories from a C controller.
+     *        The derivative memory is kept in PIDDerivativeTypeDef_t and starts cleared.
+     */
+    explicit constexpr Controller(const PIDTypeDef_t &pidObject)
+        : upperLimit(pidObject.upperLimit), lowerLimit(pidObject.lowerLimit), error(pidObject.error),
+          referencePoint(pidObject.referencePoint)
+    {
+        if constexpr (hasProportional)
+        {
+            this->KP = pidObject.KP;
+        }
+        if constexpr (hasIntegral)
+        {
+            this->kI = pidObject.kI;
+            this->previousError = pidObject.previousError;
+            this->previousOutput = pidObject.previousOutput;
+        }
+        if constexpr (hasDerivative)
+        {
+            this->kD = pidObject.kD;
+        }
+    }
+
+    /**
+     * @brief copies the controller back into a C controller. The gains and memories of the terms that are not
+     *        compiled in are left untouched.
+     */
+    void store(PIDTypeDef_t &pidObject) const
+    {
+        pidObject.upperLimit = static_cast<float>(upperLimit);
+        pidObject.lowerLimit = static_cast<float>(lowerLimit);
+        pidObject.error = static_cast<float>(error);
+        pidObject.referencePoint = static_cast<float>(referencePoint);
+        if constexpr (hasProportional)
+        {
+            pidObject.KP = static_cast<float>(this->KP);
+        }
+        if constexpr (hasIntegral)
+        {
+            pidObject.kI = static_cast<float>(this->kI);
+            pidObject.previousError = static_cast<float>(this->previousError);
+            pidObject.previousOutput = static_cast<float>(this->previousOutput);
+        }
+        if constexpr (hasDerivative)
+        {
+            pidObject.kD = static_cast<float>(this->kD);
+        }
+    }
+
+    /**
+     * @brief performs one step of the control law
+     *
+     * @param currentOutput representing the current system output
+     * @return T controller output
+     */
+    constexpr T step(T currentOutput) noexcept
+    {
+        error = referencePoint - currentOutput;
+
+        T sum = 0;
+        if constexpr (hasIntegral)
+        {
+            T newIntegral = this->kI * error;
+            T newOutput = saturate(newIntegral + this->previousError + this->previousOutput);
+
+            // Update the integral memories
+            this->previousError = newIntegral;
+            this->previousOutput = newOutput;
+
+            sum = newOutput;
+            if constexpr (hasProportional)
+            {
+                sum = (this->KP * error) + sum;
+            }
+        }
+        else
+        {
+            sum = this->KP * error;
+        }
+
+        if constexpr (hasDerivative)
+        {
+            // Derivative on measurement, first-order low-pass filtered
+            T rawDerivative = -this->kD * (currentOutput - this->previousMeasurement);
+            this->derivative += this->filterCoefficient * (rawDerivative - this->derivative);
+            this->previousMeasurement = currentOutput;
+            sum = sum + this->derivative;
+        }
+
+        // Saturated again even for Mode::I, with inverted limits the integral is not within them
+        return saturate(sum);
+    }
+
+    /**
+     * @brief This function resets the memory elements of the integral controller
+     */
+    constexpr void reset() noexcept
+    {
+        error = 0;
+        if constexpr (hasIntegral)
+        {
+            this->previousError = 0;
+            this->previousOutput = 0;
+        }
+        if constexpr (hasDerivative)
+        {
+            this->derivative = 0;
+        }
+    }
+
+    /**
+     * @brief This function resets the memory of the derivative term, see reset_pid_derivative_memory
+     */
+    constexpr void reset_derivative(T currentOutput) noexcept
+    {
+        static_assert(hasDerivative, "reset_derivative needs Mode::PID");
+        this->previousMeasurement = currentOutput;
+        this->derivative = 0;
+    }
+
+  private:
+    constexpr T saturate(T value) const noexcept
+    {
+        if constexpr (S == Saturation::Clamp)
+        {
+            if (value > upperLimit)
+            {
+                return upperLimit;
+            }
+            if (value < lowerLimit)
+            {
+                return lowerLimit;
+            }
+        }
+
+        return value;
+    }
+};
+
+} // namespace pid
+
+#endif
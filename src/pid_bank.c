@@ -0,0 +1,185 @@
+#include "pid_bank.h"
+#include "pid_internal.h"
+#include "pid_simd.h"
+
+#include <math.h>
+
+/**
+ * @brief performs the proportional and integral calculation for every controller of a bank. Controller i reads
+ *        currentOutput[i] and writes output[i], giving the same result as calling calc_pid_output on it.
+ *
+ * @param bank structure-of-arrays bank of voltage or current stages
+ * @param currentOutput array of bank->count system outputs
+ * @param output array of bank->count controller outputs
+ */
+void calc_pid_output_batch(PIDBankTypeDef_t *bank, const float *currentOutput, float *output)
+{
+    if (bank == NULL)
+    {
+        return;
+    }
+
+    calc_pid_output_batch_range(bank, currentOutput, output, 0, bank->count);
+}
+
+/**
+ * @brief steps only the active controllers of a bank. Idle controllers whose error moved by more than the deadband
+ *        since their last step are moved back to the active list first; a stepped controller that ends at a fixed
+ *        point moves to the idle list. Both lists are compacted in place, so the cost of a call is one error check
+ *        per idle controller plus one step per active one.
+ *
+ * @param bank structure-of-arrays bank of voltage or current stages
+ * @param quiescence active set of the bank, see reset_pid_bank_quiescence
+ * @param currentOutput array of bank->count system outputs
+ * @param output array of bank->count controller outputs, written for every controller
+ * @return uint32_t number of controllers that were stepped
+ * @note with a deadband of 0 the outputs and memories are bit-identical to calc_pid_output_batch. Call
+ *       reset_pid_bank_quiescence after changing gains or limits.
+ */
+uint32_t calc_pid_output_batch_quiescent(PIDBankTypeDef_t *bank, PIDBankQuiescenceTypeDef_t *quiescence,
+                                         const float *currentOutput, float *output)
+{
+    if ((bank == NULL) || (quiescence == NULL))
+    {
+        return 0;
+    }
+
+    uint32_t *active = quiescence->active;
+    uint32_t *idle = quiescence->idle;
+    float *cachedOutput = quiescence->cachedOutput;
+
+    uint32_t activeCount = quiescence->activeCount;
+    uint32_t idleCount = 0;
+    for (uint32_t j = 0; j < quiescence->idleCount; j++)
+    {
+        uint32_t i = idle[j];
+        float error = bank->referencePoint[i] - currentOutput[i];
+        if (fabsf(error - bank->error[i]) <= quiescence->deadband)
+        {
+            output[i] = cachedOutput[i];
+            idle[idleCount++] = i;
+        }
+        else
+        {
+            active[activeCount++] = i;
+        }
+    }
+
+    uint32_t stepped = activeCount;
+    uint32_t stillActive = 0;
+    for (uint32_t j = 0; j < stepped; j++)
+    {
+        uint32_t i = active[j];
+        float error = bank->referencePoint[i] - currentOutput[i];
+        bank->error[i] = error;
+
+        float ret = pid_step(bank->kI[i], bank->KP[i], bank->lowerLimit[i], bank->upperLimit[i], error,
+                             &bank->previousError[i], &bank->previousOutput[i]);
+        output[i] = ret;
+        cachedOutput[i] = ret;
+
+        if (pid_is_stable(bank->kI[i], bank->lowerLimit[i], bank->upperLimit[i], error, bank->previousError[i],
+                          bank->previousOutput[i]))
+        {
+            idle[idleCount++] = i;
+        }
+        else
+        {
+            active[stillActive++] = i;
+        }
+    }
+
+    quiescence->activeCount = stillActive;
+    quiescence->idleCount = idleCount;
+    return stepped;
+}
+
+/**
+ * @brief puts every controller of the bank in the active list so that the next call steps all of them
+ *
+ * @param quiescence active set to reset, its arrays must hold count elements
+ * @param count number of controllers of the bank
+ */
+void reset_pid_bank_quiescence(PIDBankQuiescenceTypeDef_t *quiescence, uint32_t count)
+{
+    if (quiescence == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        quiescence->active[i] = i;
+    }
+
+    quiescence->activeCount = count;
+    quiescence->idleCount = 0;
+}
+
+/**
+ * @brief This function resets the memory elements of every integral controller in the bank
+ *
+ * @param bank structure-of-arrays bank of voltage or current stages
+ */
+void reset_pid_bank_memory(PIDBankTypeDef_t *bank)
+{
+    if (bank == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < bank->count; i++)
+    {
+        bank->error[i] = 0;
+        bank->previousError[i] = 0;
+        bank->previousOutput[i] = 0;
+    }
+}
+
+/**
+ * @brief copies a single controller into the given slot of a bank
+ *
+ * @param bank structure-of-arrays bank
+ * @param index slot of the bank, must be lower than bank->count
+ * @param pidObject controller to copy from
+ */
+void load_pid_bank_entry(PIDBankTypeDef_t *bank, uint32_t index, const PIDTypeDef_t *pidObject)
+{
+    if ((bank == NULL) || (pidObject == NULL) || (index >= bank->count))
+    {
+        return;
+    }
+
+    bank->kI[index] = pidObject->kI;
+    bank->KP[index] = pidObject->KP;
+    bank->upperLimit[index] = pidObject->upperLimit;
+    bank->lowerLimit[index] = pidObject->lowerLimit;
+    bank->error[index] = pidObject->error;
+    bank->referencePoint[index] = pidObject->referencePoint;
+    bank->previousError[index] = pidObject->previousError;
+    bank->previousOutput[index] = pidObject->previousOutput;
+}
+
+/**
+ * @brief copies the given slot of a bank back into a single controller
+ *
+ * @param bank structure-of-arrays bank
+ * @param index slot of the bank, must be lower than bank->count
+ * @param pidObject controller to copy into, kD is left untouched
+ */
+void store_pid_bank_entry(const PIDBankTypeDef_t *bank, uint32_t index, PIDTypeDef_t *pidObject)
+{
+    if ((bank == NULL) || (pidObject == NULL) || (index >= bank->count))
+    {
+        return;
+    }
+
+    pidObject->kI = bank->kI[index];
+    pidObject->KP = bank->KP[index];
+    pidObject->upperLimit = bank->upperLimit[index];
+    pidObject->lowerLimit = bank->lowerLimit[index];
+    pidObject->error = bank->error[index];
+    pidObject->referencePoint = bank->referencePoint[index];
+    pidObject->previousError = bank->previousError[index];
+    pidObject->previousOutput = bank->previousOutput[index];
+}
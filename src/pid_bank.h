@@ -0,0 +1,48 @@
+#ifndef PID_BANK_H
+#define PID_BANK_H
+
+#include "pid.h"
+
+/**
+ * @brief Structure-of-arrays controller bank. Each member points at a contiguous array of count elements, one
+ *        element per controller, so that a whole bank can be stepped in a single call.
+ * @note The arrays are owned by the caller. Unlike PIDTypeDef_t there is no kD column since the
+ *       proportional-integral step does not use it.
+ */
+typedef struct
+{
+    float *kI;
+    float *KP;
+    float *upperLimit;
+    float *lowerLimit;
+    float *error;
+    float *referencePoint;
+    float *previousError;
+    float *previousOutput;
+    uint32_t count;
+} PIDBankTypeDef_t;
+
+/**
+ * @brief Active set of a bank for quiescent stepping. Every controller index is in exactly one of the two lists:
+ *        active controllers are stepped, idle ones only have their error checked against the deadband and get their
+ *        cached output. The arrays are owned by the caller, each of bank->count elements.
+ */
+typedef struct
+{
+    uint32_t *active;
+    uint32_t activeCount;
+    uint32_t *idle;
+    uint32_t idleCount;
+    float *cachedOutput;
+    float deadband;
+} PIDBankQuiescenceTypeDef_t;
+
+void calc_pid_output_batch(PIDBankTypeDef_t *bank, const float *currentOutput, float *output);
+uint32_t calc_pid_output_batch_quiescent(PIDBankTypeDef_t *bank, PIDBankQuiescenceTypeDef_t *quiescence,
+                                         const float *currentOutput, float *output);
+void reset_pid_bank_quiescence(PIDBankQuiescenceTypeDef_t *quiescence, uint32_t count);
+void reset_pid_bank_memory(PIDBankTypeDef_t *bank);
+void load_pid_bank_entry(PIDBankTypeDef_t *bank, uint32_t index, const PIDTypeDef_t *pidObject);
+void store_pid_bank_entry(const PIDBankTypeDef_t *bank, uint32_t index, PIDTypeDef_t *pidObject);
+
+#endif
@@ -0,0 +1,178 @@
+#include "pid_cascade.h"
+#include "pid_internal.h"
+
+static float calc_stage_output(PIDStageTypeDef_t *stage, float currentOutput)
+{
+    float error = stage->referencePoint - currentOutput;
+    stage->error = error;
+
+    return pid_step(stage->kI, stage->KP, stage->lowerLimit, stage->upperLimit, error, &stage->previousError,
+                    &stage->previousOutput);
+}
+
+static void load_stage(PIDStageTypeDef_t *stage, const PIDTypeDef_t *pidObject)
+{
+    stage->kI = pidObject->kI;
+    stage->KP = pidObject->KP;
+    stage->upperLimit = pidObject->upperLimit;
+    stage->lowerLimit = pidObject->lowerLimit;
+    stage->error = pidObject->error;
+    stage->referencePoint = pidObject->referencePoint;
+    stage->previousError = pidObject->previousError;
+    stage->previousOutput = pidObject->previousOutput;
+}
+
+static void store_stage(const PIDStageTypeDef_t *stage, PIDTypeDef_t *pidObject)
+{
+    pidObject->kI = stage->kI;
+    pidObject->KP = stage->KP;
+    pidObject->upperLimit = stage->upperLimit;
+    pidObject->lowerLimit = stage->lowerLimit;
+    pidObject->error = stage->error;
+    pidObject->referencePoint = stage->referencePoint;
+    pidObject->previousError = stage->previousError;
+    pidObject->previousOutput = stage->previousOutput;
+}
+
+/**
+ * @brief runs the voltage stage, feeds its output to the current stage as reference and runs the current stage.
+ *        Same result as calling calc_pid_output on both stages and copying the reference by hand.
+ *
+ * @param cascade voltage and current stage of one charger
+ * @param voltage measured output voltage
+ * @param current measured output current
+ * @return float phase output of the current stage
+ */
+float calc_cascade_output(PIDCascadeTypeDef_t *cascade, float voltage, float current)
+{
+    if (cascade == NULL)
+    {
+        return 0;
+    }
+
+    cascade->currentStage.referencePoint = calc_stage_output(&cascade->voltageStage, voltage);
+
+    return calc_stage_output(&cascade->currentStage, current);
+}
+
+/**
+ * @brief runs only the voltage stage and hands its output to the current stage as reference. Together with
+ *        calc_cascade_current_output this lets the two stages run at different rates; calling both in turn is the
+ *        same as calc_cascade_output.
+ *
+ * @param cascade voltage and current stage of one charger
+ * @param voltage measured output voltage
+ * @return float new reference of the current stage
+ */
+float calc_cascade_voltage_output(PIDCascadeTypeDef_t *cascade, float voltage)
+{
+    if (cascade == NULL)
+    {
+        return 0;
+    }
+
+    cascade->currentStage.referencePoint = calc_stage_output(&cascade->voltageStage, voltage);
+
+    return cascade->currentStage.referencePoint;
+}
+
+/**
+ * @brief runs only the current stage against the reference left by the last calc_cascade_voltage_output
+ *
+ * @param cascade voltage and current stage of one charger
+ * @param current measured output current
+ * @return float phase output of the current stage
+ */
+float calc_cascade_current_output(PIDCascadeTypeDef_t *cascade, float current)
+{
+    if (cascade == NULL)
+    {
+        return 0;
+    }
+
+    return calc_stage_output(&cascade->currentStage, current);
+}
+
+/**
+ * @brief runs calc_cascade_output on an array of cascades
+ *
+ * @param cascades array of count cascades
+ * @param count number of cascades
+ * @param voltage array of count measured voltages
+ * @param current array of count measured currents
+ * @param phase array of count phase outputs
+ */
+void calc_cascade_output_batch(PIDCascadeTypeDef_t *cascades, uint32_t count, const float *voltage,
+                               const float *current, float *phase)
+{
+    if ((cascades == NULL) || (voltage == NULL) || (current == NULL) || (phase == NULL))
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PIDCascadeTypeDef_t *cascade = &cascades[i];
+        cascade->currentStage.referencePoint = calc_stage_output(&cascade->voltageStage, voltage[i]);
+        phase[i] = calc_stage_output(&cascade->currentStage, current[i]);
+    }
+}
+
+/**
+ * @brief This function resets the memory elements of both integral controllers
+ *
+ * @param cascade voltage and current stage of one charger
+ * @note the current stage reference is reset as well since it is only ever written by the voltage stage
+ */
+void reset_cascade_memory(PIDCascadeTypeDef_t *cascade)
+{
+    if (cascade == NULL)
+    {
+        return;
+    }
+
+    cascade->voltageStage.error = 0;
+    cascade->voltageStage.previousError = 0;
+    cascade->voltageStage.previousOutput = 0;
+    cascade->currentStage.error = 0;
+    cascade->currentStage.referencePoint = 0;
+    cascade->currentStage.previousError = 0;
+    cascade->currentStage.previousOutput = 0;
+}
+
+/**
+ * @brief builds a cascade from two stand-alone stages, kD is dropped
+ *
+ * @param cascade cascade to fill
+ * @param voltageStage outer stage
+ * @param currentStage inner stage
+ */
+void load_cascade_stages(PIDCascadeTypeDef_t *cascade, const PIDTypeDef_t *voltageStage,
+                         const PIDTypeDef_t *currentStage)
+{
+    if ((cascade == NULL) || (voltageStage == NULL) || (currentStage == NULL))
+    {
+        return;
+    }
+
+    load_stage(&cascade->voltageStage, voltageStage);
+    load_stage(&cascade->currentStage, currentStage);
+}
+
+/**
+ * @brief copies both stages of a cascade back into stand-alone stages, kD is left untouched
+ *
+ * @param cascade cascade to read
+ * @param voltageStage outer stage
+ * @param currentStage inner stage
+ */
+void store_cascade_stages(const PIDCascadeTypeDef_t *cascade, PIDTypeDef_t *voltageStage, PIDTypeDef_t *currentStage)
+{
+    if ((cascade == NULL) || (voltageStage == NULL) || (currentStage == NULL))
+    {
+        return;
+    }
+
+    store_stage(&cascade->voltageStage, voltageStage);
+    store_stage(&cascade->currentStage, currentStage);
+}
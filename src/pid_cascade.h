@@ -0,0 +1,41 @@
+#ifndef PID_CASCADE_H
+#define PID_CASCADE_H
+
+#include "pid.h"
+
+/**
+ * @brief One stage of a cascade. Same fields as PIDTypeDef_t without kD, so that two stages fit in 64 bytes.
+ */
+typedef struct
+{
+    float kI;
+    float KP;
+    float upperLimit;
+    float lowerLimit;
+    float error;
+    float referencePoint;
+    float previousError;
+    float previousOutput;
+} PIDStageTypeDef_t;
+
+/**
+ * @brief Cascaded CC/CV controller. The voltage stage output is the reference of the current stage, whose output
+ *        is the phase. Both stages share a single cache line.
+ */
+typedef struct PID_CACHE_ALIGNED
+{
+    PIDStageTypeDef_t voltageStage;
+    PIDStageTypeDef_t currentStage;
+} PIDCascadeTypeDef_t;
+
+float calc_cascade_output(PIDCascadeTypeDef_t *cascade, float voltage, float current);
+float calc_cascade_voltage_output(PIDCascadeTypeDef_t *cascade, float voltage);
+float calc_cascade_current_output(PIDCascadeTypeDef_t *cascade, float current);
+void calc_cascade_output_batch(PIDCascadeTypeDef_t *cascades, uint32_t count, const float *voltage,
+                               const float *current, float *phase);
+void reset_cascade_memory(PIDCascadeTypeDef_t *cascade);
+void load_cascade_stages(PIDCascadeTypeDef_t *cascade, const PIDTypeDef_t *voltageStage,
+                         const PIDTypeDef_t *currentStage);
+void store_cascade_stages(const PIDCascadeTypeDef_t *cascade, PIDTypeDef_t *voltageStage, PIDTypeDef_t *currentStage);
+
+#endif
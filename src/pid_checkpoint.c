@@ -0,0 +1,241 @@
+#include "pid_checkpoint.h"
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(PIDCheckpointHeaderTypeDef_t) == PID_CACHE_LINE_SIZE, "columns must start cache aligned");
+
+#define PID_CHECKPOINT_FNV_OFFSET 0xCBF29CE484222325u
+#define PID_CHECKPOINT_FNV_PRIME 0x100000001B3u
+
+/**
+ * @brief FNV-1a over 32-bit words rather than bytes, a quarter of the multiplies for the same error detection on
+ *        word-sized corruption. The words are copied out of the bytes, the header fields and float columns are not
+ *        uint32_t objects.
+ */
+static uint64_t checksum_words(uint64_t hash, const unsigned char *bytes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t word;
+        memcpy(&word, bytes + (i * sizeof(word)), sizeof(word));
+        hash = (hash ^ word) * PID_CHECKPOINT_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static uint64_t checksum_header(const PIDCheckpointHeaderTypeDef_t *header)
+{
+    return checksum_words(PID_CHECKPOINT_FNV_OFFSET, (const unsigned char *)header,
+                          offsetof(PIDCheckpointHeaderTypeDef_t, headerChecksum) / sizeof(uint32_t));
+}
+
+static uint64_t checksum_data(const PIDCheckpointHeaderTypeDef_t *header)
+{
+    uint64_t hash = PID_CHECKPOINT_FNV_OFFSET;
+    const unsigned char *column = (const unsigned char *)(header + 1);
+    for (uint32_t i = 0; i < PID_CHECKPOINT_COLUMNS; i++)
+    {
+        hash = checksum_words(hash, column, header->count);
+        column += header->columnStride;
+    }
+
+    return hash;
+}
+
+static uint64_t get_column_stride(uint32_t count)
+{
+    uint64_t bytes = (uint64_t)count * sizeof(float);
+    return (bytes + PID_CACHE_LINE_SIZE - 1) & ~(uint64_t)(PID_CACHE_LINE_SIZE - 1);
+}
+
+static void attach(PIDCheckpointTypeDef_t *checkpoint, void *map, size_t size, int fd)
+{
+    PIDCheckpointHeaderTypeDef_t *header = map;
+    float *column[PID_CHECKPOINT_COLUMNS];
+    for (uint32_t i = 0; i < PID_CHECKPOINT_COLUMNS; i++)
+    {
+        column[i] = (float *)((char *)(header + 1) + (i * header->columnStride));
+    }
+
+    checkpoint->header = header;
+    checkpoint->bank = (PIDBankTypeDef_t){column[0], column[1], column[2], column[3],
+                                          column[4], column[5], column[6], column[7], header->count};
+    checkpoint->size = size;
+    checkpoint->fd = fd;
+
+    // Marked live until closed, a crash leaves the file unclean
+    checkpoint->clean = (uint8_t)header->clean;
+    header->clean = 0;
+}
+
+/**
+ * @brief creates or truncates a checkpoint of count zeroed controllers and attaches to it. Load the controllers
+ *        with load_pid_bank_entry on checkpoint->bank.
+ *
+ * @param path checkpoint file
+ * @param count number of controllers, at least 1
+ * @param checkpoint receives the attachment
+ * @return int 0 on success, -1 on failure or if another attachment holds the file
+ */
+int create_pid_checkpoint(const char *path, uint32_t count, PIDCheckpointTypeDef_t *checkpoint)
+{
+    if ((path == NULL) || (checkpoint == NULL) || (count == 0))
+    {
+        return -1;
+    }
+
+    const uint64_t columnStride = get_column_stride(count);
+    const size_t size = sizeof(PIDCheckpointHeaderTypeDef_t) + (size_t)(PID_CHECKPOINT_COLUMNS * columnStride);
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // Truncated only once locked, truncating a file another process has mapped would crash it
+    if ((flock(fd, LOCK_EX | LOCK_NB) != 0) || (ftruncate(fd, 0) != 0) || (ftruncate(fd, (off_t)size) != 0))
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    PIDCheckpointHeaderTypeDef_t *header = map;
+    memset(header, 0, sizeof(*header));
+    header->magic = PID_CHECKPOINT_MAGIC;
+    header->version = PID_CHECKPOINT_VERSION;
+    header->count = count;
+    header->columns = PID_CHECKPOINT_COLUMNS;
+    header->columnStride = columnStride;
+    header->headerChecksum = checksum_header(header);
+
+    attach(checkpoint, map, size, fd);
+    return 0;
+}
+
+/**
+ * @brief re-attaches to an existing checkpoint. Only the header is checked, the columns are used in place as the
+ *        last process left them, see verify_pid_checkpoint.
+ *
+ * @param path checkpoint file
+ * @param checkpoint receives the attachment
+ * @return int 0 on success, -1 if the file cannot be opened or mapped, another attachment holds it or its header is
+ *         not valid
+ */
+int open_pid_checkpoint(const char *path, PIDCheckpointTypeDef_t *checkpoint)
+{
+    if ((path == NULL) || (checkpoint == NULL))
+    {
+        return -1;
+    }
+
+    int fd = open(path, O_RDWR);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // One process steps a bank at a time, the lock goes away with the descriptor
+    struct stat status;
+    if ((flock(fd, LOCK_EX | LOCK_NB) != 0) || (fstat(fd, &status) != 0) ||
+        ((size_t)status.st_size < sizeof(PIDCheckpointHeaderTypeDef_t)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    const size_t size = (size_t)status.st_size;
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    PIDCheckpointHeaderTypeDef_t *header = map;
+    if ((header->magic != PID_CHECKPOINT_MAGIC) || (header->version != PID_CHECKPOINT_VERSION) ||
+        (header->headerChecksum != checksum_header(header)) || (header->count == 0) ||
+        (header->columns != PID_CHECKPOINT_COLUMNS) || (header->columnStride != get_column_stride(header->count)) ||
+        (size != sizeof(*header) + (size_t)(PID_CHECKPOINT_COLUMNS * header->columnStride)))
+    {
+        munmap(map, size);
+        close(fd);
+        return -1;
+    }
+
+    attach(checkpoint, map, size, fd);
+    return 0;
+}
+
+/**
+ * @brief whether the checkpoint was closed cleanly and its columns still match the checksum taken then. Call right
+ *        after open_pid_checkpoint, before stepping. An unclean checkpoint, left by a crash, still holds the
+ *        memories of the last completed write of every column element and is usable; only a corrupt one is not.
+ *
+ * @param checkpoint attachment
+ * @return PIDCheckpointState_t PID_CHECKPOINT_CLEAN, PID_CHECKPOINT_UNCLEAN or PID_CHECKPOINT_CORRUPT
+ */
+PIDCheckpointState_t verify_pid_checkpoint(const PIDCheckpointTypeDef_t *checkpoint)
+{
+    if ((checkpoint == NULL) || (checkpoint->header == NULL))
+    {
+        return PID_CHECKPOINT_CORRUPT;
+    }
+
+    // The checksum is only taken on close, an unclean file has nothing to compare against
+    if (checkpoint->clean != 1)
+    {
+        return PID_CHECKPOINT_UNCLEAN;
+    }
+
+    return (checkpoint->header->dataChecksum == checksum_data(checkpoint->header)) ? PID_CHECKPOINT_CLEAN
+                                                                                   : PID_CHECKPOINT_CORRUPT;
+}
+
+/**
+ * @brief flushes the mapping to disk and waits for it, for state that must survive a power loss and not only a
+ *        process restart
+ *
+ * @return int 0 on success, -1 on failure
+ */
+int sync_pid_checkpoint(PIDCheckpointTypeDef_t *checkpoint)
+{
+    if ((checkpoint == NULL) || (checkpoint->header == NULL))
+    {
+        return -1;
+    }
+
+    return (msync(checkpoint->header, checkpoint->size, MS_SYNC) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief seals the checkpoint with a checksum of its columns, marks it clean, detaches and releases the file for the
+ *        next attachment
+ */
+void close_pid_checkpoint(PIDCheckpointTypeDef_t *checkpoint)
+{
+    if ((checkpoint == NULL) || (checkpoint->header == NULL))
+    {
+        return;
+    }
+
+    checkpoint->header->dataChecksum = checksum_data(checkpoint->header);
+    checkpoint->header->clean = 1;
+    munmap(checkpoint->header, checkpoint->size);
+    flock(checkpoint->fd, LOCK_UN);
+    close(checkpoint->fd);
+    checkpoint->header = NULL;
+}
@@ -0,0 +1,60 @@
+#ifndef PID_CHECKPOINT_H
+#define PID_CHECKPOINT_H
+
+#include "pid_bank.h"
+
+#define PID_CHECKPOINT_MAGIC 0x504B4350u // "PCKP" little endian
+#define PID_CHECKPOINT_VERSION 1
+#define PID_CHECKPOINT_COLUMNS 8
+
+/**
+ * @brief Header of a checkpoint file, one cache line, followed by the eight columns of a PIDBankTypeDef_t in
+ *        declaration order, each columnStride bytes apart. headerChecksum covers the fields before it, dataChecksum
+ *        the columns as they were when the file was last closed.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t columns;
+    uint64_t columnStride;
+    uint64_t headerChecksum;
+    uint64_t dataChecksum;
+    uint32_t clean; // 1 while no process has the file open, 0 from open to close
+    uint32_t reserved;
+    uint8_t padding[16];
+} PIDCheckpointHeaderTypeDef_t;
+
+/**
+ * @brief Result of verify_pid_checkpoint
+ */
+typedef enum
+{
+    PID_CHECKPOINT_CLEAN = 0, // closed cleanly and the columns match the checksum taken then
+    PID_CHECKPOINT_UNCLEAN,   // left open by a crash, the columns hold the last completed writes but cannot be checked
+    PID_CHECKPOINT_CORRUPT,   // closed cleanly but modified since, or no attachment
+} PIDCheckpointState_t;
+
+/**
+ * @brief Controller bank living in a memory-mapped file. The bank columns point into the mapping, so every tick
+ *        stepped on it is written through to the file by the page cache, and a restarted process re-attaches to the
+ *        memories as they were left without parsing or resetting anything. The file is locked while attached, a
+ *        second attachment from this or another process fails until the first is closed.
+ */
+typedef struct
+{
+    PIDCheckpointHeaderTypeDef_t *header;
+    PIDBankTypeDef_t bank;
+    size_t size;
+    int fd;
+    uint8_t clean; // header->clean as found when attaching
+} PIDCheckpointTypeDef_t;
+
+int create_pid_checkpoint(const char *path, uint32_t count, PIDCheckpointTypeDef_t *checkpoint);
+int open_pid_checkpoint(const char *path, PIDCheckpointTypeDef_t *checkpoint);
+PIDCheckpointState_t verify_pid_checkpoint(const PIDCheckpointTypeDef_t *checkpoint);
+int sync_pid_checkpoint(PIDCheckpointTypeDef_t *checkpoint);
+void close_pid_checkpoint(PIDCheckpointTypeDef_t *checkpoint);
+
+#endif
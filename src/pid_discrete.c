@@ -0,0 +1,87 @@
+#include "pid_discrete.h"
+
+/**
+ * @brief converts continuous-time gains into the per-sample coefficients of calc_pid_output and
+ *        calc_pid_output_derivative for a loop running every samplePeriod seconds. The arithmetic is repeated
+ *        operation for operation by pid::compile_gains in pid_discrete.hpp, which folds constant gains at compile time.
+ *
+ *        The integral step adds kI * (error + previous error) per sample, the trapezoidal rule, so kI becomes
+ *        kI * samplePeriod / 2. The derivative filter D(s) = kD * s / (1 + Tf * s) becomes
+ *        d[n] = d[n-1] + filterCoefficient * (kD' * (y[n] - y[n-1]) - d[n-1]) with kD' = kD / samplePeriod and
+ *        - forward Euler: filterCoefficient = samplePeriod / Tf, stable up to samplePeriod < 2 * Tf
+ *        - Tustin: filterCoefficient = 2 * samplePeriod / (2 * Tf + samplePeriod)
+ *        A zero Tf gives the unfiltered difference, filterCoefficient = 1, with either method.
+ *
+ *        The Tustin recurrence is the complete bilinear transform, not only its pole. Substituting
+ *        s = 2 / T * (1 - z^-1) / (1 + z^-1) turns both the numerator s and the denominator 1 + Tf * s into
+ *        fractions over (1 + z^-1), which cancels, leaving
+ *        D(z) = 2 * kD * (1 - z^-1) / ((2 * Tf + T) + (T - 2 * Tf) * z^-1). Its zero at z = 1 is the difference of
+ *        the measurements, its gain filterCoefficient * kD' = 2 * kD / (2 * Tf + T) and its pole 1 - filterCoefficient.
+ *        An averaged (1 + z^-1) input would only appear for a low-pass term without the s in the numerator.
+ *
+ * @param continuousGains gains in seconds
+ * @param samplePeriod seconds between steps, above 0
+ * @param method discretization of the derivative filter
+ * @param discreteGains receives the coefficients
+ * @return int 0 on success, -1 on bad arguments or an unstable forward Euler filter
+ */
+int compile_pid_gains(const PIDContinuousGainsTypeDef_t *continuousGains, float samplePeriod,
+                      PIDDiscretization_t method, PIDDiscreteGainsTypeDef_t *discreteGains)
+{
+    if ((continuousGains == NULL) || (discreteGains == NULL) || !(samplePeriod > 0) ||
+        !(continuousGains->filterTimeConstant >= 0))
+    {
+        return -1;
+    }
+
+    const float filterTimeConstant = continuousGains->filterTimeConstant;
+    float filterCoefficient = 1;
+    if (filterTimeConstant > 0)
+    {
+        switch (method)
+        {
+        case PID_DISCRETE_FORWARD_EULER:
+            if (!(samplePeriod < (2 * filterTimeConstant)))
+            {
+                return -1;
+            }
+            filterCoefficient = samplePeriod / filterTimeConstant;
+            break;
+        case PID_DISCRETE_TUSTIN:
+            filterCoefficient = (2 * samplePeriod) / ((2 * filterTimeConstant) + samplePeriod);
+            break;
+        default:
+            return -1;
+        }
+    }
+
+    discreteGains->kI = (continuousGains->kI * samplePeriod) * 0.5f;
+    discreteGains->KP = continuousGains->KP;
+    discreteGains->kD = continuousGains->kD / samplePeriod;
+    discreteGains->filterCoefficient = filterCoefficient;
+    return 0;
+}
+
+/**
+ * @brief loads compiled coefficients into a controller, the memories, limits and reference are kept
+ *
+ * @param pidObject controller receiving kI, KP and kD
+ * @param derivativeObject derivative memory receiving the filter coefficient, may be NULL for a PI controller
+ * @param discreteGains coefficients from compile_pid_gains
+ */
+void load_pid_discrete_gains(PIDTypeDef_t *pidObject, PIDDerivativeTypeDef_t *derivativeObject,
+                             const PIDDiscreteGainsTypeDef_t *discreteGains)
+{
+    if ((pidObject == NULL) || (discreteGains == NULL))
+    {
+        return;
+    }
+
+    pidObject->kI = discreteGains->kI;
+    pidObject->KP = discreteGains->KP;
+    pidObject->kD = discreteGains->kD;
+    if (derivativeObject != NULL)
+    {
+        derivativeObject->filterCoefficient = discreteGains->filterCoefficient;
+    }
+}
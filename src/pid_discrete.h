@@ -0,0 +1,45 @@
+#ifndef PID_DISCRETE_H
+#define PID_DISCRETE_H
+
+#include "pid.h"
+
+/**
+ * @brief Continuous-time gains of C(s) = KP + kI / s - kD * s / (1 + filterTimeConstant * s), the derivative being
+ *        taken on the measurement as in calc_pid_output_derivative
+ */
+typedef struct
+{
+    float KP;                 // output per unit of error
+    float kI;                 // output per unit of error and second
+    float kD;                 // output per unit of measurement change per second, times seconds
+    float filterTimeConstant; // seconds, 0 for an unfiltered derivative
+} PIDContinuousGainsTypeDef_t;
+
+/**
+ * @brief Per-sample coefficients the step uses, see load_pid_discrete_gains
+ */
+typedef struct
+{
+    float kI;
+    float KP;
+    float kD;
+    float filterCoefficient;
+} PIDDiscreteGainsTypeDef_t;
+
+/**
+ * @brief Discretization of the derivative filter. The integral of the step is trapezoidal by construction, so the
+ *        integral coefficient is kI * samplePeriod / 2 with every method. PID_DISCRETE_TUSTIN is the bilinear
+ *        transform of the whole filter, zero and gain as well as pole, see compile_pid_gains.
+ */
+typedef enum
+{
+    PID_DISCRETE_FORWARD_EULER = 0,
+    PID_DISCRETE_TUSTIN,
+} PIDDiscretization_t;
+
+int compile_pid_gains(const PIDContinuousGainsTypeDef_t *continuousGains, float samplePeriod,
+                      PIDDiscretization_t method, PIDDiscreteGainsTypeDef_t *discreteGains);
+void load_pid_discrete_gains(PIDTypeDef_t *pidObject, PIDDerivativeTypeDef_t *derivativeObject,
+                             const PIDDiscreteGainsTypeDef_t *discreteGains);
+
+#endif
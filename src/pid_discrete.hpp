@@ -0,0 +1,104 @@
+#ifndef PID_DISCRETE_HPP
+#define PID_DISCRETE_HPP
+
+#include "pid.hpp"
+
+extern "C"
+{
+#include "pid_discrete.h"
+}
+
+namespace pid
+{
+
+namespace detail
+{
+
+/**
+ * @brief deliberately not constexpr: reaching it while compile_gains is constant evaluated is a compile error
+ */
+inline void invalid_gain_arguments() noexcept
+{
+}
+
+} // namespace detail
+
+/**
+ * @brief compile_pid_gains with the method fixed at compile time. With constant arguments the coefficients are
+ *        folded by the compiler and the loop only sees the resulting constants:
+ *
+ *        constexpr auto gains = pid::compile_gains<PID_DISCRETE_TUSTIN>({.KP = 4, .kI = 1500}, 1e-3f);
+ *
+ *        Arguments compile_pid_gains rejects fail to compile in a constant evaluation and give all-zero
+ *        coefficients, i.e. a zero output, at run time.
+ *
+ * @tparam Method discretization of the derivative filter
+ * @param continuousGains gains in seconds
+ * @param samplePeriod seconds between steps
+ * @return PIDDiscreteGainsTypeDef_t coefficients equal bit for bit to those of compile_pid_gains
+ */
+template <PIDDiscretization_t Method>
+constexpr PIDDiscreteGainsTypeDef_t compile_gains(const PIDContinuousGainsTypeDef_t &continuousGains,
+                                                  float samplePeriod) noexcept
+{
+    static_assert((Method == PID_DISCRETE_FORWARD_EULER) || (Method == PID_DISCRETE_TUSTIN),
+                  "unknown discretization");
+
+    PIDDiscreteGainsTypeDef_t discreteGains = {};
+    if (!(samplePeriod > 0) || !(continuousGains.filterTimeConstant >= 0))
+    {
+        detail::invalid_gain_arguments();
+        return discreteGains;
+    }
+
+    const float filterTimeConstant = continuousGains.filterTimeConstant;
+    float filterCoefficient = 1;
+    if (filterTimeConstant > 0)
+    {
+        if constexpr (Method == PID_DISCRETE_FORWARD_EULER)
+        {
+            if (!(samplePeriod < (2 * filterTimeConstant)))
+            {
+                detail::invalid_gain_arguments();
+                return discreteGains;
+            }
+            filterCoefficient = samplePeriod / filterTimeConstant;
+        }
+        else
+        {
+            filterCoefficient = (2 * samplePeriod) / ((2 * filterTimeConstant) + samplePeriod);
+        }
+    }
+
+    discreteGains.kI = (continuousGains.kI * samplePeriod) * 0.5f;
+    discreteGains.KP = continuousGains.KP;
+    discreteGains.kD = continuousGains.kD / samplePeriod;
+    discreteGains.filterCoefficient = filterCoefficient;
+    return discreteGains;
+}
+
+/**
+ * @brief loads compiled coefficients into a controller, like load_pid_discrete_gains. Coefficients of terms the
+ *        controller's Mode leaves out are dropped.
+ */
+template <typename T, Mode M, Saturation S>
+constexpr void load_gains(Controller<T, M, S> &controller, const PIDDiscreteGainsTypeDef_t &discreteGains) noexcept
+{
+    if constexpr (Controller<T, M, S>::hasIntegral)
+    {
+        controller.kI = discreteGains.kI;
+    }
+    if constexpr (Controller<T, M, S>::hasProportional)
+    {
+        controller.KP = discreteGains.KP;
+    }
+    if constexpr (Controller<T, M, S>::hasDerivative)
+    {
+        controller.kD = discreteGains.kD;
+        controller.filterCoefficient = discreteGains.filterCoefficient;
+    }
+}
+
+} // namespace pid
+
+#endif
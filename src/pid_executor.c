@@ -0,0 +1,296 @@
+#define _GNU_SOURCE
+#include "pid_executor.h"
+#include "pid_instr.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct
+{
+    uint32_t divider;
+    uint32_t phase;
+    PIDExecutorTask_t task;
+    void *context;
+    uint64_t runs;
+    PIDPeriodTrackerTypeDef_t period; // jitter of the timed runs, fed when built with PID_ENABLE_INSTRUMENTATION
+} PIDExecutorGroupTypeDef_t;
+
+struct PIDExecutorTypeDef
+{
+    PIDExecutorConfigTypeDef_t config;
+    PIDExecutorGroupTypeDef_t groups[PID_EXECUTOR_MAX_GROUPS];
+    uint32_t groupCount;
+    uint64_t nextTick;
+    PIDExecutorStatsTypeDef_t stats;
+    atomic_int stopRequested;
+};
+
+/**
+ * @brief allocates an executor without groups
+ *
+ * @param config base period and scheduling options
+ * @return PIDExecutorTypeDef_t* NULL on failure or a zero period
+ */
+PIDExecutorTypeDef_t *create_pid_executor(const PIDExecutorConfigTypeDef_t *config)
+{
+    if ((config == NULL) || (config->basePeriodNs == 0))
+    {
+        return NULL;
+    }
+
+    PIDExecutorTypeDef_t *executor = calloc(1, sizeof(*executor));
+    if (executor == NULL)
+    {
+        return NULL;
+    }
+
+    executor->config = *config;
+    atomic_init(&executor->stopRequested, 0);
+
+    return executor;
+}
+
+void destroy_pid_executor(PIDExecutorTypeDef_t *executor)
+{
+    free(executor);
+}
+
+/**
+ * @brief adds a group that runs on every tick where tick % divider == phase. Groups due on the same tick run in the
+ *        order they were added, so add the voltage loops before the current loops they feed.
+ *
+ * @param executor executor, must not be running
+ * @param divider period of the group in base ticks, at least 1
+ * @param phase tick offset within the divider, spreads slow groups over different ticks
+ * @param task called with context and the tick number
+ * @param context passed to task
+ * @return int index of the group, -1 on bad arguments or when PID_EXECUTOR_MAX_GROUPS are in use
+ */
+int add_pid_executor_group(PIDExecutorTypeDef_t *executor, uint32_t divider, uint32_t phase, PIDExecutorTask_t task,
+                           void *context)
+{
+    if ((executor == NULL) || (task == NULL) || (divider == 0) || (phase >= divider) ||
+        (executor->groupCount >= PID_EXECUTOR_MAX_GROUPS))
+    {
+        return -1;
+    }
+
+    executor->groups[executor->groupCount] = (PIDExecutorGroupTypeDef_t){divider, phase, task, context, 0, {0, 0}};
+    return (int)executor->groupCount++;
+}
+
+/**
+ * @brief runs the groups due on the given tick
+ *
+ * @param executor executor to run
+ * @param tick tick number
+ * @param timed 1 when called on the deadlines of run_pid_executor, records the period of every group that runs
+ */
+static void run_groups(PIDExecutorTypeDef_t *executor, uint64_t tick, uint8_t timed)
+{
+    for (uint32_t i = 0; i < executor->groupCount; i++)
+    {
+        PIDExecutorGroupTypeDef_t *group = &executor->groups[i];
+        if ((tick % group->divider) == group->phase)
+        {
+            if (timed)
+            {
+                PID_INSTR_PERIOD(&group->period);
+            }
+
+            group->task(group->context, tick);
+            group->runs++;
+        }
+    }
+}
+
+/**
+ * @brief runs the groups due on the given tick without any timing, e.g. to drive the executor from a simulation
+ */
+void run_pid_executor_tick(PIDExecutorTypeDef_t *executor, uint64_t tick)
+{
+    if (executor == NULL)
+    {
+        return;
+    }
+
+    run_groups(executor, tick, 0);
+}
+
+static uint64_t timespec_to_ns(const struct timespec *time)
+{
+    return ((uint64_t)time->tv_sec * 1000000000u) + (uint64_t)time->tv_nsec;
+}
+
+static struct timespec ns_to_timespec(uint64_t ns)
+{
+    return (struct timespec){.tv_sec = (time_t)(ns / 1000000000u), .tv_nsec = (long)(ns % 1000000000u)};
+}
+
+static uint64_t read_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return timespec_to_ns(&now);
+}
+
+static void sleep_until(uint64_t deadlineNs)
+{
+    struct timespec deadline = ns_to_timespec(deadlineNs);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+    {
+    }
+}
+
+/**
+ * @brief runs the groups on absolute deadlines from the calling thread. The first tick is released immediately,
+ *        tick numbers continue from the previous run.
+ *
+ *        When a tick finishes after one or more later deadlines have already passed, those ticks are skipped rather
+ *        than run back to back, and counted in the stats; a group due on a skipped tick misses that run.
+ *
+ *        Pinning and SCHED_FIFO are applied for the duration of the call when configured. Either may be refused,
+ *        e.g. without CAP_SYS_NICE on a stock kernel; the executor then runs with the default policy and the stats
+ *        report what was applied.
+ *
+ *        When built with PID_ENABLE_INSTRUMENTATION, the start of every group's task is recorded in the global
+ *        jitter histogram against the nominal period of that group.
+ *
+ * @param executor executor to run
+ * @param ticks number of base periods to run for, 0 to run until stop_pid_executor
+ * @return int 0 on success, -1 on bad arguments
+ */
+int run_pid_executor(PIDExecutorTypeDef_t *executor, uint64_t ticks)
+{
+    if (executor == NULL)
+    {
+        return -1;
+    }
+
+    pthread_t self = pthread_self();
+
+    cpu_set_t previousAffinity;
+    uint8_t pinned = 0;
+    if ((executor->config.cpu >= 0) && (pthread_getaffinity_np(self, sizeof(previousAffinity), &previousAffinity) == 0))
+    {
+        cpu_set_t affinity;
+        CPU_ZERO(&affinity);
+        CPU_SET(executor->config.cpu, &affinity);
+        pinned = (pthread_setaffinity_np(self, sizeof(affinity), &affinity) == 0);
+    }
+
+    int previousPolicy = 0;
+    struct sched_param previousParam;
+    uint8_t realtime = 0;
+    if ((executor->config.priority > 0) && (pthread_getschedparam(self, &previousPolicy, &previousParam) == 0))
+    {
+        struct sched_param param = {.sched_priority = executor->config.priority};
+        realtime = (pthread_setschedparam(self, SCHED_FIFO, &param) == 0);
+    }
+
+    executor->stats.pinned = pinned;
+    executor->stats.realtime = realtime;
+
+    const uint64_t period = executor->config.basePeriodNs;
+    const uint64_t lastTick = executor->nextTick + ticks;
+
+    // The jitter of a group is measured within a run, not across the idle time between two runs
+    for (uint32_t i = 0; i < executor->groupCount; i++)
+    {
+        PIDExecutorGroupTypeDef_t *group = &executor->groups[i];
+        init_pid_period_tracker(&group->period, (double)(period * group->divider) / 1e9);
+    }
+
+    uint64_t deadline = read_monotonic_ns();
+
+    while (((ticks == 0) || (executor->nextTick < lastTick)) &&
+           !atomic_load_explicit(&executor->stopRequested, memory_order_relaxed))
+    {
+        sleep_until(deadline);
+
+        uint64_t start = read_monotonic_ns();
+        uint64_t lateness = (start > deadline) ? (start - deadline) : 0;
+        if (lateness > executor->stats.maxLatenessNs)
+        {
+            executor->stats.maxLatenessNs = lateness;
+        }
+
+        run_groups(executor, executor->nextTick, 1);
+        executor->nextTick++;
+        executor->stats.ticks++;
+        deadline += period;
+
+        uint64_t end = read_monotonic_ns();
+        if (end > deadline)
+        {
+            // Deadlines that passed in full while this tick ran are dropped, the next one is started late
+            uint64_t missed = (end - deadline) / period;
+            if ((ticks != 0) && (missed > lastTick - executor->nextTick))
+            {
+                missed = lastTick - executor->nextTick;
+            }
+
+            executor->stats.overruns++;
+            executor->stats.skippedTicks += missed;
+            executor->stats.ticks += missed;
+            executor->nextTick += missed;
+            deadline += missed * period;
+        }
+    }
+
+    atomic_store_explicit(&executor->stopRequested, 0, memory_order_relaxed);
+
+    if (realtime)
+    {
+        pthread_setschedparam(self, previousPolicy, &previousParam);
+    }
+
+    if (pinned)
+    {
+        pthread_setaffinity_np(self, sizeof(previousAffinity), &previousAffinity);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief makes run_pid_executor return after the current tick, callable from any thread or from a task. A stop
+ *        requested while the executor is idle ends the next run before its first tick.
+ */
+void stop_pid_executor(PIDExecutorTypeDef_t *executor)
+{
+    if (executor != NULL)
+    {
+        atomic_store_explicit(&executor->stopRequested, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief statistics of all runs so far. Only consistent when read from a task or while the executor is not running.
+ */
+void get_pid_executor_stats(const PIDExecutorTypeDef_t *executor, PIDExecutorStatsTypeDef_t *stats)
+{
+    if ((executor == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    *stats = executor->stats;
+}
+
+/**
+ * @brief number of times the group's task was called
+ */
+uint64_t get_pid_executor_group_runs(const PIDExecutorTypeDef_t *executor, uint32_t group)
+{
+    if ((executor == NULL) || (group >= executor->groupCount))
+    {
+        return 0;
+    }
+
+    return executor->groups[group].runs;
+}
@@ -0,0 +1,44 @@
+#ifndef PID_EXECUTOR_H
+#define PID_EXECUTOR_H
+
+#include <stdint.h>
+
+/**
+ * @brief Fixed-period executor for controller groups running at multiples of a base period, e.g. the current loops
+ *        every 50 us (20 kHz) and the voltage loops every 20th tick (1 kHz). Ticks are released on absolute
+ *        CLOCK_MONOTONIC deadlines so that the period does not drift with the work done per tick.
+ */
+#define PID_EXECUTOR_MAX_GROUPS 8
+
+typedef void (*PIDExecutorTask_t)(void *context, uint64_t tick);
+
+typedef struct
+{
+    uint64_t basePeriodNs;
+    int32_t cpu;      // CPU to pin the executing thread to, -1 to leave the affinity alone
+    int32_t priority; // SCHED_FIFO priority, 0 to keep the default scheduling policy
+} PIDExecutorConfigTypeDef_t;
+
+typedef struct
+{
+    uint64_t ticks;         // base periods elapsed, run or skipped
+    uint64_t overruns;      // ticks that finished after the next deadline
+    uint64_t skippedTicks;  // ticks dropped to get back on schedule after an overrun
+    uint64_t maxLatenessNs; // worst delay between a deadline and the start of its tick
+    uint8_t pinned;         // the CPU affinity was applied
+    uint8_t realtime;       // SCHED_FIFO was applied
+} PIDExecutorStatsTypeDef_t;
+
+typedef struct PIDExecutorTypeDef PIDExecutorTypeDef_t;
+
+PIDExecutorTypeDef_t *create_pid_executor(const PIDExecutorConfigTypeDef_t *config);
+void destroy_pid_executor(PIDExecutorTypeDef_t *executor);
+int add_pid_executor_group(PIDExecutorTypeDef_t *executor, uint32_t divider, uint32_t phase, PIDExecutorTask_t task,
+                           void *context);
+void run_pid_executor_tick(PIDExecutorTypeDef_t *executor, uint64_t tick);
+int run_pid_executor(PIDExecutorTypeDef_t *executor, uint64_t ticks);
+void stop_pid_executor(PIDExecutorTypeDef_t *executor);
+void get_pid_executor_stats(const PIDExecutorTypeDef_t *executor, PIDExecutorStatsTypeDef_t *stats);
+uint64_t get_pid_executor_group_runs(const PIDExecutorTypeDef_t *executor, uint32_t group);
+
+#endif
@@ -0,0 +1,530 @@
+#define _GNU_SOURCE
+#include "pid_farm.h"
+#include "pid_instr.h"
+#include "pid_steal.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Items handed out per take, small enough for the stragglers of a tick to be stolen
+#define PID_FARM_GRAIN 64
+// Polls of a tick or completion word before a thread blocks on the condition variable
+#define PID_FARM_SPIN 4096
+#define PID_FARM_FREE UINT32_MAX
+
+typedef struct
+{
+    _Alignas(PID_CACHE_LINE_SIZE) PIDTypeDef_t *controllers;
+    uint32_t *bays; // bay index of every slot
+    uint32_t count;
+} PIDFarmShardTypeDef_t;
+
+typedef struct
+{
+    uint32_t shard;
+    uint32_t slot;
+} PIDFarmLocationTypeDef_t;
+
+typedef struct
+{
+    PIDFarmTypeDef_t *farm;
+    uint32_t index;
+    pthread_t handle;
+    PIDPeriodTrackerTypeDef_t period; // jitter of the tick release as seen by this worker
+} PIDFarmWorkerTypeDef_t;
+
+struct PIDFarmTypeDef
+{
+    uint32_t workers;
+    uint32_t capacity;
+    uint32_t shardCapacity;
+    uint8_t pin;
+    uint8_t trackPeriod;
+    uint32_t spin; // PID_FARM_SPIN, or 0 when the workers and the caller do not each have a CPU to spin on
+    PIDFarmShardTypeDef_t *shards;
+    PIDFarmWorkerTypeDef_t *threads;
+    PIDFarmLocationTypeDef_t *locations;
+    uint32_t *freeBays;
+    uint32_t freeCount;
+    uint32_t *offsets; // workers + 1 prefix sums of the shard sizes, the global item space of a tick
+    PIDStealSchedulerTypeDef_t *scheduler;
+    const float *currentOutput;
+    float *output;
+    PIDFarmStatsTypeDef_t stats;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t generation; // number of ticks released
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t pending;    // workers still busy with the current tick
+    atomic_uint sleepers;
+    atomic_uint pinned;
+    atomic_uint failed;
+    atomic_int stop;
+};
+
+static inline void relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+/**
+ * @brief waits until word holds target, spinning first and then blocking so that idle workers of a slow loop do
+ *        not burn their cores
+ */
+static void wait_for_value(PIDFarmTypeDef_t *farm, atomic_uint_fast64_t *word, uint64_t target)
+{
+    for (uint32_t i = 0; i < farm->spin; i++)
+    {
+        if (atomic_load(word) == target)
+        {
+            return;
+        }
+        relax();
+    }
+
+    pthread_mutex_lock(&farm->lock);
+    atomic_fetch_add(&farm->sleepers, 1);
+    while (atomic_load(word) != target)
+    {
+        pthread_cond_wait(&farm->wake, &farm->lock);
+    }
+    atomic_fetch_sub(&farm->sleepers, 1);
+    pthread_mutex_unlock(&farm->lock);
+}
+
+/**
+ * @brief wakes blocked threads after a word they may wait on has changed. Both sides use sequentially consistent
+ *        operations, so either the waiter sees the new value or the notifier sees the waiter.
+ */
+static void notify_waiters(PIDFarmTypeDef_t *farm)
+{
+    if (atomic_load(&farm->sleepers) > 0)
+    {
+        pthread_mutex_lock(&farm->lock);
+        pthread_cond_broadcast(&farm->wake);
+        pthread_mutex_unlock(&farm->lock);
+    }
+}
+
+static void finish_work(PIDFarmTypeDef_t *farm)
+{
+    if (atomic_fetch_sub(&farm->pending, 1) == 1)
+    {
+        notify_waiters(farm);
+    }
+}
+
+static void step_range(PIDFarmTypeDef_t *farm, uint32_t begin, uint32_t end)
+{
+    // A range never spans two shards: it starts as a whole shard and is only ever split
+    uint32_t shardIndex = 0;
+    while (begin >= farm->offsets[shardIndex + 1])
+    {
+        shardIndex++;
+    }
+
+    PIDFarmShardTypeDef_t *shard = &farm->shards[shardIndex];
+    const float *currentOutput = farm->currentOutput;
+    float *output = farm->output;
+    for (uint32_t slot = begin - farm->offsets[shardIndex]; slot < end - farm->offsets[shardIndex]; slot++)
+    {
+        uint32_t bay = shard->bays[slot];
+        output[bay] = calc_pid_output(&shard->controllers[slot], currentOutput[bay]);
+    }
+}
+
+/**
+ * @brief pins itself, allocates its shard so that the pages are first touched from its own core, then steps one
+ *        tick per released generation. Records the period between the ticks it sees when the farm was given one
+ *        and the library is built with PID_ENABLE_INSTRUMENTATION.
+ */
+static void *farm_worker(void *argument)
+{
+    PIDFarmWorkerTypeDef_t *worker = argument;
+    PIDFarmTypeDef_t *farm = worker->farm;
+    PIDFarmShardTypeDef_t *shard = &farm->shards[worker->index];
+
+    if (farm->pin)
+    {
+        cpu_set_t affinity;
+        CPU_ZERO(&affinity);
+        CPU_SET(worker->index % get_pid_hardware_threads(), &affinity);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(affinity), &affinity) == 0)
+        {
+            atomic_fetch_add(&farm->pinned, 1);
+        }
+    }
+
+    size_t controllerBytes = sizeof(PIDTypeDef_t) * farm->shardCapacity;
+    controllerBytes = (controllerBytes + PID_CACHE_LINE_SIZE - 1) & ~(size_t)(PID_CACHE_LINE_SIZE - 1);
+    size_t bayBytes = sizeof(uint32_t) * farm->shardCapacity;
+    bayBytes = (bayBytes + PID_CACHE_LINE_SIZE - 1) & ~(size_t)(PID_CACHE_LINE_SIZE - 1);
+    shard->controllers = aligned_alloc(PID_CACHE_LINE_SIZE, controllerBytes);
+    shard->bays = aligned_alloc(PID_CACHE_LINE_SIZE, bayBytes);
+    if ((shard->controllers == NULL) || (shard->bays == NULL))
+    {
+        atomic_store(&farm->failed, 1);
+    }
+    else
+    {
+        memset(shard->controllers, 0, controllerBytes);
+        memset(shard->bays, 0, bayBytes);
+    }
+
+    finish_work(farm);
+
+    for (uint64_t seen = 1;; seen++)
+    {
+        wait_for_value(farm, &farm->generation, seen);
+        if (atomic_load(&farm->stop))
+        {
+            break;
+        }
+
+        if (farm->trackPeriod)
+        {
+            PID_INSTR_PERIOD(&worker->period);
+        }
+
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        while (take_pid_steal_work(farm->scheduler, worker->index, PID_FARM_GRAIN, &begin, &end))
+        {
+            step_range(farm, begin, end);
+        }
+
+        finish_work(farm);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief releases the workers one last time with the stop flag set and frees everything
+ *
+ * @param farm farm to tear down
+ * @param started number of worker threads to join
+ */
+static void teardown_pid_farm(PIDFarmTypeDef_t *farm, uint32_t started)
+{
+    atomic_store(&farm->stop, 1);
+    atomic_fetch_add(&farm->generation, 1);
+    notify_waiters(farm);
+
+    for (uint32_t i = 0; i < started; i++)
+    {
+        pthread_join(farm->threads[i].handle, NULL);
+    }
+
+    for (uint32_t i = 0; i < started; i++)
+    {
+        free(farm->shards[i].controllers);
+        free(farm->shards[i].bays);
+    }
+
+    pthread_cond_destroy(&farm->wake);
+    pthread_mutex_destroy(&farm->lock);
+    destroy_pid_steal_scheduler(farm->scheduler);
+    free(farm->shards);
+    free(farm->threads);
+    free(farm->locations);
+    free(farm->freeBays);
+    free(farm->offsets);
+    free(farm);
+}
+
+/**
+ * @brief starts the worker threads and waits until each of them has allocated its shard
+ *
+ * @param config number of workers, capacity and pinning
+ * @return PIDFarmTypeDef_t* NULL on bad arguments or if a thread or shard could not be created
+ */
+PIDFarmTypeDef_t *create_pid_farm(const PIDFarmConfigTypeDef_t *config)
+{
+    if ((config == NULL) || (config->capacity == 0) || (config->capacity > INT_MAX))
+    {
+        return NULL;
+    }
+
+    PIDFarmTypeDef_t *farm = aligned_alloc(PID_CACHE_LINE_SIZE, sizeof(*farm));
+    if (farm == NULL)
+    {
+        return NULL;
+    }
+    memset(farm, 0, sizeof(*farm));
+
+    farm->workers = (config->workers > 0) ? config->workers : get_pid_hardware_threads();
+    farm->capacity = config->capacity;
+    farm->shardCapacity = (farm->capacity + farm->workers - 1) / farm->workers;
+    farm->pin = config->pin;
+    farm->trackPeriod = (config->periodNs != 0);
+    farm->spin = (get_pid_hardware_threads() > farm->workers) ? PID_FARM_SPIN : 0;
+
+    size_t shardBytes = sizeof(PIDFarmShardTypeDef_t) * farm->workers;
+    farm->shards = aligned_alloc(PID_CACHE_LINE_SIZE, shardBytes);
+    farm->threads = calloc(farm->workers, sizeof(*farm->threads));
+    farm->locations = malloc(sizeof(*farm->locations) * farm->capacity);
+    farm->freeBays = malloc(sizeof(*farm->freeBays) * farm->capacity);
+    farm->offsets = calloc(farm->workers + 1, sizeof(*farm->offsets));
+    farm->scheduler = create_pid_steal_scheduler(farm->workers);
+    pthread_mutex_init(&farm->lock, NULL);
+    pthread_cond_init(&farm->wake, NULL);
+    atomic_init(&farm->generation, 0);
+    atomic_init(&farm->pending, farm->workers);
+    atomic_init(&farm->sleepers, 0);
+    atomic_init(&farm->pinned, 0);
+    atomic_init(&farm->failed, 0);
+    atomic_init(&farm->stop, 0);
+    if ((farm->shards == NULL) || (farm->threads == NULL) || (farm->locations == NULL) ||
+        (farm->freeBays == NULL) || (farm->offsets == NULL) || (farm->scheduler == NULL))
+    {
+        teardown_pid_farm(farm, 0);
+        return NULL;
+    }
+
+    memset(farm->shards, 0, shardBytes);
+    for (uint32_t i = 0; i < farm->capacity; i++)
+    {
+        farm->locations[i] = (PIDFarmLocationTypeDef_t){PID_FARM_FREE, 0};
+        // Handed out from the back, so the first bay added gets index 0
+        farm->freeBays[i] = farm->capacity - 1 - i;
+    }
+    farm->freeCount = farm->capacity;
+
+    for (uint32_t i = 0; i < farm->workers; i++)
+    {
+        farm->threads[i] = (PIDFarmWorkerTypeDef_t){farm, i, 0, {0, 0}};
+        init_pid_period_tracker(&farm->threads[i].period, (double)config->periodNs / 1e9);
+        if (pthread_create(&farm->threads[i].handle, NULL, farm_worker, &farm->threads[i]) != 0)
+        {
+            // The workers already running still report in, the others never will
+            atomic_fetch_sub(&farm->pending, farm->workers - i);
+            wait_for_value(farm, &farm->pending, 0);
+            teardown_pid_farm(farm, i);
+            return NULL;
+        }
+    }
+
+    wait_for_value(farm, &farm->pending, 0);
+    if (atomic_load(&farm->failed))
+    {
+        teardown_pid_farm(farm, farm->workers);
+        return NULL;
+    }
+
+    farm->stats.workers = farm->workers;
+    farm->stats.pinnedWorkers = atomic_load(&farm->pinned);
+    return farm;
+}
+
+void destroy_pid_farm(PIDFarmTypeDef_t *farm)
+{
+    if (farm == NULL)
+    {
+        return;
+    }
+
+    teardown_pid_farm(farm, farm->workers);
+}
+
+static void move_last_bay(PIDFarmTypeDef_t *farm, uint32_t from, uint32_t to)
+{
+    PIDFarmShardTypeDef_t *source = &farm->shards[from];
+    PIDFarmShardTypeDef_t *target = &farm->shards[to];
+
+    uint32_t last = --source->count;
+    uint32_t slot = target->count++;
+    uint32_t bay = source->bays[last];
+    target->controllers[slot] = source->controllers[last];
+    target->bays[slot] = bay;
+    farm->locations[bay] = (PIDFarmLocationTypeDef_t){to, slot};
+}
+
+/**
+ * @brief adds a bay to the smallest shard. Shard sizes never differ by more than one, so a tick starts balanced and
+ *        stealing only has to absorb uneven progress. Must not race with run_pid_farm_tick.
+ *
+ * @param farm farm to add to
+ * @param pidObject initial controller of the bay
+ * @return int bay index for the measurement and output arrays, -1 on bad arguments or when the farm is full
+ */
+int add_pid_farm_bay(PIDFarmTypeDef_t *farm, const PIDTypeDef_t *pidObject)
+{
+    if ((farm == NULL) || (pidObject == NULL) || (farm->freeCount == 0))
+    {
+        return -1;
+    }
+
+    uint32_t smallest = 0;
+    for (uint32_t i = 1; i < farm->workers; i++)
+    {
+        if (farm->shards[i].count < farm->shards[smallest].count)
+        {
+            smallest = i;
+        }
+    }
+
+    PIDFarmShardTypeDef_t *shard = &farm->shards[smallest];
+    uint32_t bay = farm->freeBays[--farm->freeCount];
+    uint32_t slot = shard->count++;
+    shard->controllers[slot] = *pidObject;
+    shard->bays[slot] = bay;
+    farm->locations[bay] = (PIDFarmLocationTypeDef_t){smallest, slot};
+    farm->stats.bays++;
+
+    return (int)bay;
+}
+
+/**
+ * @brief removes a bay and, if that leaves its shard two behind the largest one, moves a bay over from the largest
+ *        shard. Must not race with run_pid_farm_tick.
+ *
+ * @param farm farm to remove from
+ * @param bay index returned by add_pid_farm_bay, free to be handed out again
+ * @return int 0 on success, -1 if the bay is not in use
+ */
+int remove_pid_farm_bay(PIDFarmTypeDef_t *farm, uint32_t bay)
+{
+    if ((farm == NULL) || (bay >= farm->capacity) || (farm->locations[bay].shard == PID_FARM_FREE))
+    {
+        return -1;
+    }
+
+    PIDFarmLocationTypeDef_t location = farm->locations[bay];
+    PIDFarmShardTypeDef_t *shard = &farm->shards[location.shard];
+
+    uint32_t last = --shard->count;
+    if (location.slot != last)
+    {
+        uint32_t moved = shard->bays[last];
+        shard->controllers[location.slot] = shard->controllers[last];
+        shard->bays[location.slot] = moved;
+        farm->locations[moved].slot = location.slot;
+    }
+
+    farm->locations[bay].shard = PID_FARM_FREE;
+    farm->freeBays[farm->freeCount++] = bay;
+    farm->stats.bays--;
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < farm->workers; i++)
+    {
+        if (farm->shards[i].count > farm->shards[largest].count)
+        {
+            largest = i;
+        }
+    }
+
+    if (farm->shards[largest].count > shard->count + 1)
+    {
+        move_last_bay(farm, largest, location.shard);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief overwrites the controller of a bay, including its integral memories. Must not race with
+ *        run_pid_farm_tick.
+ *
+ * @return int 0 on success, -1 if the bay is not in use
+ */
+int load_pid_farm_bay(PIDFarmTypeDef_t *farm, uint32_t bay, const PIDTypeDef_t *pidObject)
+{
+    if ((farm == NULL) || (pidObject == NULL) || (bay >= farm->capacity) ||
+        (farm->locations[bay].shard == PID_FARM_FREE))
+    {
+        return -1;
+    }
+
+    PIDFarmLocationTypeDef_t location = farm->locations[bay];
+    farm->shards[location.shard].controllers[location.slot] = *pidObject;
+    return 0;
+}
+
+/**
+ * @brief copies the controller of a bay out of its shard. Must not race with run_pid_farm_tick.
+ *
+ * @return int 0 on success, -1 if the bay is not in use
+ */
+int store_pid_farm_bay(const PIDFarmTypeDef_t *farm, uint32_t bay, PIDTypeDef_t *pidObject)
+{
+    if ((farm == NULL) || (pidObject == NULL) || (bay >= farm->capacity) ||
+        (farm->locations[bay].shard == PID_FARM_FREE))
+    {
+        return -1;
+    }
+
+    PIDFarmLocationTypeDef_t location = farm->locations[bay];
+    *pidObject = farm->shards[location.shard].controllers[location.slot];
+    return 0;
+}
+
+/**
+ * @brief steps every bay once with calc_pid_output and returns when all of them are done. Every worker starts on
+ *        its own shard; one that finishes early steals the upper half of the largest remaining range.
+ *
+ * @param farm farm to step, from a single controlling thread
+ * @param currentOutput measurement of every bay, indexed by bay
+ * @param output receives the controller output of every bay in use, indexed by bay
+ */
+void run_pid_farm_tick(PIDFarmTypeDef_t *farm, const float *currentOutput, float *output)
+{
+    if ((farm == NULL) || (currentOutput == NULL) || (output == NULL))
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < farm->workers; i++)
+    {
+        farm->offsets[i + 1] = farm->offsets[i] + farm->shards[i].count;
+    }
+
+    reset_pid_steal_scheduler_ranges(farm->scheduler, farm->offsets, farm->offsets + 1);
+    farm->currentOutput = currentOutput;
+    farm->output = output;
+
+    atomic_store(&farm->pending, farm->workers);
+    atomic_fetch_add(&farm->generation, 1);
+    notify_waiters(farm);
+    wait_for_value(farm, &farm->pending, 0);
+
+    for (uint32_t i = 0; i < farm->workers; i++)
+    {
+        farm->stats.steals += get_pid_steal_count(farm->scheduler, i);
+    }
+    farm->stats.ticks++;
+}
+
+/**
+ * @brief statistics of the farm. Must not race with run_pid_farm_tick.
+ */
+void get_pid_farm_stats(const PIDFarmTypeDef_t *farm, PIDFarmStatsTypeDef_t *stats)
+{
+    if ((farm == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    *stats = farm->stats;
+}
+
+/**
+ * @brief number of bays owned by a worker
+ */
+uint32_t get_pid_farm_shard_size(const PIDFarmTypeDef_t *farm, uint32_t worker)
+{
+    if ((farm == NULL) || (worker >= farm->workers))
+    {
+        return 0;
+    }
+
+    return farm->shards[worker].count;
+}
@@ -0,0 +1,44 @@
+#ifndef PID_FARM_H
+#define PID_FARM_H
+
+#include "pid.h"
+
+/**
+ * @brief Controller farm stepping many bays per tick from a set of worker threads. Every worker is pinned to a core
+ *        and owns a shard of the bays whose state it allocates and first touches itself, so that the shard lands on
+ *        the NUMA node of that core. A tick releases all workers at once, each steps its own shard and steals from
+ *        the others once it is done, and the tick returns when every bay has been stepped.
+ *
+ *        Bays are identified by the index returned by add_pid_farm_bay. Measurements and outputs of a tick are
+ *        arrays indexed by that bay index, sized for the capacity of the farm.
+ */
+typedef struct
+{
+    uint32_t workers;  // worker threads, 0 for one per hardware thread
+    uint32_t capacity; // maximum number of bays
+    uint8_t pin;       // pin worker i to CPU i modulo the number of online CPUs
+    uint64_t periodNs; // nominal interval between ticks for the jitter instrumentation, 0 to not record it
+} PIDFarmConfigTypeDef_t;
+
+typedef struct
+{
+    uint64_t ticks;
+    uint64_t steals;        // ranges taken from another worker's shard, summed over all ticks
+    uint32_t bays;
+    uint32_t workers;
+    uint32_t pinnedWorkers; // workers whose CPU affinity was applied
+} PIDFarmStatsTypeDef_t;
+
+typedef struct PIDFarmTypeDef PIDFarmTypeDef_t;
+
+PIDFarmTypeDef_t *create_pid_farm(const PIDFarmConfigTypeDef_t *config);
+void destroy_pid_farm(PIDFarmTypeDef_t *farm);
+int add_pid_farm_bay(PIDFarmTypeDef_t *farm, const PIDTypeDef_t *pidObject);
+int remove_pid_farm_bay(PIDFarmTypeDef_t *farm, uint32_t bay);
+int load_pid_farm_bay(PIDFarmTypeDef_t *farm, uint32_t bay, const PIDTypeDef_t *pidObject);
+int store_pid_farm_bay(const PIDFarmTypeDef_t *farm, uint32_t bay, PIDTypeDef_t *pidObject);
+void run_pid_farm_tick(PIDFarmTypeDef_t *farm, const float *currentOutput, float *output);
+void get_pid_farm_stats(const PIDFarmTypeDef_t *farm, PIDFarmStatsTypeDef_t *stats);
+uint32_t get_pid_farm_shard_size(const PIDFarmTypeDef_t *farm, uint32_t worker);
+
+#endif
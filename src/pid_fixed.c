@@ -0,0 +1,189 @@
+#include "pid_fixed.h"
+
+static int32_t saturate_int32(int64_t value)
+{
+    int32_t ret = 0;
+    if (value > INT32_MAX)
+    {
+        ret = INT32_MAX;
+    }
+    else if (value < INT32_MIN)
+    {
+        ret = INT32_MIN;
+    }
+    else
+    {
+        ret = (int32_t)value;
+    }
+
+    return ret;
+}
+
+static int32_t saturate_output(PIDFixedTypeDef_t *pidObject, int32_t unsatOutput)
+{
+    int32_t ret = 0;
+    if (unsatOutput > pidObject->upperLimit)
+    {
+        ret = pidObject->upperLimit;
+    }
+    else if (unsatOutput < pidObject->lowerLimit)
+    {
+        ret = pidObject->lowerLimit;
+    }
+    else
+    {
+        ret = unsatOutput;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief converts a float to the given Q format, rounding to nearest and saturating out of range values. NaN
+ *        converts to 0.
+ *
+ * @param value float value
+ * @param fractionalBits number of fractional bits of the Q format
+ * @return int32_t
+ */
+int32_t pid_float_to_fixed(float value, uint8_t fractionalBits)
+{
+    double scaled = (double)value * (double)((int64_t)1 << fractionalBits);
+    scaled += (scaled < 0) ? -0.5 : 0.5;
+
+    int32_t ret = 0;
+    if (scaled != scaled)
+    {
+        ret = 0;
+    }
+    else if (scaled >= (double)INT32_MAX)
+    {
+        ret = INT32_MAX;
+    }
+    else if (scaled <= (double)INT32_MIN)
+    {
+        ret = INT32_MIN;
+    }
+    else
+    {
+        ret = (int32_t)scaled;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief converts a value in the given Q format back to float, for logging and tests
+ *
+ * @param value fixed-point value
+ * @param fractionalBits number of fractional bits of the Q format
+ * @return float
+ */
+float pid_fixed_to_float(int32_t value, uint8_t fractionalBits)
+{
+    return (float)((double)value / (double)((int64_t)1 << fractionalBits));
+}
+
+/**
+ * @brief saturating addition
+ */
+int32_t pid_fixed_add(int32_t a, int32_t b)
+{
+    return saturate_int32((int64_t)a + b);
+}
+
+/**
+ * @brief saturating subtraction
+ */
+int32_t pid_fixed_sub(int32_t a, int32_t b)
+{
+    return saturate_int32((int64_t)a - b);
+}
+
+/**
+ * @brief saturating multiplication of two values in the same Q format, rounded to nearest
+ */
+int32_t pid_fixed_mul(int32_t a, int32_t b, uint8_t fractionalBits)
+{
+    int64_t product = (int64_t)a * b;
+    if (fractionalBits > 0)
+    {
+        product += (int64_t)1 << (fractionalBits - 1);
+        product >>= fractionalBits;
+    }
+
+    return saturate_int32(product);
+}
+
+/**
+ * @brief fixed-point counterpart of calc_pid_output, same control law with saturating integer arithmetic.
+ *
+ * @param pidObject controller in the Q format given by pidObject->fractionalBits
+ * @param currentOutput representing the current system output, same Q format
+ * @return int32_t
+ */
+int32_t calc_pid_fixed_output(PIDFixedTypeDef_t *pidObject, int32_t currentOutput)
+{
+    if (pidObject == NULL)
+    {
+        return 0;
+    }
+
+    uint8_t q = pidObject->fractionalBits;
+    int32_t error = pid_fixed_sub(pidObject->referencePoint, currentOutput);
+    pidObject->error = error;
+
+    int32_t proportional = pid_fixed_mul(pidObject->KP, error, q);
+
+    int32_t newIntegral = pid_fixed_mul(pidObject->kI, error, q);
+    int32_t newOutput = pid_fixed_add(pid_fixed_add(newIntegral, pidObject->previousError), pidObject->previousOutput);
+    newOutput = saturate_output(pidObject, newOutput);
+
+    // Update the integral memories
+    pidObject->previousError = newIntegral;
+    pidObject->previousOutput = newOutput;
+
+    return saturate_output(pidObject, pid_fixed_add(proportional, newOutput));
+}
+
+/**
+ * @brief This function resets the memory elements of the fixed-point integral controller
+ *
+ * @param pidObject fixed-point controller
+ */
+void reset_pid_fixed_memory(PIDFixedTypeDef_t *pidObject)
+{
+    if (pidObject == NULL)
+    {
+        return;
+    }
+
+    pidObject->error = 0;
+    pidObject->previousOutput = 0;
+    pidObject->previousError = 0;
+}
+
+/**
+ * @brief converts a float controller (configuration and integral memories) to the given Q format, kD is dropped
+ *
+ * @param fixedObject controller to fill
+ * @param pidObject float controller
+ * @param fractionalBits number of fractional bits of the Q format, 0 to 30
+ */
+void load_pid_fixed(PIDFixedTypeDef_t *fixedObject, const PIDTypeDef_t *pidObject, uint8_t fractionalBits)
+{
+    if ((fixedObject == NULL) || (pidObject == NULL) || (fractionalBits > 30))
+    {
+        return;
+    }
+
+    fixedObject->fractionalBits = fractionalBits;
+    fixedObject->kI = pid_float_to_fixed(pidObject->kI, fractionalBits);
+    fixedObject->KP = pid_float_to_fixed(pidObject->KP, fractionalBits);
+    fixedObject->upperLimit = pid_float_to_fixed(pidObject->upperLimit, fractionalBits);
+    fixedObject->lowerLimit = pid_float_to_fixed(pidObject->lowerLimit, fractionalBits);
+    fixedObject->error = pid_float_to_fixed(pidObject->error, fractionalBits);
+    fixedObject->referencePoint = pid_float_to_fixed(pidObject->referencePoint, fractionalBits);
+    fixedObject->previousError = pid_float_to_fixed(pidObject->previousError, fractionalBits);
+    fixedObject->previousOutput = pid_float_to_fixed(pidObject->previousOutput, fractionalBits);
+}
@@ -0,0 +1,41 @@
+#ifndef PID_FIXED_H
+#define PID_FIXED_H
+
+#include "pid.h"
+
+/**
+ * @brief Common fixed-point formats for PIDFixedTypeDef_t.fractionalBits. All values are stored in 32 bits, Q15
+ *        leaves 16 integer bits (+/-65536), Q24 leaves 7 (+/-128, enough for a 12S pack voltage).
+ */
+#define PID_FIXED_Q15 15
+#define PID_FIXED_Q16 16
+#define PID_FIXED_Q24 24
+
+/**
+ * @brief Integer version of PIDTypeDef_t for targets without an FPU. Every field uses the same Q format given by
+ *        fractionalBits (0 to 30). All arithmetic saturates instead of wrapping.
+ */
+typedef struct
+{
+    int32_t kI;
+    int32_t KP;
+    int32_t upperLimit;
+    int32_t lowerLimit;
+    int32_t error;
+    int32_t referencePoint;
+    int32_t previousError;
+    int32_t previousOutput;
+    uint8_t fractionalBits;
+} PIDFixedTypeDef_t;
+
+int32_t pid_float_to_fixed(float value, uint8_t fractionalBits);
+float pid_fixed_to_float(int32_t value, uint8_t fractionalBits);
+int32_t pid_fixed_add(int32_t a, int32_t b);
+int32_t pid_fixed_sub(int32_t a, int32_t b);
+int32_t pid_fixed_mul(int32_t a, int32_t b, uint8_t fractionalBits);
+
+int32_t calc_pid_fixed_output(PIDFixedTypeDef_t *pidObject, int32_t currentOutput);
+void reset_pid_fixed_memory(PIDFixedTypeDef_t *pidObject);
+void load_pid_fixed(PIDFixedTypeDef_t *fixedObject, const PIDTypeDef_t *pidObject, uint8_t fractionalBits);
+
+#endif
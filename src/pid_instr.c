@@ -0,0 +1,378 @@
+#include "pid_instr.h"
+#include "pid.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(PID_INSTRUMENTATION_USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PID_INSTR_TSC 1
+#endif
+
+struct PIDHistogramTypeDef
+{
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t sum;
+    atomic_uint_fast64_t minComplement; // ~min, so that a zeroed histogram is empty and needs no initialisation
+    atomic_uint_fast64_t max;
+    atomic_uint_fast64_t buckets[PID_HISTOGRAM_BUCKETS];
+};
+
+static void init_histogram(PIDHistogramTypeDef_t *histogram)
+{
+    atomic_init(&histogram->sum, 0);
+    atomic_init(&histogram->minComplement, 0);
+    atomic_init(&histogram->max, 0);
+    for (uint32_t i = 0; i < PID_HISTOGRAM_BUCKETS; i++)
+    {
+        atomic_init(&histogram->buckets[i], 0);
+    }
+}
+
+static void reset_histogram(PIDHistogramTypeDef_t *histogram)
+{
+    for (uint32_t i = 0; i < PID_HISTOGRAM_BUCKETS; i++)
+    {
+        atomic_store_explicit(&histogram->buckets[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&histogram->sum, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->minComplement, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->max, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief allocates an empty histogram
+ *
+ * @return PIDHistogramTypeDef_t* NULL on failure
+ */
+PIDHistogramTypeDef_t *create_pid_histogram(void)
+{
+    size_t bytes = (sizeof(PIDHistogramTypeDef_t) + PID_CACHE_LINE_SIZE - 1) & ~(size_t)(PID_CACHE_LINE_SIZE - 1);
+    PIDHistogramTypeDef_t *histogram = aligned_alloc(PID_CACHE_LINE_SIZE, bytes);
+    if (histogram != NULL)
+    {
+        init_histogram(histogram);
+    }
+
+    return histogram;
+}
+
+void destroy_pid_histogram(PIDHistogramTypeDef_t *histogram)
+{
+    free(histogram);
+}
+
+/**
+ * @brief index of the bucket holding value
+ */
+uint32_t get_pid_histogram_bucket(uint64_t value)
+{
+    if (value < PID_HISTOGRAM_SUB_BUCKETS)
+    {
+        return (uint32_t)value;
+    }
+
+    uint32_t exponent = 63 - (uint32_t)__builtin_clzll(value);
+    uint32_t shift = exponent - PID_HISTOGRAM_SUB_BITS;
+    uint32_t sub = (uint32_t)(value >> shift) - PID_HISTOGRAM_SUB_BUCKETS;
+
+    return ((shift + 1) * PID_HISTOGRAM_SUB_BUCKETS) + sub;
+}
+
+/**
+ * @brief lowest value that falls into the bucket
+ */
+uint64_t get_pid_histogram_bucket_floor(uint32_t bucket)
+{
+    if (bucket < PID_HISTOGRAM_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    uint32_t shift = (bucket / PID_HISTOGRAM_SUB_BUCKETS) - 1;
+    uint64_t sub = bucket % PID_HISTOGRAM_SUB_BUCKETS;
+
+    return (PID_HISTOGRAM_SUB_BUCKETS + sub) << shift;
+}
+
+/**
+ * @brief adds one value, wait-free apart from the min/max updates which only retry while the value is a new extreme
+ */
+void record_pid_histogram(PIDHistogramTypeDef_t *histogram, uint64_t value)
+{
+    atomic_fetch_add_explicit(&histogram->buckets[get_pid_histogram_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum, value, memory_order_relaxed);
+
+    uint64_t minComplement = atomic_load_explicit(&histogram->minComplement, memory_order_relaxed);
+    while ((~value > minComplement) &&
+           !atomic_compare_exchange_weak_explicit(&histogram->minComplement, &minComplement, ~value,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while ((value > max) && !atomic_compare_exchange_weak_explicit(&histogram->max, &max, value,
+                                                                   memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief copies the histogram, optionally resetting it. With reset every recorded value ends up in exactly one
+ *        snapshot, even while other threads keep recording. The count is the sum of the copied buckets; sum, min
+ *        and max may include a value recorded during the copy whose bucket was not copied yet.
+ *
+ * @param histogram histogram to copy
+ * @param snapshot receives the copy
+ * @param reset 1 to empty the histogram
+ */
+void snapshot_pid_histogram(PIDHistogramTypeDef_t *histogram, PIDHistogramSnapshotTypeDef_t *snapshot, uint8_t reset)
+{
+    snapshot->count = 0;
+    for (uint32_t i = 0; i < PID_HISTOGRAM_BUCKETS; i++)
+    {
+        snapshot->buckets[i] = reset ? atomic_exchange_explicit(&histogram->buckets[i], 0, memory_order_relaxed)
+                                     : atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        snapshot->count += snapshot->buckets[i];
+    }
+
+    if (reset)
+    {
+        snapshot->sum = atomic_exchange_explicit(&histogram->sum, 0, memory_order_relaxed);
+        snapshot->min = ~atomic_exchange_explicit(&histogram->minComplement, 0, memory_order_relaxed);
+        snapshot->max = atomic_exchange_explicit(&histogram->max, 0, memory_order_relaxed);
+    }
+    else
+    {
+        snapshot->sum = atomic_load_explicit(&histogram->sum, memory_order_relaxed);
+        snapshot->min = ~atomic_load_explicit(&histogram->minComplement, memory_order_relaxed);
+        snapshot->max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief value at or below which the given percentage of the snapshot lies, to the precision of a bucket
+ *
+ * @param snapshot histogram snapshot
+ * @param percentile 0 to 100
+ * @return uint64_t floor of the bucket holding the percentile clamped to [min, max], 0 for an empty snapshot
+ */
+uint64_t get_pid_histogram_percentile(const PIDHistogramSnapshotTypeDef_t *snapshot, double percentile)
+{
+    if (snapshot->count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)((percentile / 100.0) * (double)snapshot->count + 0.5);
+    rank = (rank < 1) ? 1 : ((rank > snapshot->count) ? snapshot->count : rank);
+
+    uint64_t seen = 0;
+    uint64_t value = snapshot->max;
+    for (uint32_t i = 0; i < PID_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += snapshot->buckets[i];
+        if (seen >= rank)
+        {
+            value = get_pid_histogram_bucket_floor(i);
+            break;
+        }
+    }
+
+    value = (value < snapshot->min) ? snapshot->min : value;
+    return (value > snapshot->max) ? snapshot->max : value;
+}
+
+static uint64_t read_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief current instrumentation timestamp in ticks
+ */
+uint64_t read_pid_instr_clock(void)
+{
+#ifdef PID_INSTR_TSC
+    return __rdtsc();
+#else
+    return read_monotonic_ns();
+#endif
+}
+
+static double ticksPerSecond = 1e9;
+static pthread_once_t ticksPerSecondOnce = PTHREAD_ONCE_INIT;
+
+static void calibrate_ticks_per_second(void)
+{
+#ifdef PID_INSTR_TSC
+    // Count TSC cycles over 20 ms of the monotonic clock
+    const struct timespec interval = {.tv_sec = 0, .tv_nsec = 20000000};
+    uint64_t startNs = read_monotonic_ns();
+    uint64_t startTicks = __rdtsc();
+    nanosleep(&interval, NULL);
+    uint64_t elapsedNs = read_monotonic_ns() - startNs;
+    uint64_t elapsedTicks = __rdtsc() - startTicks;
+    ticksPerSecond = (double)elapsedTicks * 1e9 / (double)elapsedNs;
+#endif
+}
+
+/**
+ * @brief ticks of read_pid_instr_clock per second. Calibrated against CLOCK_MONOTONIC on first use when the TSC is
+ *        the clock, which takes about 20 ms.
+ */
+double get_pid_instr_ticks_per_second(void)
+{
+    pthread_once(&ticksPerSecondOnce, calibrate_ticks_per_second);
+    return ticksPerSecond;
+}
+
+// Saturation counters are striped over cache lines so that the workers of a farm do not contend on them
+#define PID_INSTR_SATURATION_SHARDS 64
+#define PID_INSTR_NO_SHARD UINT32_MAX
+
+typedef struct
+{
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t count[PID_SATURATION_BRANCHES];
+} PIDSaturationShardTypeDef_t;
+
+// Zero-initialised static storage is a valid empty state, so the hooks need no initialisation check
+static PIDHistogramTypeDef_t stepLatency;
+static PIDHistogramTypeDef_t periodJitter;
+static PIDSaturationShardTypeDef_t saturation[PID_INSTR_SATURATION_SHARDS];
+static atomic_uint nextSaturationShard;
+static _Thread_local uint32_t saturationShard = PID_INSTR_NO_SHARD;
+
+/**
+ * @brief counters of the calling thread. Threads are dealt shards round robin on their first count, so up to
+ *        PID_INSTR_SATURATION_SHARDS threads each get a line of their own; beyond that threads share a shard, which
+ *        stays correct because the counters are atomic.
+ */
+static PIDSaturationShardTypeDef_t *get_saturation_shard(void)
+{
+    if (saturationShard == PID_INSTR_NO_SHARD)
+    {
+        saturationShard = atomic_fetch_add_explicit(&nextSaturationShard, 1, memory_order_relaxed) %
+                          PID_INSTR_SATURATION_SHARDS;
+    }
+
+    return &saturation[saturationShard];
+}
+
+/**
+ * @brief adds the duration of one step to the global latency histogram
+ */
+void record_pid_step_latency(uint64_t ticks)
+{
+    record_pid_histogram(&stepLatency, ticks);
+}
+
+/**
+ * @brief counts which branch of the output saturation was taken
+ */
+void record_pid_saturation(PIDSaturationBranch_t branch)
+{
+    if (branch < PID_SATURATION_BRANCHES)
+    {
+        atomic_fetch_add_explicit(&get_saturation_shard()->count[branch], 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief counts the saturation branches taken by the lanes of one vector saturation, bit i of a mask standing for
+ *        lane i. A lane in both masks counts as upper, like the if/else chain of pid_saturate.
+ *
+ * @param upperMask lanes above the upper limit
+ * @param lowerMask lanes below the lower limit
+ * @param lanes number of lanes saturated, at most 32
+ */
+void record_pid_saturation_lanes(uint32_t upperMask, uint32_t lowerMask, uint32_t lanes)
+{
+    uint32_t upper = (uint32_t)__builtin_popcount(upperMask);
+    uint32_t lower = (uint32_t)__builtin_popcount(lowerMask & ~upperMask);
+
+    PIDSaturationShardTypeDef_t *shard = get_saturation_shard();
+    atomic_fetch_add_explicit(&shard->count[PID_SATURATION_UPPER], upper, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->count[PID_SATURATION_LOWER], lower, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->count[PID_SATURATION_NONE], lanes - upper - lower, memory_order_relaxed);
+}
+
+/**
+ * @brief prepares a tracker for a loop that should run every periodSeconds
+ */
+void init_pid_period_tracker(PIDPeriodTrackerTypeDef_t *tracker, double periodSeconds)
+{
+    tracker->nominalPeriod = (uint64_t)(periodSeconds * get_pid_instr_ticks_per_second() + 0.5);
+    tracker->lastTick = 0;
+}
+
+/**
+ * @brief marks the start of a loop period and adds the distance between the last period and the nominal one to the
+ *        global jitter histogram
+ */
+void record_pid_period(PIDPeriodTrackerTypeDef_t *tracker)
+{
+    uint64_t now = read_pid_instr_clock();
+    if (tracker->lastTick != 0)
+    {
+        uint64_t period = now - tracker->lastTick;
+        uint64_t deviation = (period > tracker->nominalPeriod) ? (period - tracker->nominalPeriod)
+                                                               : (tracker->nominalPeriod - period);
+        record_pid_histogram(&periodJitter, deviation);
+    }
+
+    tracker->lastTick = now;
+}
+
+/**
+ * @brief copies the global instrumentation data, safe to call from any thread while controllers are running. The
+ *        saturation counts are summed over the shards of all threads.
+ *
+ * @param snapshot receives the copy
+ * @param reset 1 to start a new measurement interval
+ */
+void snapshot_pid_instrumentation(PIDInstrumentationSnapshotTypeDef_t *snapshot, uint8_t reset)
+{
+    snapshot->ticksPerSecond = get_pid_instr_ticks_per_second();
+    snapshot_pid_histogram(&stepLatency, &snapshot->stepLatency, reset);
+    snapshot_pid_histogram(&periodJitter, &snapshot->jitter, reset);
+    for (uint32_t i = 0; i < PID_SATURATION_BRANCHES; i++)
+    {
+        snapshot->saturation[i] = 0;
+        for (uint32_t shard = 0; shard < PID_INSTR_SATURATION_SHARDS; shard++)
+        {
+            atomic_uint_fast64_t *count = &saturation[shard].count[i];
+            snapshot->saturation[i] += reset ? atomic_exchange_explicit(count, 0, memory_order_relaxed)
+                                             : atomic_load_explicit(count, memory_order_relaxed);
+        }
+    }
+}
+
+void reset_pid_instrumentation(void)
+{
+    reset_histogram(&stepLatency);
+    reset_histogram(&periodJitter);
+    for (uint32_t shard = 0; shard < PID_INSTR_SATURATION_SHARDS; shard++)
+    {
+        for (uint32_t i = 0; i < PID_SATURATION_BRANCHES; i++)
+        {
+            atomic_store_explicit(&saturation[shard].count[i], 0, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief 1 if the library was built with the instrumentation hooks
+ */
+uint8_t is_pid_instrumentation_enabled(void)
+{
+#ifdef PID_ENABLE_INSTRUMENTATION
+    return 1;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,97 @@
+#ifndef PID_INSTR_H
+#define PID_INSTR_H
+
+#include <stdint.h>
+
+/**
+ * @brief Optional timing instrumentation of the controller step. The hooks below expand to nothing unless the library
+ *        is built with PID_ENABLE_INSTRUMENTATION, the histogram and snapshot functions are always available.
+ *
+ *        Timestamps are ticks of read_pid_instr_clock: nanoseconds of CLOCK_MONOTONIC, or TSC cycles when built with
+ *        PID_INSTRUMENTATION_USE_TSC on x86. get_pid_instr_ticks_per_second converts them.
+ */
+
+/**
+ * @brief The histogram is log-linear like an HDR histogram: values below 2^PID_HISTOGRAM_SUB_BITS get a bucket
+ *        each, above that every power of two is split into 2^PID_HISTOGRAM_SUB_BITS linear buckets, so a bucket is
+ *        never wider than 1/16th of its lower bound.
+ */
+#define PID_HISTOGRAM_SUB_BITS 4
+#define PID_HISTOGRAM_SUB_BUCKETS (1u << PID_HISTOGRAM_SUB_BITS)
+#define PID_HISTOGRAM_BUCKETS ((64 - PID_HISTOGRAM_SUB_BITS + 1) * PID_HISTOGRAM_SUB_BUCKETS)
+
+/**
+ * @brief Lock-free histogram, any number of threads may record while another one takes snapshots
+ */
+typedef struct PIDHistogramTypeDef PIDHistogramTypeDef_t;
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min; // UINT64_MAX when empty
+    uint64_t max;
+    uint64_t buckets[PID_HISTOGRAM_BUCKETS];
+} PIDHistogramSnapshotTypeDef_t;
+
+typedef enum
+{
+    PID_SATURATION_NONE = 0,
+    PID_SATURATION_UPPER,
+    PID_SATURATION_LOWER,
+    PID_SATURATION_BRANCHES,
+} PIDSaturationBranch_t;
+
+/**
+ * @brief Tracks the period of one control loop, owned by the thread running that loop
+ */
+typedef struct
+{
+    uint64_t nominalPeriod; // ticks
+    uint64_t lastTick;      // 0 before the first period
+} PIDPeriodTrackerTypeDef_t;
+
+typedef struct
+{
+    double ticksPerSecond;
+    PIDHistogramSnapshotTypeDef_t stepLatency; // ticks per instrumented step
+    PIDHistogramSnapshotTypeDef_t jitter;      // ticks between the measured and the nominal period
+    uint64_t saturation[PID_SATURATION_BRANCHES];
+} PIDInstrumentationSnapshotTypeDef_t;
+
+PIDHistogramTypeDef_t *create_pid_histogram(void);
+void destroy_pid_histogram(PIDHistogramTypeDef_t *histogram);
+void record_pid_histogram(PIDHistogramTypeDef_t *histogram, uint64_t value);
+void snapshot_pid_histogram(PIDHistogramTypeDef_t *histogram, PIDHistogramSnapshotTypeDef_t *snapshot,
+                            uint8_t reset);
+uint32_t get_pid_histogram_bucket(uint64_t value);
+uint64_t get_pid_histogram_bucket_floor(uint32_t bucket);
+uint64_t get_pid_histogram_percentile(const PIDHistogramSnapshotTypeDef_t *snapshot, double percentile);
+
+uint64_t read_pid_instr_clock(void);
+double get_pid_instr_ticks_per_second(void);
+
+void record_pid_step_latency(uint64_t ticks);
+void record_pid_saturation(PIDSaturationBranch_t branch);
+void record_pid_saturation_lanes(uint32_t upperMask, uint32_t lowerMask, uint32_t lanes);
+void init_pid_period_tracker(PIDPeriodTrackerTypeDef_t *tracker, double periodSeconds);
+void record_pid_period(PIDPeriodTrackerTypeDef_t *tracker);
+void snapshot_pid_instrumentation(PIDInstrumentationSnapshotTypeDef_t *snapshot, uint8_t reset);
+void reset_pid_instrumentation(void);
+uint8_t is_pid_instrumentation_enabled(void);
+
+#ifdef PID_ENABLE_INSTRUMENTATION
+#define PID_INSTR_STEP_BEGIN(start) uint64_t start = read_pid_instr_clock()
+#define PID_INSTR_STEP_END(start) record_pid_step_latency(read_pid_instr_clock() - (start))
+#define PID_INSTR_SATURATION(branch) record_pid_saturation(branch)
+#define PID_INSTR_SATURATION_LANES(upperMask, lowerMask, lanes) record_pid_saturation_lanes(upperMask, lowerMask, lanes)
+#define PID_INSTR_PERIOD(tracker) record_pid_period(tracker)
+#else
+#define PID_INSTR_STEP_BEGIN(start)
+#define PID_INSTR_STEP_END(start) ((void)0)
+#define PID_INSTR_SATURATION(branch) ((void)0)
+#define PID_INSTR_SATURATION_LANES(upperMask, lowerMask, lanes) ((void)0)
+#define PID_INSTR_PERIOD(tracker) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef PID_INTERNAL_H
+#define PID_INTERNAL_H
+
+#include "pid_instr.h"
+
+/**
+ * @brief Shared arithmetic of the proportional-integral step. Every entry point (scalar, batched, ...) goes
+ *        through these helpers so that they all produce bit-identical results.
+ */
+
+/**
+ * @brief clamps a value between the given limits. The upper limit is checked first, the same way the original
+ *        saturate_output did, so an inverted pair of limits still resolves to the upper limit.
+ *
+ * @param value unsaturated value
+ * @param lowerLimit lowest allowed value
+ * @param upperLimit highest allowed value
+ * @return float
+ * @note counts the branch taken when the library is built with PID_ENABLE_INSTRUMENTATION
+ */
+static inline float pid_saturate(float value, float lowerLimit, float upperLimit)
+{
+    float ret = 0;
+    if (value > upperLimit)
+    {
+        PID_INSTR_SATURATION(PID_SATURATION_UPPER);
+        ret = upperLimit;
+    }
+    else if (value < lowerLimit)
+    {
+        PID_INSTR_SATURATION(PID_SATURATION_LOWER);
+        ret = lowerLimit;
+    }
+    else
+    {
+        PID_INSTR_SATURATION(PID_SATURATION_NONE);
+        ret = value;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief performs one proportional-integral step on unpacked controller fields and updates the integral memories.
+ *
+ * @param kI integral gain
+ * @param KP proportional gain
+ * @param lowerLimit lower saturation limit
+ * @param upperLimit upper saturation limit
+ * @param error reference minus current output
+ * @param previousError integral memory, holds kI * error of the previous step
+ * @param previousOutput integral memory, holds the saturated integral of the previous step
+ * @return float saturated controller output
+ */
+static inline float pid_step(float kI, float KP, float lowerLimit, float upperLimit, float error,
+                             float *previousError, float *previousOutput)
+{
+    float newIntegral = kI * error;
+
+    float newOutput = newIntegral + *previousError + *previousOutput;
+    newOutput = pid_saturate(newOutput, lowerLimit, upperLimit);
+
+    // Update the integral memories
+    *previousError = newIntegral;
+    *previousOutput = newOutput;
+
+    float sum = (KP * error) + newOutput;
+
+    return pid_saturate(sum, lowerLimit, upperLimit);
+}
+
+/**
+ * @brief whether repeating the step that left these memories, with the same error, would leave them unchanged: the
+ *        integral is either not moving or pinned at the limit it is pushed against. The output of such a step is
+ *        the same as that of the previous one. Does not count as a saturation for the instrumentation.
+ *
+ * @param kI integral gain
+ * @param lowerLimit lower saturation limit
+ * @param upperLimit upper saturation limit
+ * @param error error of the previous step
+ * @param previousError integral memory after the previous step
+ * @param previousOutput integral memory after the previous step
+ * @return uint8_t 1 if the controller is at a fixed point for this error
+ */
+static inline uint8_t pid_is_stable(float kI, float lowerLimit, float upperLimit, float error, float previousError,
+                                    float previousOutput)
+{
+    float newIntegral = kI * error;
+    float newOutput = newIntegral + previousError + previousOutput;
+    newOutput = (newOutput > upperLimit) ? upperLimit : ((newOutput < lowerLimit) ? lowerLimit : newOutput);
+
+    return (newIntegral == previousError) && (newOutput == previousOutput);
+}
+
+#endif
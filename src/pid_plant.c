@@ -0,0 +1,170 @@
+#include "pid_plant.h"
+
+#include <math.h>
+
+/**
+ * @brief fills a config describing a 12S NMC pack of 2.5 Ah cells behind a charger delivering 5 A at 100 % phase,
+ *        sampled at 1 kHz
+ *
+ * @param config config to fill
+ */
+void get_pid_plant_default_config(PIDPlantConfigTypeDef_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    static const float cellOcv[PID_PLANT_OCV_TABLE_SIZE] = {3.00f, 3.45f, 3.55f, 3.62f, 3.68f, 3.74f,
+                                                            3.80f, 3.87f, 3.95f, 4.05f, 4.20f};
+
+    config->seriesCells = 12;
+    config->capacityAh = 2.5f;
+    config->seriesResistance = 0.18f;
+    config->polarizationResistance = 0.12f;
+    config->polarizationCapacitance = 500.0f;
+    config->phaseGain = 0.05f;
+    config->samplePeriod = 0.001f;
+    for (uint8_t i = 0; i < PID_PLANT_OCV_TABLE_SIZE; i++)
+    {
+        config->cellOcv[i] = cellOcv[i];
+    }
+}
+
+/**
+ * @brief copies the config into the plant, precomputes the discrete-time coefficients and rests the pack at the
+ *        given state of charge
+ *
+ * @param plant plant to initialise
+ * @param config pack and charger description
+ * @param stateOfCharge initial state of charge, 0 to 1
+ */
+void init_pid_plant(PIDPlantTypeDef_t *plant, const PIDPlantConfigTypeDef_t *config, float stateOfCharge)
+{
+    if ((plant == NULL) || (config == NULL))
+    {
+        return;
+    }
+
+    plant->config = *config;
+
+    // Exact discretization of the RC pair for a current held constant over one sample
+    float tau = config->polarizationResistance * config->polarizationCapacitance;
+    plant->rcDecay = expf(-config->samplePeriod / tau);
+    plant->rcGain = config->polarizationResistance * (1.0f - plant->rcDecay);
+    plant->chargePerAmp = (double)config->samplePeriod / (3600.0 * config->capacityAh);
+
+    plant->stateOfCharge = stateOfCharge;
+    plant->polarizationVoltage = 0;
+    plant->current = 0;
+    plant->voltage = get_pid_plant_ocv(plant, stateOfCharge);
+}
+
+/**
+ * @brief pack open-circuit voltage, linearly interpolated from the uniformly spaced cell table
+ *
+ * @param plant plant providing the table
+ * @param stateOfCharge state of charge, clamped to 0 to 1
+ * @return float
+ */
+float get_pid_plant_ocv(const PIDPlantTypeDef_t *plant, float stateOfCharge)
+{
+    float position = stateOfCharge * (PID_PLANT_OCV_TABLE_SIZE - 1);
+    position = fminf(fmaxf(position, 0.0f), (float)(PID_PLANT_OCV_TABLE_SIZE - 1));
+
+    uint32_t index = (uint32_t)position;
+    index = (index < (PID_PLANT_OCV_TABLE_SIZE - 2)) ? index : (PID_PLANT_OCV_TABLE_SIZE - 2);
+    float fraction = position - (float)index;
+
+    const float *table = plant->config.cellOcv;
+    float cell = table[index] + (fraction * (table[index + 1] - table[index]));
+
+    return cell * plant->config.seriesCells;
+}
+
+/**
+ * @brief advances the plant by one sample with the given charger phase
+ *
+ * @param plant plant to advance
+ * @param phase phase output of the current stage in %
+ * @return float terminal voltage at the end of the sample
+ */
+float step_pid_plant(PIDPlantTypeDef_t *plant, float phase)
+{
+    float current = plant->config.phaseGain * phase;
+
+    plant->stateOfCharge += (double)current * plant->chargePerAmp;
+    plant->polarizationVoltage = (plant->rcDecay * plant->polarizationVoltage) + (plant->rcGain * current);
+    plant->current = current;
+    plant->voltage = get_pid_plant_ocv(plant, (float)plant->stateOfCharge) +
+                     (current * plant->config.seriesResistance) + plant->polarizationVoltage;
+
+    return plant->voltage;
+}
+
+/**
+ * @brief co-simulates a full CC/CV charge: the cascade measures the plant voltage and current of the previous
+ *        sample and its phase output drives the plant, until the termination current or the step limit is reached.
+ *        Besides the charge time it reports the tuning metrics: voltage overshoot, CV settling time and time spent
+ *        with the phase saturated.
+ *
+ * @param cascade voltage and current stage, the voltage stage reference is the CV set point
+ * @param plant plant at its initial state
+ * @param limits termination current, settling band and step limit
+ * @param result summary of the charge
+ */
+void run_pid_charge_cycle(PIDCascadeTypeDef_t *cascade, PIDPlantTypeDef_t *plant,
+                          const PIDChargeLimitsTypeDef_t *limits, PIDChargeResultTypeDef_t *result)
+{
+    if ((cascade == NULL) || (plant == NULL) || (limits == NULL) || (result == NULL))
+    {
+        return;
+    }
+
+    const float reference = cascade->voltageStage.referencePoint;
+    const float phaseUpper = cascade->currentStage.upperLimit;
+    const float phaseLower = cascade->currentStage.lowerLimit;
+    uint64_t constantVoltageStep = 0;
+    uint64_t lastUnsettledStep = 0;
+    uint64_t saturatedSteps = 0;
+    float peakVoltage = plant->voltage;
+    uint8_t terminated = 0;
+    uint64_t step = 0;
+
+    while (step < limits->maxSteps)
+    {
+        float phase = calc_cascade_output(cascade, plant->voltage, plant->current);
+        float voltage = step_pid_plant(plant, phase);
+        step++;
+
+        peakVoltage = fmaxf(peakVoltage, voltage);
+        saturatedSteps += ((phase >= phaseUpper) || (phase <= phaseLower)) ? 1 : 0;
+
+        if ((constantVoltageStep == 0) && (voltage >= (reference - limits->settlingBand)))
+        {
+            constantVoltageStep = step;
+            lastUnsettledStep = step;
+        }
+
+        if ((constantVoltageStep != 0) && (fabsf(voltage - reference) > limits->settlingBand))
+        {
+            lastUnsettledStep = step;
+        }
+
+        if ((constantVoltageStep != 0) && (plant->current < limits->terminationCurrent))
+        {
+            terminated = 1;
+            break;
+        }
+    }
+
+    result->steps = step;
+    result->constantVoltageStep = constantVoltageStep;
+    result->chargeTime = (float)((double)step * plant->config.samplePeriod);
+    result->finalStateOfCharge = (float)plant->stateOfCharge;
+    result->peakVoltage = peakVoltage;
+    result->overshoot = fmaxf(peakVoltage - reference, 0);
+    result->settlingTime = (float)((double)(lastUnsettledStep - constantVoltageStep) * plant->config.samplePeriod);
+    result->saturationTime = (float)((double)saturatedSteps * plant->config.samplePeriod);
+    result->terminated = terminated;
+}
@@ -0,0 +1,69 @@
+#ifndef PID_PLANT_H
+#define PID_PLANT_H
+
+#include "pid_cascade.h"
+
+#define PID_PLANT_OCV_TABLE_SIZE 11
+
+/**
+ * @brief Discrete-time model of a series Li-ion pack behind a charger stage. The pack is an open-circuit voltage
+ *        curve over state of charge, a series resistance and one RC pair. The charger turns the phase output of the
+ *        current stage (0 to 100 %) into pack current through a fixed gain.
+ */
+typedef struct
+{
+    uint8_t seriesCells;
+    float capacityAh;
+    float seriesResistance;        // ohm, whole pack
+    float polarizationResistance;  // ohm, whole pack
+    float polarizationCapacitance; // farad, whole pack
+    float phaseGain;               // ampere per % of phase
+    float samplePeriod;            // second
+    float cellOcv[PID_PLANT_OCV_TABLE_SIZE]; // cell open-circuit voltage at state of charge 0, 0.1, ... 1
+} PIDPlantConfigTypeDef_t;
+
+typedef struct
+{
+    PIDPlantConfigTypeDef_t config;
+    double stateOfCharge; // double, at 1 kHz a CV tail adds less than a float ulp per sample
+    float polarizationVoltage;
+    float current;
+    float voltage;
+
+    // Coefficients derived from config by init_pid_plant
+    float rcDecay;
+    float rcGain;
+    double chargePerAmp;
+} PIDPlantTypeDef_t;
+
+/**
+ * @brief Limits of a co-simulated CC/CV charge
+ */
+typedef struct
+{
+    float terminationCurrent; // the charge ends once in CV and the current drops below this
+    float settlingBand;       // CV is settled once the voltage stays within this distance of the reference
+    uint64_t maxSteps;
+} PIDChargeLimitsTypeDef_t;
+
+typedef struct
+{
+    uint64_t steps;
+    uint64_t constantVoltageStep; // first step the voltage came within the settling band of the reference
+    float chargeTime;             // second
+    float finalStateOfCharge;
+    float peakVoltage;
+    float overshoot;      // peak voltage above the CV reference, 0 if never exceeded
+    float settlingTime;   // second, from the start of CV until the voltage stays within the settling band
+    float saturationTime; // second, spent with the phase output at one of its limits
+    uint8_t terminated; // 1 if the termination current was reached within maxSteps
+} PIDChargeResultTypeDef_t;
+
+void get_pid_plant_default_config(PIDPlantConfigTypeDef_t *config);
+void init_pid_plant(PIDPlantTypeDef_t *plant, const PIDPlantConfigTypeDef_t *config, float stateOfCharge);
+float get_pid_plant_ocv(const PIDPlantTypeDef_t *plant, float stateOfCharge);
+float step_pid_plant(PIDPlantTypeDef_t *plant, float phase);
+void run_pid_charge_cycle(PIDCascadeTypeDef_t *cascade, PIDPlantTypeDef_t *plant,
+                          const PIDChargeLimitsTypeDef_t *limits, PIDChargeResultTypeDef_t *result);
+
+#endif
@@ -0,0 +1,234 @@
+#include "pid_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct PIDPoolTypeDef
+{
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t freeSlot; // head of the free slot list, capacity when empty
+
+    // Dense side, count live elements
+    PIDTypeDef_t *controllers;
+    uint32_t *denseToSlot;
+
+    // Sparse side, capacity slots. A live slot holds its dense index, a free one the next free slot. The generation
+    // is odd while the slot is live and even while it is free.
+    uint32_t *slotToDense;
+    uint32_t *generation;
+};
+
+static void *allocate_aligned(size_t bytes)
+{
+    bytes = (bytes + PID_CACHE_LINE_SIZE - 1) & ~(size_t)(PID_CACHE_LINE_SIZE - 1);
+    return aligned_alloc(PID_CACHE_LINE_SIZE, bytes);
+}
+
+/**
+ * @brief allocates a pool and all of its storage up front, so adding and removing controllers never touches the heap
+ *
+ * @param capacity largest number of live controllers, at least 1 and at most INT32_MAX
+ * @return PIDPoolTypeDef_t* NULL on failure
+ */
+PIDPoolTypeDef_t *create_pid_pool(uint32_t capacity)
+{
+    if ((capacity == 0) || (capacity > INT32_MAX))
+    {
+        return NULL;
+    }
+
+    PIDPoolTypeDef_t *pool = malloc(sizeof(*pool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    pool->controllers = allocate_aligned(sizeof(PIDTypeDef_t) * capacity);
+    pool->denseToSlot = allocate_aligned(sizeof(uint32_t) * capacity);
+    pool->slotToDense = allocate_aligned(sizeof(uint32_t) * capacity);
+    pool->generation = allocate_aligned(sizeof(uint32_t) * capacity);
+    if ((pool->controllers == NULL) || (pool->denseToSlot == NULL) || (pool->slotToDense == NULL) ||
+        (pool->generation == NULL))
+    {
+        destroy_pid_pool(pool);
+        return NULL;
+    }
+
+    pool->capacity = capacity;
+    pool->count = 0;
+    pool->freeSlot = 0;
+    for (uint32_t slot = 0; slot < capacity; slot++)
+    {
+        pool->slotToDense[slot] = slot + 1;
+        pool->generation[slot] = 0;
+    }
+
+    return pool;
+}
+
+void destroy_pid_pool(PIDPoolTypeDef_t *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    free(pool->controllers);
+    free(pool->denseToSlot);
+    free(pool->slotToDense);
+    free(pool->generation);
+    free(pool);
+}
+
+/**
+ * @brief copies a controller into the pool, at the end of the dense array
+ *
+ * @param pool pool to add to
+ * @param pidObject initial controller
+ * @return PIDPoolHandleTypeDef_t handle of the controller, never valid when the pool is full or on bad arguments
+ */
+PIDPoolHandleTypeDef_t add_pid_pool_controller(PIDPoolTypeDef_t *pool, const PIDTypeDef_t *pidObject)
+{
+    PIDPoolHandleTypeDef_t handle = {UINT32_MAX, 0};
+    if ((pool == NULL) || (pidObject == NULL) || (pool->count == pool->capacity))
+    {
+        return handle;
+    }
+
+    uint32_t slot = pool->freeSlot;
+    pool->freeSlot = pool->slotToDense[slot];
+
+    uint32_t dense = pool->count++;
+    pool->controllers[dense] = *pidObject;
+    pool->denseToSlot[dense] = slot;
+    pool->slotToDense[slot] = dense;
+    pool->generation[slot]++;
+
+    handle.slot = slot;
+    handle.generation = pool->generation[slot];
+    return handle;
+}
+
+/**
+ * @brief whether a handle refers to a live controller of this pool
+ */
+uint8_t is_pid_pool_handle_valid(const PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle)
+{
+    return (pool != NULL) && (handle.slot < pool->capacity) && ((handle.generation & 1) != 0) &&
+           (pool->generation[handle.slot] == handle.generation);
+}
+
+/**
+ * @brief removes a controller, moving the last dense controller into its place. Pointers into the dense array and
+ *        dense indices of the moved controller change; handles stay valid.
+ *
+ * @param pool pool to remove from
+ * @param handle controller to remove
+ * @return int 0 on success, -1 if the handle is stale or invalid
+ */
+int remove_pid_pool_controller(PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle)
+{
+    if (!is_pid_pool_handle_valid(pool, handle))
+    {
+        return -1;
+    }
+
+    uint32_t dense = pool->slotToDense[handle.slot];
+    uint32_t last = --pool->count;
+    if (dense != last)
+    {
+        uint32_t movedSlot = pool->denseToSlot[last];
+        pool->controllers[dense] = pool->controllers[last];
+        pool->denseToSlot[dense] = movedSlot;
+        pool->slotToDense[movedSlot] = dense;
+    }
+
+    pool->generation[handle.slot]++;
+    pool->slotToDense[handle.slot] = pool->freeSlot;
+    pool->freeSlot = handle.slot;
+    return 0;
+}
+
+/**
+ * @brief controller of a handle, valid until the next removal from the pool
+ *
+ * @return PIDTypeDef_t* NULL if the handle is stale or invalid
+ */
+PIDTypeDef_t *get_pid_pool_controller(PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle)
+{
+    if (!is_pid_pool_handle_valid(pool, handle))
+    {
+        return NULL;
+    }
+
+    return &pool->controllers[pool->slotToDense[handle.slot]];
+}
+
+/**
+ * @brief position of a controller in the dense array, i.e. in the arrays passed to calc_pid_pool_output
+ *
+ * @return int dense index, -1 if the handle is stale or invalid
+ */
+int get_pid_pool_dense_index(const PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle)
+{
+    if (!is_pid_pool_handle_valid(pool, handle))
+    {
+        return -1;
+    }
+
+    return (int)pool->slotToDense[handle.slot];
+}
+
+/**
+ * @brief handle of the controller at a dense position, e.g. to label outputs
+ *
+ * @return PIDPoolHandleTypeDef_t never valid if denseIndex is not below get_pid_pool_count
+ */
+PIDPoolHandleTypeDef_t get_pid_pool_dense_handle(const PIDPoolTypeDef_t *pool, uint32_t denseIndex)
+{
+    PIDPoolHandleTypeDef_t handle = {UINT32_MAX, 0};
+    if ((pool == NULL) || (denseIndex >= pool->count))
+    {
+        return handle;
+    }
+
+    handle.slot = pool->denseToSlot[denseIndex];
+    handle.generation = pool->generation[handle.slot];
+    return handle;
+}
+
+/**
+ * @brief dense array of get_pid_pool_count live controllers, valid until the next removal
+ */
+PIDTypeDef_t *get_pid_pool_dense(PIDPoolTypeDef_t *pool)
+{
+    return (pool != NULL) ? pool->controllers : NULL;
+}
+
+uint32_t get_pid_pool_count(const PIDPoolTypeDef_t *pool)
+{
+    return (pool != NULL) ? pool->count : 0;
+}
+
+/**
+ * @brief steps every live controller with calc_pid_output, walking the dense array in order
+ *
+ * @param pool pool to step
+ * @param currentOutput array of get_pid_pool_count measurements in dense order
+ * @param output array of get_pid_pool_count outputs in dense order
+ */
+void calc_pid_pool_output(PIDPoolTypeDef_t *pool, const float *currentOutput, float *output)
+{
+    if ((pool == NULL) || (currentOutput == NULL) || (output == NULL))
+    {
+        return;
+    }
+
+    PIDTypeDef_t *controllers = pool->controllers;
+    const uint32_t count = pool->count;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        output[i] = calc_pid_output(&controllers[i], currentOutput[i]);
+    }
+}
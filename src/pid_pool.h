@@ -0,0 +1,36 @@
+#ifndef PID_POOL_H
+#define PID_POOL_H
+
+#include "pid.h"
+
+/**
+ * @brief Reference to a pooled controller. The generation changes when the controller is removed, so a handle kept
+ *        past the removal is detected as stale instead of silently reaching whatever took its slot.
+ */
+typedef struct
+{
+    uint32_t slot;
+    uint32_t generation;
+} PIDPoolHandleTypeDef_t;
+
+/**
+ * @brief Fixed-capacity controller pool. Live controllers are kept densely packed in one cache-aligned array: a
+ *        removal moves the last controller into the gap, and handles are translated to dense positions through a
+ *        slot table. Batch stepping walks the dense array front to back.
+ */
+typedef struct PIDPoolTypeDef PIDPoolTypeDef_t;
+
+PIDPoolTypeDef_t *create_pid_pool(uint32_t capacity);
+void destroy_pid_pool(PIDPoolTypeDef_t *pool);
+PIDPoolHandleTypeDef_t add_pid_pool_controller(PIDPoolTypeDef_t *pool, const PIDTypeDef_t *pidObject);
+int remove_pid_pool_controller(PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle);
+uint8_t is_pid_pool_handle_valid(const PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle);
+PIDTypeDef_t *get_pid_pool_controller(PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle);
+int get_pid_pool_dense_index(const PIDPoolTypeDef_t *pool, PIDPoolHandleTypeDef_t handle);
+PIDPoolHandleTypeDef_t get_pid_pool_dense_handle(const PIDPoolTypeDef_t *pool, uint32_t denseIndex);
+PIDTypeDef_t *get_pid_pool_dense(PIDPoolTypeDef_t *pool);
+uint32_t get_pid_pool_count(const PIDPoolTypeDef_t *pool);
+
+void calc_pid_pool_output(PIDPoolTypeDef_t *pool, const float *currentOutput, float *output);
+
+#endif
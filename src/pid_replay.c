@@ -0,0 +1,256 @@
+#include "pid_replay.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(PIDSampleLogHeaderTypeDef_t) == PID_CACHE_LINE_SIZE, "sample rows must start cache aligned");
+
+static uint64_t get_row_bytes(const PIDSampleLogHeaderTypeDef_t *header)
+{
+    return (uint64_t)header->channels * sizeof(float);
+}
+
+/**
+ * @brief maps an existing log for reading and checks that its header matches its size
+ *
+ * @param path log file
+ * @param log receives the mapping
+ * @return int 0 on success, -1 if the file cannot be opened or mapped or is not a valid log
+ */
+int open_pid_sample_log(const char *path, PIDSampleLogTypeDef_t *log)
+{
+    if ((path == NULL) || (log == NULL))
+    {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat status;
+    if ((fstat(fd, &status) != 0) || ((size_t)status.st_size < sizeof(PIDSampleLogHeaderTypeDef_t)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    PIDSampleLogHeaderTypeDef_t *header = map;
+    if ((header->magic != PID_SAMPLE_LOG_MAGIC) || (header->version != PID_SAMPLE_LOG_VERSION) ||
+        (header->channels == 0) || (header->samplePeriodNs == 0) ||
+        (header->samples > (((uint64_t)status.st_size - sizeof(*header)) / get_row_bytes(header))))
+    {
+        munmap(map, (size_t)status.st_size);
+        close(fd);
+        return -1;
+    }
+
+    // Replays stream front to back, let the kernel read ahead aggressively
+    madvise(map, (size_t)status.st_size, MADV_SEQUENTIAL);
+
+    log->header = header;
+    log->samples = (float *)(header + 1);
+    log->size = (size_t)status.st_size;
+    log->fd = fd;
+    log->writable = 0;
+    return 0;
+}
+
+/**
+ * @brief creates or truncates a log of the given shape and maps it for writing. The rows are zero until written.
+ *
+ * @param path log file
+ * @param channels floats per row, at least 1
+ * @param samples number of rows
+ * @param startTimeNs time of row 0
+ * @param samplePeriodNs time between rows, at least 1
+ * @param log receives the mapping
+ * @return int 0 on success, -1 on failure or if the log size does not fit in size_t
+ */
+int create_pid_sample_log(const char *path, uint32_t channels, uint64_t samples, uint64_t startTimeNs,
+                          uint64_t samplePeriodNs, PIDSampleLogTypeDef_t *log)
+{
+    if ((path == NULL) || (log == NULL) || (channels == 0) || (samplePeriodNs == 0))
+    {
+        return -1;
+    }
+
+    // Rows that do not fit in size_t would wrap the size and map a log too small for the header it is given
+    const size_t rowBytes = (size_t)channels * sizeof(float);
+    if (samples > ((SIZE_MAX - sizeof(PIDSampleLogHeaderTypeDef_t)) / rowBytes))
+    {
+        return -1;
+    }
+
+    size_t size = sizeof(PIDSampleLogHeaderTypeDef_t) + ((size_t)samples * rowBytes);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    PIDSampleLogHeaderTypeDef_t *header = map;
+    memset(header, 0, sizeof(*header));
+    header->magic = PID_SAMPLE_LOG_MAGIC;
+    header->version = PID_SAMPLE_LOG_VERSION;
+    header->channels = channels;
+    header->samples = samples;
+    header->startTimeNs = startTimeNs;
+    header->samplePeriodNs = samplePeriodNs;
+
+    log->header = header;
+    log->samples = (float *)(header + 1);
+    log->size = size;
+    log->fd = fd;
+    log->writable = 1;
+    return 0;
+}
+
+/**
+ * @brief unmaps the log; rows written through a writable mapping reach the file through the page cache
+ */
+void close_pid_sample_log(PIDSampleLogTypeDef_t *log)
+{
+    if ((log == NULL) || (log->header == NULL))
+    {
+        return;
+    }
+
+    munmap(log->header, log->size);
+    close(log->fd);
+    log->header = NULL;
+    log->samples = NULL;
+}
+
+/**
+ * @brief row holding the given time, without touching any row
+ *
+ * @param log mapped log
+ * @param timeNs absolute time, times before the first row map to row 0
+ * @return uint64_t row index, samples if the time is past the end of the log
+ */
+uint64_t find_pid_sample_index(const PIDSampleLogTypeDef_t *log, uint64_t timeNs)
+{
+    if ((log == NULL) || (log->header == NULL))
+    {
+        return 0;
+    }
+
+    const PIDSampleLogHeaderTypeDef_t *header = log->header;
+    if (timeNs <= header->startTimeNs)
+    {
+        return 0;
+    }
+
+    uint64_t index = (timeNs - header->startTimeNs) / header->samplePeriodNs;
+    return (index < header->samples) ? index : header->samples;
+}
+
+static int check_replay_range(const PIDSampleLogTypeDef_t *input, const PIDSampleLogTypeDef_t *output,
+                              uint64_t first, uint64_t count)
+{
+    if ((input == NULL) || (output == NULL) || (input->header == NULL) || (output->header == NULL) ||
+        !output->writable || (input->header->channels != output->header->channels) ||
+        (first > input->header->samples) || (count > input->header->samples - first) ||
+        (first + count > output->header->samples))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief steps one controller per channel through rows [first, first + count) of the input and writes every output
+ *        to the same row of the output log. The controllers carry their memories from call to call, so a long log
+ *        can be replayed in pieces.
+ *
+ * @param pidObjects array of channels controllers
+ * @param input measurement log
+ * @param output result log from create_pid_sample_log with the same number of channels and at least first + count
+ *        rows
+ * @param first first row, e.g. from find_pid_sample_index
+ * @param count number of rows
+ * @return int 0 on success, -1 on bad arguments or a read-only output
+ */
+int replay_pid_samples(PIDTypeDef_t *pidObjects, const PIDSampleLogTypeDef_t *input, PIDSampleLogTypeDef_t *output,
+                       uint64_t first, uint64_t count)
+{
+    if ((pidObjects == NULL) || (check_replay_range(input, output, first, count) != 0))
+    {
+        return -1;
+    }
+
+    const uint32_t channels = input->header->channels;
+    const float *measurement = input->samples + (first * channels);
+    float *result = output->samples + (first * channels);
+    for (uint64_t row = 0; row < count; row++)
+    {
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            result[channel] = calc_pid_output(&pidObjects[channel], measurement[channel]);
+        }
+
+        measurement += channels;
+        result += channels;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief same as replay_pid_samples with a structure-of-arrays bank, each row being handed straight from the input
+ *        mapping to calc_pid_output_batch and written straight into the output mapping
+ *
+ * @param bank bank of input->header->channels controllers
+ * @param input measurement log
+ * @param output result log from create_pid_sample_log with the same number of channels and at least first + count
+ *        rows
+ * @param first first row
+ * @param count number of rows
+ * @return int 0 on success, -1 on bad arguments or a read-only output
+ */
+int replay_pid_samples_batch(PIDBankTypeDef_t *bank, const PIDSampleLogTypeDef_t *input,
+                             PIDSampleLogTypeDef_t *output, uint64_t first, uint64_t count)
+{
+    if ((bank == NULL) || (check_replay_range(input, output, first, count) != 0) ||
+        (bank->count != input->header->channels))
+    {
+        return -1;
+    }
+
+    const uint32_t channels = input->header->channels;
+    for (uint64_t row = first; row < first + count; row++)
+    {
+        calc_pid_output_batch(bank, input->samples + (row * channels), output->samples + (row * channels));
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef PID_REPLAY_H
+#define PID_REPLAY_H
+
+#include "pid_bank.h"
+
+#define PID_SAMPLE_LOG_MAGIC 0x474F4C53u // "SLOG" little endian
+#define PID_SAMPLE_LOG_VERSION 1
+
+/**
+ * @brief Header of a binary sample log, one cache line. It is followed by samples rows of channels floats, row t
+ *        holding every channel at startTimeNs + t * samplePeriodNs. Rows have a fixed size, so any time offset is
+ *        a multiplication away. Measurement logs and replay results use the same layout.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t channels;
+    uint32_t reserved;
+    uint64_t samples;
+    uint64_t startTimeNs;
+    uint64_t samplePeriodNs;
+    uint8_t padding[24];
+} PIDSampleLogHeaderTypeDef_t;
+
+/**
+ * @brief Sample log mapped into memory. Rows are read and written in place, nothing is copied. Logs opened with
+ *        open_pid_sample_log are mapped read-only, only those from create_pid_sample_log can receive a replay.
+ */
+typedef struct
+{
+    PIDSampleLogHeaderTypeDef_t *header;
+    float *samples;   // samples * channels floats following the header
+    size_t size;      // bytes mapped
+    int fd;
+    uint8_t writable; // 1 if the mapping is writable
+} PIDSampleLogTypeDef_t;
+
+int open_pid_sample_log(const char *path, PIDSampleLogTypeDef_t *log);
+int create_pid_sample_log(const char *path, uint32_t channels, uint64_t samples, uint64_t startTimeNs,
+                          uint64_t samplePeriodNs, PIDSampleLogTypeDef_t *log);
+void close_pid_sample_log(PIDSampleLogTypeDef_t *log);
+uint64_t find_pid_sample_index(const PIDSampleLogTypeDef_t *log, uint64_t timeNs);
+
+int replay_pid_samples(PIDTypeDef_t *pidObjects, const PIDSampleLogTypeDef_t *input, PIDSampleLogTypeDef_t *output,
+                       uint64_t first, uint64_t count);
+int replay_pid_samples_batch(PIDBankTypeDef_t *bank, const PIDSampleLogTypeDef_t *input,
+                             PIDSampleLogTypeDef_t *output, uint64_t first, uint64_t count);
+
+#endif
@@ -0,0 +1,182 @@
+#include "pid_schedule.h"
+
+/**
+ * @brief The arithmetic below is repeated operation for operation in pid_schedule.hpp, so that a table built at
+ *        compile time is bit-identical to one built by build_pid_schedule_table.
+ */
+
+static float lerp(float a, float b, float t)
+{
+    return a + ((b - a) * t);
+}
+
+static void lerp_entry(const PIDScheduleEntryTypeDef_t *a, const PIDScheduleEntryTypeDef_t *b, float t,
+                       PIDScheduleEntryTypeDef_t *entry)
+{
+    entry->kI = lerp(a->kI, b->kI, t);
+    entry->KP = lerp(a->KP, b->KP, t);
+    entry->upperLimit = lerp(a->upperLimit, b->upperLimit, t);
+    entry->lowerLimit = lerp(a->lowerLimit, b->lowerLimit, t);
+}
+
+/**
+ * @brief piecewise-linear value of the breakpoints at an operating point, held constant outside them
+ */
+static void sample_breakpoints(const PIDScheduleBreakpointTypeDef_t *breakpoints, uint32_t breakpointCount,
+                               float operatingPoint, PIDScheduleEntryTypeDef_t *entry)
+{
+    if (operatingPoint <= breakpoints[0].operatingPoint)
+    {
+        *entry = breakpoints[0].entry;
+        return;
+    }
+
+    for (uint32_t i = 1; i < breakpointCount; i++)
+    {
+        const PIDScheduleBreakpointTypeDef_t *low = &breakpoints[i - 1];
+        const PIDScheduleBreakpointTypeDef_t *high = &breakpoints[i];
+        if (operatingPoint < high->operatingPoint)
+        {
+            float t = (operatingPoint - low->operatingPoint) / (high->operatingPoint - low->operatingPoint);
+            lerp_entry(&low->entry, &high->entry, t, entry);
+            return;
+        }
+    }
+
+    *entry = breakpoints[breakpointCount - 1].entry;
+}
+
+/**
+ * @brief resamples breakpoints onto a uniformly spaced table covering [first, last]. More entries follow the
+ *        breakpoints more closely: a breakpoint that falls on an entry is reproduced exactly.
+ *
+ * @param table table to initialise, refers to entries afterwards
+ * @param entries array of count entries to fill
+ * @param count number of entries, at least 2
+ * @param first operating point of the first entry
+ * @param last operating point of the last entry, above first
+ * @param breakpoints array of breakpointCount breakpoints in increasing operating point order
+ * @param breakpointCount number of breakpoints, at least 1
+ * @return int 0 on success, -1 on bad arguments
+ */
+int build_pid_schedule_table(PIDScheduleTableTypeDef_t *table, PIDScheduleEntryTypeDef_t *entries, uint32_t count,
+                             float first, float last, const PIDScheduleBreakpointTypeDef_t *breakpoints,
+                             uint32_t breakpointCount)
+{
+    if ((table == NULL) || (entries == NULL) || (breakpoints == NULL) || (count < 2) || (breakpointCount == 0) ||
+        !(last > first))
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 1; i < breakpointCount; i++)
+    {
+        if (!(breakpoints[i].operatingPoint > breakpoints[i - 1].operatingPoint))
+        {
+            return -1;
+        }
+    }
+
+    float spacing = (last - first) / (float)(count - 1);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sample_breakpoints(breakpoints, breakpointCount, first + (spacing * (float)i), &entries[i]);
+    }
+
+    table->entries = entries;
+    table->count = count;
+    table->origin = first;
+    table->inverseSpacing = (float)(count - 1) / (last - first);
+    return 0;
+}
+
+/**
+ * @brief interpolated gains and limits at an operating point. Operating points outside the table, and NaN, are
+ *        clamped to its ends.
+ *
+ * @param table table built by build_pid_schedule_table or pid::make_schedule
+ * @param operatingPoint operating point, e.g. the measured pack voltage
+ * @param entry receives the gains and limits
+ */
+void lookup_pid_schedule(const PIDScheduleTableTypeDef_t *table, float operatingPoint, PIDScheduleEntryTypeDef_t *entry)
+{
+    if ((table == NULL) || (entry == NULL))
+    {
+        return;
+    }
+
+    const float maxPosition = (float)(table->count - 1);
+    float position = (operatingPoint - table->origin) * table->inverseSpacing;
+    position = (position >= 0) ? position : 0;
+    position = (position <= maxPosition) ? position : maxPosition;
+
+    // The last entry is reached from the segment below it with t = 1
+    uint32_t index = (uint32_t)position;
+    index = (index < table->count - 2) ? index : table->count - 2;
+
+    lerp_entry(&table->entries[index], &table->entries[index + 1], position - (float)index, entry);
+}
+
+/**
+ * @brief loads the gains and limits scheduled at an operating point into a controller, the memories and the
+ *        reference are kept. Call before calc_pid_output in place of retuning by hand.
+ *
+ * @param table gain schedule
+ * @param pidObject controller to retune
+ * @param operatingPoint operating point, e.g. the measured pack voltage
+ */
+void apply_pid_schedule(const PIDScheduleTableTypeDef_t *table, PIDTypeDef_t *pidObject, float operatingPoint)
+{
+    if ((table == NULL) || (pidObject == NULL))
+    {
+        return;
+    }
+
+    PIDScheduleEntryTypeDef_t entry;
+    lookup_pid_schedule(table, operatingPoint, &entry);
+    pidObject->kI = entry.kI;
+    pidObject->KP = entry.KP;
+    pidObject->upperLimit = entry.upperLimit;
+    pidObject->lowerLimit = entry.lowerLimit;
+}
+
+/**
+ * @brief apply_pid_schedule for every controller of a bank. The loop has no branches, so the compiler can vectorize
+ *        it with gathers where the target has them.
+ *
+ * @param table gain schedule
+ * @param bank structure-of-arrays bank whose kI, KP and limit columns are overwritten
+ * @param operatingPoint array of bank->count operating points
+ */
+void apply_pid_schedule_batch(const PIDScheduleTableTypeDef_t *table, PIDBankTypeDef_t *bank,
+                              const float *operatingPoint)
+{
+    if ((table == NULL) || (bank == NULL) || (operatingPoint == NULL))
+    {
+        return;
+    }
+
+    const PIDScheduleEntryTypeDef_t *entries = table->entries;
+    const float origin = table->origin;
+    const float inverseSpacing = table->inverseSpacing;
+    const float maxPosition = (float)(table->count - 1);
+    const uint32_t maxIndex = table->count - 2;
+
+    for (uint32_t i = 0; i < bank->count; i++)
+    {
+        float position = (operatingPoint[i] - origin) * inverseSpacing;
+        position = (position >= 0) ? position : 0;
+        position = (position <= maxPosition) ? position : maxPosition;
+
+        uint32_t index = (uint32_t)position;
+        index = (index < maxIndex) ? index : maxIndex;
+        float t = position - (float)index;
+
+        const PIDScheduleEntryTypeDef_t *low = &entries[index];
+        const PIDScheduleEntryTypeDef_t *high = &entries[index + 1];
+        bank->kI[i] = lerp(low->kI, high->kI, t);
+        bank->KP[i] = lerp(low->KP, high->KP, t);
+        bank->upperLimit[i] = lerp(low->upperLimit, high->upperLimit, t);
+        bank->lowerLimit[i] = lerp(low->lowerLimit, high->lowerLimit, t);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef PID_SCHEDULE_H
+#define PID_SCHEDULE_H
+
+#include "pid_bank.h"
+
+/**
+ * @brief Gains and limits scheduled over the operating point, e.g. the pack voltage
+ */
+typedef struct
+{
+    float kI;
+    float KP;
+    float upperLimit;
+    float lowerLimit;
+} PIDScheduleEntryTypeDef_t;
+
+/**
+ * @brief Gains and limits at one operating point. Breakpoints are given in increasing operating point order and
+ *        interpolated linearly in between; outside the first and last breakpoint their values are held.
+ */
+typedef struct
+{
+    float operatingPoint;
+    PIDScheduleEntryTypeDef_t entry;
+} PIDScheduleBreakpointTypeDef_t;
+
+/**
+ * @brief Uniformly spaced table of count entries, entry i at origin + i / inverseSpacing. A lookup is a multiply, a
+ *        clamp and one linear interpolation between neighbouring entries, without a search or a branch.
+ */
+typedef struct
+{
+    const PIDScheduleEntryTypeDef_t *entries;
+    uint32_t count;
+    float origin;
+    float inverseSpacing;
+} PIDScheduleTableTypeDef_t;
+
+int build_pid_schedule_table(PIDScheduleTableTypeDef_t *table, PIDScheduleEntryTypeDef_t *entries, uint32_t count,
+                             float first, float last, const PIDScheduleBreakpointTypeDef_t *breakpoints,
+                             uint32_t breakpointCount);
+void lookup_pid_schedule(const PIDScheduleTableTypeDef_t *table, float operatingPoint, PIDScheduleEntryTypeDef_t *entry);
+void apply_pid_schedule(const PIDScheduleTableTypeDef_t *table, PIDTypeDef_t *pidObject, float operatingPoint);
+void apply_pid_schedule_batch(const PIDScheduleTableTypeDef_t *table, PIDBankTypeDef_t *bank,
+                              const float *operatingPoint);
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef PID_SCHEDULE_HPP
+#define PID_SCHEDULE_HPP
+
+#include <cstddef>
+
+#include "pid.hpp"
+
+extern "C"
+{
+#include "pid_schedule.h"
+}
+
+namespace pid
+{
+
+namespace detail
+{
+
+constexpr float lerp(float a, float b, float t) noexcept
+{
+    return a + ((b - a) * t);
+}
+
+constexpr PIDScheduleEntryTypeDef_t lerp_entry(const PIDScheduleEntryTypeDef_t &a, const PIDScheduleEntryTypeDef_t &b,
+                                               float t) noexcept
+{
+    return {lerp(a.kI, b.kI, t), lerp(a.KP, b.KP, t), lerp(a.upperLimit, b.upperLimit, t),
+            lerp(a.lowerLimit, b.lowerLimit, t)};
+}
+
+/**
+ * @brief deliberately not constexpr: reaching it while make_schedule is constant evaluated is a compile error
+ */
+inline void invalid_schedule_arguments() noexcept
+{
+}
+
+} // namespace detail
+
+/**
+ * @brief Gain schedule of N uniformly spaced entries, laid out like PIDScheduleTableTypeDef_t. Built at compile time
+ *        by make_schedule, it lives in read-only data and view() hands it to the C functions.
+ *
+ * @tparam N number of entries, at least 2
+ */
+template <std::size_t N>
+struct ScheduleTable
+{
+    static_assert(N >= 2, "a schedule needs at least two entries");
+
+    PIDScheduleEntryTypeDef_t entries[N] = {};
+    float origin = 0;
+    float inverseSpacing = 0;
+
+    /**
+     * @brief same result as lookup_pid_schedule, usable in constant expressions
+     */
+    constexpr PIDScheduleEntryTypeDef_t lookup(float operatingPoint) const noexcept
+    {
+        constexpr float maxPosition = static_cast<float>(N - 1);
+        float position = (operatingPoint - origin) * inverseSpacing;
+        position = (position >= 0) ? position : 0;
+        position = (position <= maxPosition) ? position : maxPosition;
+
+        std::size_t index = static_cast<std::size_t>(position);
+        index = (index < N - 2) ? index : N - 2;
+
+        return detail::lerp_entry(entries[index], entries[index + 1], position - static_cast<float>(index));
+    }
+
+    /**
+     * @brief loads the scheduled gains and limits into a controller, like apply_pid_schedule. Gains of terms the
+     *        controller's Mode leaves out are dropped.
+     */
+    template <typename T, Mode M, Saturation S>
+    constexpr void apply(Controller<T, M, S> &controller, float operatingPoint) const noexcept
+    {
+        PIDScheduleEntryTypeDef_t entry = lookup(operatingPoint);
+        if constexpr (Controller<T, M, S>::hasIntegral)
+        {
+            controller.kI = entry.kI;
+        }
+        if constexpr (Controller<T, M, S>::hasProportional)
+        {
+            controller.KP = entry.KP;
+        }
+        controller.upperLimit = entry.upperLimit;
+        controller.lowerLimit = entry.lowerLimit;
+    }
+
+    PIDScheduleTableTypeDef_t view() const noexcept
+    {
+        return {entries, static_cast<uint32_t>(N), origin, inverseSpacing};
+    }
+};
+
+/**
+ * @brief compile-time build_pid_schedule_table. Where build_pid_schedule_table would return -1, i.e. last not above
+ *        first or breakpoints not increasing, a constant evaluation fails to compile. At run time the table is left
+ *        all zero and schedules a zero output.
+ *
+ *        constexpr auto schedule = pid::make_schedule<64>(40.0f, 56.0f, breakpoints);
+ *
+ * @tparam N number of entries
+ * @param first operating point of the first entry
+ * @param last operating point of the last entry
+ * @param breakpoints breakpoints to resample
+ * @return ScheduleTable<N> table equal bit for bit to the one build_pid_schedule_table produces
+ */
+template <std::size_t N, std::size_t B>
+constexpr ScheduleTable<N> make_schedule(float first, float last, const PIDScheduleBreakpointTypeDef_t (&breakpoints)[B])
+{
+    static_assert(B >= 1, "a schedule needs at least one breakpoint");
+
+    ScheduleTable<N> table;
+    if (!(last > first))
+    {
+        detail::invalid_schedule_arguments();
+        return table;
+    }
+    for (std::size_t i = 1; i < B; i++)
+    {
+        if (!(breakpoints[i].operatingPoint > breakpoints[i - 1].operatingPoint))
+        {
+            detail::invalid_schedule_arguments();
+            return table;
+        }
+    }
+
+    float spacing = (last - first) / static_cast<float>(N - 1);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        float operatingPoint = first + (spacing * static_cast<float>(i));
+
+        PIDScheduleEntryTypeDef_t entry = breakpoints[B - 1].entry;
+        if (operatingPoint <= breakpoints[0].operatingPoint)
+        {
+            entry = breakpoints[0].entry;
+        }
+        else
+        {
+            for (std::size_t j = 1; j < B; j++)
+            {
+                const PIDScheduleBreakpointTypeDef_t &low = breakpoints[j - 1];
+                const PIDScheduleBreakpointTypeDef_t &high = breakpoints[j];
+                if (operatingPoint < high.operatingPoint)
+                {
+                    float t = (operatingPoint - low.operatingPoint) / (high.operatingPoint - low.operatingPoint);
+                    entry = detail::lerp_entry(low.entry, high.entry, t);
+                    break;
+                }
+            }
+        }
+
+        table.entries[i] = entry;
+    }
+
+    table.origin = first;
+    table.inverseSpacing = static_cast<float>(N - 1) / (last - first);
+    return table;
+}
+
+} // namespace pid
+
+#endif
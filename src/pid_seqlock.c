@@ -0,0 +1,181 @@
+#include "pid_seqlock.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PID_SNAPSHOT_WORDS ((sizeof(PIDTypeDef_t) / sizeof(uint32_t)) + 2)
+
+/**
+ * @brief The payload is kept in relaxed atomic words so that a reader overlapping a publication is a retry rather
+ *        than a data race. The words hold the PIDTypeDef_t fields in declaration order, then measurement and output.
+ */
+typedef struct
+{
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t sequence; // odd while a publication is in progress
+    atomic_uint words[PID_SNAPSHOT_WORDS];
+} PIDSeqlockSlotTypeDef_t;
+
+_Static_assert(sizeof(PIDSeqlockSlotTypeDef_t) == PID_CACHE_LINE_SIZE, "a slot must fill exactly one cache line");
+// 64 bits so that steps never wraps, a locked sequence would make publish_pid_snapshot block
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the 64-bit sequence must be lock-free");
+
+struct PIDSeqlockTypeDef
+{
+    uint32_t count;
+    PIDSeqlockSlotTypeDef_t *slots;
+};
+
+static void store_snapshot_word(PIDSeqlockSlotTypeDef_t *slot, uint32_t word, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    atomic_store_explicit(&slot->words[word], bits, memory_order_relaxed);
+}
+
+/**
+ * @brief allocates count slots, all reading as a zeroed controller until their first publication
+ *
+ * @param count number of controllers, at least 1
+ * @return PIDSeqlockTypeDef_t* NULL on failure
+ */
+PIDSeqlockTypeDef_t *create_pid_seqlock(uint32_t count)
+{
+    if (count == 0)
+    {
+        return NULL;
+    }
+
+    PIDSeqlockTypeDef_t *seqlock = malloc(sizeof(*seqlock));
+    if (seqlock == NULL)
+    {
+        return NULL;
+    }
+
+    seqlock->slots = aligned_alloc(PID_CACHE_LINE_SIZE, sizeof(PIDSeqlockSlotTypeDef_t) * count);
+    if (seqlock->slots == NULL)
+    {
+        free(seqlock);
+        return NULL;
+    }
+
+    seqlock->count = count;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        atomic_init(&seqlock->slots[i].sequence, 0);
+        for (uint32_t word = 0; word < PID_SNAPSHOT_WORDS; word++)
+        {
+            atomic_init(&seqlock->slots[i].words[word], 0);
+        }
+    }
+
+    return seqlock;
+}
+
+void destroy_pid_seqlock(PIDSeqlockTypeDef_t *seqlock)
+{
+    if (seqlock == NULL)
+    {
+        return;
+    }
+
+    free(seqlock->slots);
+    free(seqlock);
+}
+
+/**
+ * @brief publishes the state of a controller after a step. Must only be called from the thread that owns the
+ *        controller; it is wait-free, a few plain stores and two release points.
+ *
+ * @param seqlock published states
+ * @param index slot of the controller
+ * @param pidObject controller after the step
+ * @param measurement measurement passed to the step
+ * @param output output returned by the step
+ */
+void publish_pid_snapshot(PIDSeqlockTypeDef_t *seqlock, uint32_t index, const PIDTypeDef_t *pidObject,
+                          float measurement, float output)
+{
+    if ((seqlock == NULL) || (pidObject == NULL) || (index >= seqlock->count))
+    {
+        return;
+    }
+
+    PIDSeqlockSlotTypeDef_t *slot = &seqlock->slots[index];
+    uint64_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+    // Odd sequence first, and no payload store may move above it
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    store_snapshot_word(slot, 0, pidObject->kI);
+    store_snapshot_word(slot, 1, pidObject->KP);
+    store_snapshot_word(slot, 2, pidObject->kD);
+    store_snapshot_word(slot, 3, pidObject->upperLimit);
+    store_snapshot_word(slot, 4, pidObject->lowerLimit);
+    store_snapshot_word(slot, 5, pidObject->error);
+    store_snapshot_word(slot, 6, pidObject->referencePoint);
+    store_snapshot_word(slot, 7, pidObject->previousError);
+    store_snapshot_word(slot, 8, pidObject->previousOutput);
+    store_snapshot_word(slot, 9, measurement);
+    store_snapshot_word(slot, 10, output);
+
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+}
+
+/**
+ * @brief copies the last state published for a controller. Retries while the writer is publishing, which only
+ *        lasts a few stores, so it is lock-free but not wait-free. Any number of threads may read at once.
+ *
+ * @param seqlock published states
+ * @param index slot of the controller
+ * @param snapshot receives the state, steps is 0 before the first publication
+ * @return int 0 on success, -1 on bad arguments
+ */
+int read_pid_snapshot(const PIDSeqlockTypeDef_t *seqlock, uint32_t index, PIDSnapshotTypeDef_t *snapshot)
+{
+    if ((seqlock == NULL) || (snapshot == NULL) || (index >= seqlock->count))
+    {
+        return -1;
+    }
+
+    PIDSeqlockSlotTypeDef_t *slot = &seqlock->slots[index];
+    uint32_t words[PID_SNAPSHOT_WORDS];
+    uint64_t before = 0;
+    uint64_t after = 0;
+    do
+    {
+        before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        for (uint32_t word = 0; word < PID_SNAPSHOT_WORDS; word++)
+        {
+            words[word] = atomic_load_explicit(&slot->words[word], memory_order_relaxed);
+        }
+
+        // No payload load may move below the second sequence load
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    } while (((before & 1) != 0) || (before != after));
+
+    memcpy(&snapshot->pidObject, words, sizeof(snapshot->pidObject));
+    memcpy(&snapshot->measurement, &words[PID_SNAPSHOT_WORDS - 2], sizeof(snapshot->measurement));
+    memcpy(&snapshot->output, &words[PID_SNAPSHOT_WORDS - 1], sizeof(snapshot->output));
+    snapshot->steps = before / 2;
+    return 0;
+}
+
+/**
+ * @brief calc_pid_output followed by publish_pid_snapshot of the result
+ *
+ * @param pidObject representing a generic type which can be the voltage or the current stage
+ * @param currentOutput representing the current system output
+ * @param seqlock published states
+ * @param index slot of the controller
+ * @return float
+ */
+float calc_pid_output_published(PIDTypeDef_t *pidObject, float currentOutput, PIDSeqlockTypeDef_t *seqlock,
+                                uint32_t index)
+{
+    float output = calc_pid_output(pidObject, currentOutput);
+    publish_pid_snapshot(seqlock, index, pidObject, currentOutput, output);
+    return output;
+}
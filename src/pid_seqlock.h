@@ -0,0 +1,33 @@
+#ifndef PID_SEQLOCK_H
+#define PID_SEQLOCK_H
+
+#include "pid.h"
+
+/**
+ * @brief Consistent copy of a controller as published after one of its steps
+ */
+typedef struct
+{
+    PIDTypeDef_t pidObject;
+    float measurement;
+    float output;
+    uint64_t steps; // number of publications so far, this one included
+} PIDSnapshotTypeDef_t;
+
+/**
+ * @brief Published controller state for monitoring threads, one cache line per controller, each guarded by a
+ *        sequence lock. The control loop, the only writer of a slot, never blocks or waits; readers retry while a
+ *        publication is in progress and never see a mix of two steps.
+ */
+typedef struct PIDSeqlockTypeDef PIDSeqlockTypeDef_t;
+
+PIDSeqlockTypeDef_t *create_pid_seqlock(uint32_t count);
+void destroy_pid_seqlock(PIDSeqlockTypeDef_t *seqlock);
+void publish_pid_snapshot(PIDSeqlockTypeDef_t *seqlock, uint32_t index, const PIDTypeDef_t *pidObject,
+                          float measurement, float output);
+int read_pid_snapshot(const PIDSeqlockTypeDef_t *seqlock, uint32_t index, PIDSnapshotTypeDef_t *snapshot);
+
+float calc_pid_output_published(PIDTypeDef_t *pidObject, float currentOutput, PIDSeqlockTypeDef_t *seqlock,
+                                uint32_t index);
+
+#endif
@@ -0,0 +1,425 @@
+#define _GNU_SOURCE
+#include "pid_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "ring indices are shared between processes and must be lock-free");
+
+/**
+ * @brief First cache line of a segment
+ */
+typedef struct
+{
+    atomic_uint magic; // written last by the creator
+    uint32_t version;
+    uint32_t channels;
+    uint32_t capacity;
+    uint32_t slotBytes;
+    uint8_t padding[44];
+} PIDShmHeaderTypeDef_t;
+
+/**
+ * @brief Indices of one ring. The head is also the futex word the consumer sleeps on when the ring is empty; the
+ *        producer only makes the wake syscall when the consumer has announced that it is about to sleep.
+ */
+typedef struct
+{
+    // Producer line
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint head;
+    uint32_t reserved;
+    uint64_t sequence;
+    _Atomic uint64_t dropped;
+
+    // Consumer line
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint tail;
+    atomic_uint waiting;
+} PIDShmRingControlTypeDef_t;
+
+_Static_assert(sizeof(PIDShmHeaderTypeDef_t) == PID_CACHE_LINE_SIZE, "the rings must start cache aligned");
+
+#define PID_SHM_SLOTS_OFFSET (sizeof(PIDShmHeaderTypeDef_t) + (PID_SHM_RINGS * sizeof(PIDShmRingControlTypeDef_t)))
+
+static size_t get_slot_bytes(uint32_t channels)
+{
+    size_t bytes = sizeof(PIDShmFrameTypeDef_t) + (sizeof(float) * channels);
+    return (bytes + PID_CACHE_LINE_SIZE - 1) & ~(size_t)(PID_CACHE_LINE_SIZE - 1);
+}
+
+static size_t get_segment_bytes(uint32_t capacity, size_t slotBytes)
+{
+    return PID_SHM_SLOTS_OFFSET + (PID_SHM_RINGS * (size_t)capacity * slotBytes);
+}
+
+static PIDShmRingControlTypeDef_t *get_ring(const PIDShmTypeDef_t *shm, PIDShmRing_t ring)
+{
+    return (PIDShmRingControlTypeDef_t *)((char *)shm->base + sizeof(PIDShmHeaderTypeDef_t)) + ring;
+}
+
+static PIDShmFrameTypeDef_t *get_slot(const PIDShmTypeDef_t *shm, PIDShmRing_t ring, uint32_t index)
+{
+    size_t slot = ((size_t)ring * shm->capacity) + (index & (shm->capacity - 1));
+    return (PIDShmFrameTypeDef_t *)((char *)shm->base + PID_SHM_SLOTS_OFFSET + (slot * shm->slotBytes));
+}
+
+static long futex(atomic_uint *address, int operation, uint32_t value, const struct timespec *timeout)
+{
+    return syscall(SYS_futex, (uint32_t *)address, operation, value, timeout, NULL, 0);
+}
+
+static void attach(PIDShmTypeDef_t *shm, void *base, size_t size, uint32_t channels, uint32_t capacity,
+                   uint32_t slotBytes)
+{
+    shm->base = base;
+    shm->size = size;
+    shm->channels = channels;
+    shm->capacity = capacity;
+    shm->slotBytes = slotBytes;
+    for (uint32_t ring = 0; ring < PID_SHM_RINGS; ring++)
+    {
+        PIDShmRingControlTypeDef_t *control = get_ring(shm, (PIDShmRing_t)ring);
+        shm->cachedHead[ring] = atomic_load_explicit(&control->head, memory_order_acquire);
+        shm->cachedTail[ring] = atomic_load_explicit(&control->tail, memory_order_acquire);
+    }
+}
+
+/**
+ * @brief creates or replaces a POSIX shared-memory segment with empty rings and attaches to it. Usually called by
+ *        the control process before the sensor process opens the segment.
+ *
+ * @param name shared-memory object name, e.g. "/pid-bay-rack-1"
+ * @param channels floats per frame, at least 1
+ * @param capacity frames per ring, a power of two of at least 2
+ * @param shm receives the attachment
+ * @return int 0 on success, -1 on failure
+ */
+int create_pid_shm(const char *name, uint32_t channels, uint32_t capacity, PIDShmTypeDef_t *shm)
+{
+    if ((name == NULL) || (shm == NULL) || (channels == 0) || (capacity < 2) || ((capacity & (capacity - 1)) != 0))
+    {
+        return -1;
+    }
+
+    const size_t slotBytes = get_slot_bytes(channels);
+    const size_t size = get_segment_bytes(capacity, slotBytes);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return -1;
+    }
+
+    // A fresh object reads as zero, only the header and the atomics need setting up
+    PIDShmHeaderTypeDef_t *header = base;
+    header->version = PID_SHM_VERSION;
+    header->channels = channels;
+    header->capacity = capacity;
+    header->slotBytes = (uint32_t)slotBytes;
+    PIDShmRingControlTypeDef_t *control = (PIDShmRingControlTypeDef_t *)(header + 1);
+    for (uint32_t ring = 0; ring < PID_SHM_RINGS; ring++)
+    {
+        atomic_init(&control[ring].head, 0);
+        control[ring].sequence = 0;
+        atomic_init(&control[ring].dropped, 0);
+        atomic_init(&control[ring].tail, 0);
+        atomic_init(&control[ring].waiting, 0);
+    }
+    atomic_store_explicit(&header->magic, PID_SHM_MAGIC, memory_order_release);
+
+    attach(shm, base, size, channels, capacity, (uint32_t)slotBytes);
+    return 0;
+}
+
+/**
+ * @brief attaches to a segment created by create_pid_shm, in this or another process
+ *
+ * @param name shared-memory object name
+ * @param shm receives the attachment
+ * @return int 0 on success, -1 if the segment does not exist or is not a valid segment
+ */
+int open_pid_shm(const char *name, PIDShmTypeDef_t *shm)
+{
+    if ((name == NULL) || (shm == NULL))
+    {
+        return -1;
+    }
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat status;
+    if ((fstat(fd, &status) != 0) || ((size_t)status.st_size < PID_SHM_SLOTS_OFFSET))
+    {
+        close(fd);
+        return -1;
+    }
+
+    const size_t size = (size_t)status.st_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    PIDShmHeaderTypeDef_t *header = base;
+    if ((atomic_load_explicit(&header->magic, memory_order_acquire) != PID_SHM_MAGIC) ||
+        (header->version != PID_SHM_VERSION) || (header->channels == 0) || (header->capacity < 2) ||
+        ((header->capacity & (header->capacity - 1)) != 0) || (header->slotBytes != get_slot_bytes(header->channels)) ||
+        (get_segment_bytes(header->capacity, header->slotBytes) != size))
+    {
+        munmap(base, size);
+        return -1;
+    }
+
+    attach(shm, base, size, header->channels, header->capacity, header->slotBytes);
+    return 0;
+}
+
+/**
+ * @brief detaches from a segment, which lives on until it is unlinked and every process has detached
+ */
+void close_pid_shm(PIDShmTypeDef_t *shm)
+{
+    if ((shm == NULL) || (shm->base == NULL))
+    {
+        return;
+    }
+
+    munmap(shm->base, shm->size);
+    shm->base = NULL;
+}
+
+int unlink_pid_shm(const char *name)
+{
+    if (name == NULL)
+    {
+        return -1;
+    }
+
+    return (shm_unlink(name) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief slot of the next frame, to be filled in place through pid_shm_frame_values and then published with
+ *        commit_pid_shm_write. Must only be called by the single producer of the ring. Never blocks: when the ring
+ *        is full the frame is dropped and counted instead.
+ *
+ * @param shm attachment
+ * @param ring ring to produce to
+ * @return PIDShmFrameTypeDef_t* slot to fill, NULL if the ring is full
+ */
+PIDShmFrameTypeDef_t *begin_pid_shm_write(PIDShmTypeDef_t *shm, PIDShmRing_t ring)
+{
+    PIDShmRingControlTypeDef_t *control = get_ring(shm, ring);
+    uint32_t head = atomic_load_explicit(&control->head, memory_order_relaxed);
+    if ((head - shm->cachedTail[ring]) == shm->capacity)
+    {
+        shm->cachedTail[ring] = atomic_load_explicit(&control->tail, memory_order_acquire);
+        if ((head - shm->cachedTail[ring]) == shm->capacity)
+        {
+            control->sequence++;
+            atomic_fetch_add_explicit(&control->dropped, 1, memory_order_relaxed);
+            return NULL;
+        }
+    }
+
+    return get_slot(shm, ring, head);
+}
+
+static void publish(PIDShmTypeDef_t *shm, PIDShmRing_t ring, uint64_t sequence, uint64_t timestampNs)
+{
+    PIDShmRingControlTypeDef_t *control = get_ring(shm, ring);
+    uint32_t head = atomic_load_explicit(&control->head, memory_order_relaxed);
+    PIDShmFrameTypeDef_t *frame = get_slot(shm, ring, head);
+    frame->sequence = sequence;
+    frame->timestampNs = timestampNs;
+
+    // Sequentially consistent with the consumer announcing that it sleeps, so one of the two sees the other. Only
+    // the consumer clears the flag: a clear here could land after a newer announcement and lose its wake.
+    atomic_store_explicit(&control->head, head + 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&control->waiting, memory_order_seq_cst) != 0)
+    {
+        futex(&control->head, FUTEX_WAKE, INT_MAX, NULL);
+    }
+}
+
+/**
+ * @brief publishes the frame returned by the last begin_pid_shm_write and wakes the consumer if it sleeps
+ *
+ * @param shm attachment
+ * @param ring ring produced to
+ * @param timestampNs time the frame was sampled
+ */
+void commit_pid_shm_write(PIDShmTypeDef_t *shm, PIDShmRing_t ring, uint64_t timestampNs)
+{
+    PIDShmRingControlTypeDef_t *control = get_ring(shm, ring);
+    publish(shm, ring, control->sequence++, timestampNs);
+}
+
+/**
+ * @brief oldest unconsumed frame, read in place. Must only be called by the single consumer of the ring.
+ *
+ * @param shm attachment
+ * @param ring ring to consume from
+ * @return const PIDShmFrameTypeDef_t* frame, valid until release_pid_shm_frame, NULL if the ring is empty
+ */
+const PIDShmFrameTypeDef_t *peek_pid_shm_frame(PIDShmTypeDef_t *shm, PIDShmRing_t ring)
+{
+    PIDShmRingControlTypeDef_t *control = get_ring(shm, ring);
+    uint32_t tail = atomic_load_explicit(&control->tail, memory_order_relaxed);
+    if (tail == shm->cachedHead[ring])
+    {
+        shm->cachedHead[ring] = atomic_load_explicit(&control->head, memory_order_acquire);
+        if (tail == shm->cachedHead[ring])
+        {
+            return NULL;
+        }
+    }
+
+    return get_slot(shm, ring, tail);
+}
+
+/**
+ * @brief hands the frame returned by peek_pid_shm_frame back to the producer
+ */
+void release_pid_shm_frame(PIDShmTypeDef_t *shm, PIDShmRing_t ring)
+{
+    PIDShmRingControlTypeDef_t *control = get_ring(shm, ring);
+    uint32_t tail = atomic_load_explicit(&control->tail, memory_order_relaxed);
+    atomic_store_explicit(&control->tail, tail + 1, memory_order_release);
+}
+
+static uint64_t get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief sleeps on a futex until the ring has a frame. Costs nothing when a frame is already there, and the producer
+ *        only enters the kernel to wake a consumer that actually sleeps.
+ *
+ * @param shm attachment
+ * @param ring ring to consume from
+ * @param timeoutNs longest time to wait
+ * @return int 0 if a frame is available, -1 on timeout
+ */
+int wait_pid_shm_frame(PIDShmTypeDef_t *shm, PIDShmRing_t ring, uint64_t timeoutNs)
+{
+    PIDShmRingControlTypeDef_t *control = get_ring(shm, ring);
+    const uint64_t deadline = get_monotonic_ns() + timeoutNs;
+    int ret = 0;
+    while (peek_pid_shm_frame(shm, ring) == NULL)
+    {
+        atomic_store_explicit(&control->waiting, 1, memory_order_seq_cst);
+        uint32_t head = atomic_load_explicit(&control->head, memory_order_seq_cst);
+        if (head != atomic_load_explicit(&control->tail, memory_order_relaxed))
+        {
+            continue;
+        }
+
+        uint64_t now = get_monotonic_ns();
+        if (now >= deadline)
+        {
+            ret = -1;
+            break;
+        }
+
+        struct timespec remaining = {.tv_sec = (time_t)((deadline - now) / 1000000000u),
+                                     .tv_nsec = (long)((deadline - now) % 1000000000u)};
+        // Returns at once if the head moved since it was read, so a frame published in between is not missed
+        futex(&control->head, FUTEX_WAIT, head, &remaining);
+    }
+
+    atomic_store_explicit(&control->waiting, 0, memory_order_relaxed);
+    return ret;
+}
+
+/**
+ * @brief frames dropped because the ring was full when they were produced
+ */
+uint64_t get_pid_shm_dropped(const PIDShmTypeDef_t *shm, PIDShmRing_t ring)
+{
+    if ((shm == NULL) || (shm->base == NULL))
+    {
+        return 0;
+    }
+
+    return atomic_load_explicit(&get_ring(shm, ring)->dropped, memory_order_relaxed);
+}
+
+/**
+ * @brief steps a bank once per pending measurement frame. Measurements are read straight from their slot and the
+ *        outputs written straight into an output slot, which gets the sequence and timestamp of its measurement
+ *        frame. Stops early when the output ring is full, leaving the measurements queued, so output frames are never
+ *        dropped.
+ *
+ * @param bank bank of shm->channels controllers
+ * @param shm attachment of the control process, the consumer of measurements and producer of outputs
+ * @param maxFrames most frames to process
+ * @return uint32_t number of frames processed
+ */
+uint32_t step_pid_shm_batch(PIDBankTypeDef_t *bank, PIDShmTypeDef_t *shm, uint32_t maxFrames)
+{
+    if ((bank == NULL) || (shm == NULL) || (shm->base == NULL) || (bank->count != shm->channels))
+    {
+        return 0;
+    }
+
+    PIDShmRingControlTypeDef_t *output = get_ring(shm, PID_SHM_OUTPUT);
+    uint32_t processed = 0;
+    while (processed < maxFrames)
+    {
+        const PIDShmFrameTypeDef_t *measurement = peek_pid_shm_frame(shm, PID_SHM_MEASUREMENT);
+        if (measurement == NULL)
+        {
+            break;
+        }
+
+        uint32_t head = atomic_load_explicit(&output->head, memory_order_relaxed);
+        if ((head - shm->cachedTail[PID_SHM_OUTPUT]) == shm->capacity)
+        {
+            shm->cachedTail[PID_SHM_OUTPUT] = atomic_load_explicit(&output->tail, memory_order_acquire);
+            if ((head - shm->cachedTail[PID_SHM_OUTPUT]) == shm->capacity)
+            {
+                break;
+            }
+        }
+
+        calc_pid_output_batch(bank, pid_shm_frame_const_values(measurement),
+                              pid_shm_frame_values(get_slot(shm, PID_SHM_OUTPUT, head)));
+        publish(shm, PID_SHM_OUTPUT, measurement->sequence, measurement->timestampNs);
+        release_pid_shm_frame(shm, PID_SHM_MEASUREMENT);
+        processed++;
+    }
+
+    return processed;
+}
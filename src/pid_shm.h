@@ -0,0 +1,69 @@
+#ifndef PID_SHM_H
+#define PID_SHM_H
+
+#include "pid_bank.h"
+
+#define PID_SHM_MAGIC 0x4D485350u // "PSHM" little endian
+#define PID_SHM_VERSION 1
+
+/**
+ * @brief Rings of a shared-memory segment. The sensor process produces measurement frames, the control process
+ *        consumes them and produces one output frame per measurement frame.
+ */
+typedef enum
+{
+    PID_SHM_MEASUREMENT = 0,
+    PID_SHM_OUTPUT,
+    PID_SHM_RINGS
+} PIDShmRing_t;
+
+/**
+ * @brief Frame header, followed in its slot by channels floats, see pid_shm_frame_values. Slots are whole cache
+ *        lines, so producer and consumer never share a line except at the ring indices.
+ */
+typedef struct
+{
+    uint64_t sequence;    // counts every produced frame, dropped ones included; outputs repeat their measurement's
+    uint64_t timestampNs; // set by the producer, outputs repeat their measurement's
+} PIDShmFrameTypeDef_t;
+
+/**
+ * @brief Attachment of a process to a segment. The segment holds a header, two single-producer/single-consumer rings
+ *        of capacity frames each and their slots. The cached indices are private to the attaching process.
+ */
+typedef struct
+{
+    void *base;
+    size_t size;
+    uint32_t channels;
+    uint32_t capacity;
+    uint32_t slotBytes;
+    uint32_t cachedHead[PID_SHM_RINGS];
+    uint32_t cachedTail[PID_SHM_RINGS];
+} PIDShmTypeDef_t;
+
+static inline float *pid_shm_frame_values(PIDShmFrameTypeDef_t *frame)
+{
+    return (float *)(frame + 1);
+}
+
+static inline const float *pid_shm_frame_const_values(const PIDShmFrameTypeDef_t *frame)
+{
+    return (const float *)(frame + 1);
+}
+
+int create_pid_shm(const char *name, uint32_t channels, uint32_t capacity, PIDShmTypeDef_t *shm);
+int open_pid_shm(const char *name, PIDShmTypeDef_t *shm);
+void close_pid_shm(PIDShmTypeDef_t *shm);
+int unlink_pid_shm(const char *name);
+
+PIDShmFrameTypeDef_t *begin_pid_shm_write(PIDShmTypeDef_t *shm, PIDShmRing_t ring);
+void commit_pid_shm_write(PIDShmTypeDef_t *shm, PIDShmRing_t ring, uint64_t timestampNs);
+const PIDShmFrameTypeDef_t *peek_pid_shm_frame(PIDShmTypeDef_t *shm, PIDShmRing_t ring);
+void release_pid_shm_frame(PIDShmTypeDef_t *shm, PIDShmRing_t ring);
+int wait_pid_shm_frame(PIDShmTypeDef_t *shm, PIDShmRing_t ring, uint64_t timeoutNs);
+uint64_t get_pid_shm_dropped(const PIDShmTypeDef_t *shm, PIDShmRing_t ring);
+
+uint32_t step_pid_shm_batch(PIDBankTypeDef_t *bank, PIDShmTypeDef_t *shm, uint32_t maxFrames);
+
+#endif
@@ -0,0 +1,328 @@
+#include "pid_simd.h"
+#include "pid_internal.h"
+
+#include <stdatomic.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PID_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define PID_SIMD_ARM 1
+#include <arm_neon.h>
+#endif
+
+typedef void (*PIDBatchKernel_t)(PIDBankTypeDef_t *bank, const float *currentOutput, float *output, uint32_t begin,
+                                 uint32_t end);
+
+/**
+ * @brief reference kernel, also used for the tail of the vector kernels
+ */
+static void calc_batch_scalar(PIDBankTypeDef_t *bank, const float *currentOutput, float *output, uint32_t begin,
+                              uint32_t end)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        float error = bank->referencePoint[i] - currentOutput[i];
+        bank->error[i] = error;
+
+        output[i] = pid_step(bank->kI[i], bank->KP[i], bank->lowerLimit[i], bank->upperLimit[i], error,
+                             &bank->previousError[i], &bank->previousOutput[i]);
+    }
+}
+
+#if defined(PID_SIMD_X86)
+
+/**
+ * @brief branch-free pid_saturate on 8 lanes. The upper limit blend is applied last so it wins over the lower
+ *        limit, exactly like the if/else chain. Unordered compares keep NaN lanes unsaturated, as in the scalar code.
+ *        Counts the branch of every lane when built with PID_ENABLE_INSTRUMENTATION.
+ */
+__attribute__((target("avx2"))) static inline __m256 saturate_avx2(__m256 value, __m256 lower, __m256 upper)
+{
+    __m256 below = _mm256_cmp_ps(value, lower, _CMP_LT_OQ);
+    __m256 above = _mm256_cmp_ps(value, upper, _CMP_GT_OQ);
+    PID_INSTR_SATURATION_LANES((uint32_t)_mm256_movemask_ps(above), (uint32_t)_mm256_movemask_ps(below), 8);
+
+    __m256 ret = _mm256_blendv_ps(value, lower, below);
+    return _mm256_blendv_ps(ret, upper, above);
+}
+
+__attribute__((target("avx2"))) static void calc_batch_avx2(PIDBankTypeDef_t *bank, const float *currentOutput,
+                                                            float *output, uint32_t begin, uint32_t end)
+{
+    const float *kI = bank->kI;
+    const float *KP = bank->KP;
+    const float *upperLimit = bank->upperLimit;
+    const float *lowerLimit = bank->lowerLimit;
+    const float *referencePoint = bank->referencePoint;
+    float *errors = bank->error;
+    float *previousError = bank->previousError;
+    float *previousOutput = bank->previousOutput;
+
+    uint32_t i = begin;
+    for (; (end - i) >= 8; i += 8)
+    {
+        __m256 upper = _mm256_loadu_ps(&upperLimit[i]);
+        __m256 lower = _mm256_loadu_ps(&lowerLimit[i]);
+
+        __m256 error = _mm256_sub_ps(_mm256_loadu_ps(&referencePoint[i]), _mm256_loadu_ps(&currentOutput[i]));
+        _mm256_storeu_ps(&errors[i], error);
+
+        __m256 newIntegral = _mm256_mul_ps(_mm256_loadu_ps(&kI[i]), error);
+        __m256 newOutput = _mm256_add_ps(newIntegral, _mm256_loadu_ps(&previousError[i]));
+        newOutput = _mm256_add_ps(newOutput, _mm256_loadu_ps(&previousOutput[i]));
+        newOutput = saturate_avx2(newOutput, lower, upper);
+
+        _mm256_storeu_ps(&previousError[i], newIntegral);
+        _mm256_storeu_ps(&previousOutput[i], newOutput);
+
+        __m256 sum = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&KP[i]), error), newOutput);
+        _mm256_storeu_ps(&output[i], saturate_avx2(sum, lower, upper));
+    }
+
+    // Leave the upper halves clean before the scalar tail and the caller run SSE code
+    _mm256_zeroupper();
+    calc_batch_scalar(bank, currentOutput, output, i, end);
+}
+
+__attribute__((target("avx512f"))) static inline __m512 saturate_avx512(__m512 value, __m512 lower, __m512 upper)
+{
+    __mmask16 below = _mm512_cmp_ps_mask(value, lower, _CMP_LT_OQ);
+    __mmask16 above = _mm512_cmp_ps_mask(value, upper, _CMP_GT_OQ);
+    PID_INSTR_SATURATION_LANES(above, below, 16);
+
+    __m512 ret = _mm512_mask_blend_ps(below, value, lower);
+    return _mm512_mask_blend_ps(above, ret, upper);
+}
+
+__attribute__((target("avx512f"))) static void calc_batch_avx512(PIDBankTypeDef_t *bank, const float *currentOutput,
+                                                                 float *output, uint32_t begin, uint32_t end)
+{
+    const float *kI = bank->kI;
+    const float *KP = bank->KP;
+    const float *upperLimit = bank->upperLimit;
+    const float *lowerLimit = bank->lowerLimit;
+    const float *referencePoint = bank->referencePoint;
+    float *errors = bank->error;
+    float *previousError = bank->previousError;
+    float *previousOutput = bank->previousOutput;
+
+    uint32_t i = begin;
+    for (; (end - i) >= 16; i += 16)
+    {
+        __m512 upper = _mm512_loadu_ps(&upperLimit[i]);
+        __m512 lower = _mm512_loadu_ps(&lowerLimit[i]);
+
+        __m512 error = _mm512_sub_ps(_mm512_loadu_ps(&referencePoint[i]), _mm512_loadu_ps(&currentOutput[i]));
+        _mm512_storeu_ps(&errors[i], error);
+
+        __m512 newIntegral = _mm512_mul_ps(_mm512_loadu_ps(&kI[i]), error);
+        __m512 newOutput = _mm512_add_ps(newIntegral, _mm512_loadu_ps(&previousError[i]));
+        newOutput = _mm512_add_ps(newOutput, _mm512_loadu_ps(&previousOutput[i]));
+        newOutput = saturate_avx512(newOutput, lower, upper);
+
+        _mm512_storeu_ps(&previousError[i], newIntegral);
+        _mm512_storeu_ps(&previousOutput[i], newOutput);
+
+        __m512 sum = _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(&KP[i]), error), newOutput);
+        _mm512_storeu_ps(&output[i], saturate_avx512(sum, lower, upper));
+    }
+
+    _mm256_zeroupper();
+    calc_batch_scalar(bank, currentOutput, output, i, end);
+}
+
+#elif defined(PID_SIMD_ARM)
+
+#ifdef PID_ENABLE_INSTRUMENTATION
+/**
+ * @brief packs a compare result into one bit per lane, the way movemask does on x86
+ */
+static inline uint32_t get_lane_mask_neon(uint32x4_t mask)
+{
+    return (vgetq_lane_u32(mask, 0) & 1u) | (vgetq_lane_u32(mask, 1) & 2u) | (vgetq_lane_u32(mask, 2) & 4u) |
+           (vgetq_lane_u32(mask, 3) & 8u);
+}
+#endif
+
+static inline float32x4_t saturate_neon(float32x4_t value, float32x4_t lower, float32x4_t upper)
+{
+    uint32x4_t below = vcltq_f32(value, lower);
+    uint32x4_t above = vcgtq_f32(value, upper);
+    PID_INSTR_SATURATION_LANES(get_lane_mask_neon(above), get_lane_mask_neon(below), 4);
+
+    float32x4_t ret = vbslq_f32(below, lower, value);
+    return vbslq_f32(above, upper, ret);
+}
+
+static void calc_batch_neon(PIDBankTypeDef_t *bank, const float *currentOutput, float *output, uint32_t begin,
+                            uint32_t end)
+{
+    const float *kI = bank->kI;
+    const float *KP = bank->KP;
+    const float *upperLimit = bank->upperLimit;
+    const float *lowerLimit = bank->lowerLimit;
+    const float *referencePoint = bank->referencePoint;
+    float *errors = bank->error;
+    float *previousError = bank->previousError;
+    float *previousOutput = bank->previousOutput;
+
+    uint32_t i = begin;
+    for (; (end - i) >= 4; i += 4)
+    {
+        float32x4_t upper = vld1q_f32(&upperLimit[i]);
+        float32x4_t lower = vld1q_f32(&lowerLimit[i]);
+
+        float32x4_t error = vsubq_f32(vld1q_f32(&referencePoint[i]), vld1q_f32(&currentOutput[i]));
+        vst1q_f32(&errors[i], error);
+
+        float32x4_t newIntegral = vmulq_f32(vld1q_f32(&kI[i]), error);
+        float32x4_t newOutput = vaddq_f32(newIntegral, vld1q_f32(&previousError[i]));
+        newOutput = vaddq_f32(newOutput, vld1q_f32(&previousOutput[i]));
+        newOutput = saturate_neon(newOutput, lower, upper);
+
+        vst1q_f32(&previousError[i], newIntegral);
+        vst1q_f32(&previousOutput[i], newOutput);
+
+        float32x4_t sum = vaddq_f32(vmulq_f32(vld1q_f32(&KP[i]), error), newOutput);
+        vst1q_f32(&output[i], saturate_neon(sum, lower, upper));
+    }
+
+    calc_batch_scalar(bank, currentOutput, output, i, end);
+}
+
+#endif
+
+static PIDBatchKernel_t get_kernel(PIDSimdLevel_t level)
+{
+    switch (level)
+    {
+#if defined(PID_SIMD_X86)
+    case PID_SIMD_AVX2:
+        return calc_batch_avx2;
+    case PID_SIMD_AVX512:
+        return calc_batch_avx512;
+#elif defined(PID_SIMD_ARM)
+    case PID_SIMD_NEON:
+        return calc_batch_neon;
+#endif
+    default:
+        return calc_batch_scalar;
+    }
+}
+
+static PIDSimdLevel_t detect_best_level(void)
+{
+    PIDSimdLevel_t level = PID_SIMD_SCALAR;
+    for (int candidate = PID_SIMD_AVX512; candidate > PID_SIMD_SCALAR; candidate--)
+    {
+        if (is_pid_simd_level_supported((PIDSimdLevel_t)candidate))
+        {
+            level = (PIDSimdLevel_t)candidate;
+            break;
+        }
+    }
+
+    return level;
+}
+
+// -1 until the first batch call or set_pid_simd_level resolves it
+static atomic_int activeLevel = -1;
+
+/**
+ * @brief checks whether the given level was compiled in and is supported by the CPU we are running on
+ *
+ * @param level instruction set to check
+ * @return uint8_t 1 if supported, 0 otherwise
+ */
+uint8_t is_pid_simd_level_supported(PIDSimdLevel_t level)
+{
+    uint8_t ret = 0;
+    switch (level)
+    {
+    case PID_SIMD_SCALAR:
+        ret = 1;
+        break;
+#if defined(PID_SIMD_X86)
+    case PID_SIMD_AVX2:
+        ret = __builtin_cpu_supports("avx2") ? 1 : 0;
+        break;
+    case PID_SIMD_AVX512:
+        ret = __builtin_cpu_supports("avx512f") ? 1 : 0;
+        break;
+#elif defined(PID_SIMD_ARM)
+    case PID_SIMD_NEON:
+        ret = 1;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief returns the level the batched step currently runs on, detecting it on first use
+ *
+ * @return PIDSimdLevel_t
+ */
+PIDSimdLevel_t get_pid_simd_level(void)
+{
+    int level = atomic_load_explicit(&activeLevel, memory_order_relaxed);
+    if (level < 0)
+    {
+        level = detect_best_level();
+        atomic_store_explicit(&activeLevel, level, memory_order_relaxed);
+    }
+
+    return (PIDSimdLevel_t)level;
+}
+
+/**
+ * @brief forces the batched step onto the given instruction set, e.g. to compare kernels or to fall back to scalar
+ *
+ * @param level instruction set to use
+ * @return uint8_t 1 on success, 0 if the level is not supported, in which case the active level is unchanged
+ */
+uint8_t set_pid_simd_level(PIDSimdLevel_t level)
+{
+    if (!is_pid_simd_level_supported(level))
+    {
+        return 0;
+    }
+
+    atomic_store_explicit(&activeLevel, level, memory_order_relaxed);
+    return 1;
+}
+
+/**
+ * @brief steps controllers [begin, end) of a bank on the active instruction set. Indices are absolute, controller i
+ *        reads currentOutput[i] and writes output[i].
+ *
+ * @param bank structure-of-arrays bank of voltage or current stages
+ * @param currentOutput array of system outputs
+ * @param output array of controller outputs
+ * @param begin first controller to step
+ * @param end one past the last controller to step, clamped to bank->count
+ */
+void calc_pid_output_batch_range(PIDBankTypeDef_t *bank, const float *currentOutput, float *output, uint32_t begin,
+                                 uint32_t end)
+{
+    if ((bank == NULL) || (currentOutput == NULL) || (output == NULL))
+    {
+        return;
+    }
+
+    if (end > bank->count)
+    {
+        end = bank->count;
+    }
+
+    if (begin >= end)
+    {
+        return;
+    }
+
+    get_kernel(get_pid_simd_level())(bank, currentOutput, output, begin, end);
+}
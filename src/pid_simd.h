@@ -0,0 +1,25 @@
+#ifndef PID_SIMD_H
+#define PID_SIMD_H
+
+#include "pid_bank.h"
+
+/**
+ * @brief Instruction sets the batched proportional-integral step can run on. The best supported level is picked
+ *        the first time a bank is stepped, a lower one can be forced with set_pid_simd_level.
+ */
+typedef enum
+{
+    PID_SIMD_SCALAR = 0,
+    PID_SIMD_NEON,
+    PID_SIMD_AVX2,
+    PID_SIMD_AVX512,
+} PIDSimdLevel_t;
+
+PIDSimdLevel_t get_pid_simd_level(void);
+uint8_t is_pid_simd_level_supported(PIDSimdLevel_t level);
+uint8_t set_pid_simd_level(PIDSimdLevel_t level);
+
+void calc_pid_output_batch_range(PIDBankTypeDef_t *bank, const float *currentOutput, float *output, uint32_t begin,
+                                 uint32_t end);
+
+#endif
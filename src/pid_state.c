@@ -0,0 +1,172 @@
+#include "pid_state.h"
+#include "pid_internal.h"
+
+static float calc_state_output(const PIDGainProfileTypeDef_t *profile, PIDStateTypeDef_t *state, float error)
+{
+    return pid_step(profile->kI, profile->KP, profile->lowerLimit, profile->upperLimit, error, &state->previousError,
+                    &state->previousOutput);
+}
+
+/**
+ * @brief performs proportional and integral calculation for a controller split into hot state and a shared profile.
+ *
+ * @param profiles gain profile table, indexed by state->profile
+ * @param state hot state of the controller
+ * @param currentOutput representing the current system output
+ * @return float
+ */
+float calc_pid_state_output(const PIDGainProfileTypeDef_t *profiles, PIDStateTypeDef_t *state, float currentOutput)
+{
+    if ((profiles == NULL) || (state == NULL))
+    {
+        return 0;
+    }
+
+    const PIDGainProfileTypeDef_t *profile = &profiles[state->profile];
+
+    return calc_state_output(profile, state, profile->referencePoint - currentOutput);
+}
+
+/**
+ * @brief steps an array of hot states against their shared profiles.
+ *
+ * @param profiles gain profile table, indexed by states[i].profile
+ * @param states array of count hot states
+ * @param count number of controllers
+ * @param referencePoint per-controller references (e.g. current stages fed by a voltage stage), or NULL to use the
+ *        reference of each profile
+ * @param currentOutput array of count system outputs
+ * @param output array of count controller outputs
+ */
+void calc_pid_state_output_batch(const PIDGainProfileTypeDef_t *profiles, PIDStateTypeDef_t *states, uint32_t count,
+                                 const float *referencePoint, const float *currentOutput, float *output)
+{
+    if ((profiles == NULL) || (states == NULL) || (currentOutput == NULL) || (output == NULL))
+    {
+        return;
+    }
+
+    if (referencePoint == NULL)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const PIDGainProfileTypeDef_t *profile = &profiles[states[i].profile];
+            output[i] = calc_state_output(profile, &states[i], profile->referencePoint - currentOutput[i]);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const PIDGainProfileTypeDef_t *profile = &profiles[states[i].profile];
+            output[i] = calc_state_output(profile, &states[i], referencePoint[i] - currentOutput[i]);
+        }
+    }
+}
+
+/**
+ * @brief This function resets the memory elements of an array of integral controllers
+ *
+ * @param states array of count hot states, the profile index is kept
+ * @param count number of controllers
+ */
+void reset_pid_state_memory(PIDStateTypeDef_t *states, uint32_t count)
+{
+    if (states == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        states[i].previousError = 0;
+        states[i].previousOutput = 0;
+    }
+}
+
+/**
+ * @brief splits a PIDTypeDef_t into its read-only profile and its hot state, kD is dropped
+ *
+ * @param pidObject controller to split
+ * @param profileIndex index the profile will be stored at in the profile table
+ * @param profile profile to fill, may be NULL when the profile is already in the table
+ * @param state hot state to fill
+ */
+void split_pid_object(const PIDTypeDef_t *pidObject, uint32_t profileIndex, PIDGainProfileTypeDef_t *profile,
+                      PIDStateTypeDef_t *state)
+{
+    if ((pidObject == NULL) || (state == NULL))
+    {
+        return;
+    }
+
+    if (profile != NULL)
+    {
+        profile->kI = pidObject->kI;
+        profile->KP = pidObject->KP;
+        profile->upperLimit = pidObject->upperLimit;
+        profile->lowerLimit = pidObject->lowerLimit;
+        profile->referencePoint = pidObject->referencePoint;
+    }
+
+    state->previousError = pidObject->previousError;
+    state->previousOutput = pidObject->previousOutput;
+    state->profile = profileIndex;
+}
+
+/**
+ * @brief rebuilds a PIDTypeDef_t from a hot state and its profile, kD and error are left untouched
+ *
+ * @param profiles gain profile table, indexed by state->profile
+ * @param state hot state to read
+ * @param pidObject controller to fill
+ */
+void merge_pid_object(const PIDGainProfileTypeDef_t *profiles, const PIDStateTypeDef_t *state,
+                      PIDTypeDef_t *pidObject)
+{
+    if ((profiles == NULL) || (state == NULL) || (pidObject == NULL))
+    {
+        return;
+    }
+
+    const PIDGainProfileTypeDef_t *profile = &profiles[state->profile];
+    pidObject->kI = profile->kI;
+    pidObject->KP = profile->KP;
+    pidObject->upperLimit = profile->upperLimit;
+    pidObject->lowerLimit = profile->lowerLimit;
+    pidObject->referencePoint = profile->referencePoint;
+    pidObject->previousError = state->previousError;
+    pidObject->previousOutput = state->previousOutput;
+}
+
+/**
+ * @brief splits count states into parts ranges whose boundaries are multiples of PID_STATE_GROUP, so that threads
+ *        stepping neighbouring ranges never share a cache line.
+ *
+ * @param count number of controllers
+ * @param parts number of ranges, e.g. the number of threads
+ * @param part range to compute, lower than parts
+ * @param begin first state of the range
+ * @param end one past the last state of the range
+ */
+void get_pid_state_partition(uint32_t count, uint32_t parts, uint32_t part, uint32_t *begin, uint32_t *end)
+{
+    if ((begin == NULL) || (end == NULL))
+    {
+        return;
+    }
+
+    if ((parts == 0) || (part >= parts))
+    {
+        *begin = count;
+        *end = count;
+        return;
+    }
+
+    uint32_t groups = (count + PID_STATE_GROUP - 1) / PID_STATE_GROUP;
+    uint32_t first = (uint32_t)(((uint64_t)groups * part) / parts) * PID_STATE_GROUP;
+    uint32_t last = (uint32_t)(((uint64_t)groups * (part + 1)) / parts) * PID_STATE_GROUP;
+
+    *begin = (first < count) ? first : count;
+    *end = (last < count) ? last : count;
+}
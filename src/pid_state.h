@@ -0,0 +1,45 @@
+#ifndef PID_STATE_H
+#define PID_STATE_H
+
+#include "pid.h"
+
+/**
+ * @brief Read-only configuration of a controller. Many controllers can share one profile by index.
+ */
+typedef struct
+{
+    float kI;
+    float KP;
+    float upperLimit;
+    float lowerLimit;
+    float referencePoint;
+} PIDGainProfileTypeDef_t;
+
+/**
+ * @brief Per-controller state written on every step, 12 bytes. The error is not kept since it is only an
+ *        intermediate of the step.
+ */
+typedef struct
+{
+    float previousError;
+    float previousOutput;
+    uint32_t profile;
+} PIDStateTypeDef_t;
+
+/**
+ * @brief Number of states that exactly fills whole cache lines (16 * 12 bytes = 3 lines). Threads stepping ranges
+ *        that start on a multiple of this never write to the same cache line, provided the array is cache aligned.
+ */
+#define PID_STATE_GROUP 16
+
+float calc_pid_state_output(const PIDGainProfileTypeDef_t *profiles, PIDStateTypeDef_t *state, float currentOutput);
+void calc_pid_state_output_batch(const PIDGainProfileTypeDef_t *profiles, PIDStateTypeDef_t *states, uint32_t count,
+                                 const float *referencePoint, const float *currentOutput, float *output);
+void reset_pid_state_memory(PIDStateTypeDef_t *states, uint32_t count);
+void split_pid_object(const PIDTypeDef_t *pidObject, uint32_t profileIndex, PIDGainProfileTypeDef_t *profile,
+                      PIDStateTypeDef_t *state);
+void merge_pid_object(const PIDGainProfileTypeDef_t *profiles, const PIDStateTypeDef_t *state,
+                      PIDTypeDef_t *pidObject);
+void get_pid_state_partition(uint32_t count, uint32_t parts, uint32_t part, uint32_t *begin, uint32_t *end);
+
+#endif
@@ -0,0 +1,340 @@
+#include "pid_steal.h"
+#include "pid.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct
+{
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t range; // next in the low, end in the high 32 bits
+    atomic_uint steals;
+} PIDStealSlotTypeDef_t;
+
+struct PIDStealSchedulerTypeDef
+{
+    uint32_t workers;
+    PIDStealSlotTypeDef_t *slots;
+};
+
+static inline uint64_t pack_range(uint32_t next, uint32_t end)
+{
+    return ((uint64_t)end << 32) | next;
+}
+
+static inline uint32_t range_next(uint64_t range)
+{
+    return (uint32_t)range;
+}
+
+static inline uint32_t range_end(uint64_t range)
+{
+    return (uint32_t)(range >> 32);
+}
+
+static inline uint32_t range_size(uint64_t range)
+{
+    return (range_end(range) > range_next(range)) ? (range_end(range) - range_next(range)) : 0;
+}
+
+/**
+ * @brief allocates a scheduler for the given number of workers, with no work assigned
+ *
+ * @param workers number of workers, at least 1
+ * @return PIDStealSchedulerTypeDef_t* NULL on failure
+ */
+PIDStealSchedulerTypeDef_t *create_pid_steal_scheduler(uint32_t workers)
+{
+    if (workers == 0)
+    {
+        return NULL;
+    }
+
+    PIDStealSchedulerTypeDef_t *scheduler = malloc(sizeof(*scheduler));
+    if (scheduler == NULL)
+    {
+        return NULL;
+    }
+
+    size_t bytes = sizeof(PIDStealSlotTypeDef_t) * workers;
+    bytes = (bytes + PID_CACHE_LINE_SIZE - 1) & ~(size_t)(PID_CACHE_LINE_SIZE - 1);
+    scheduler->slots = aligned_alloc(PID_CACHE_LINE_SIZE, bytes);
+    if (scheduler->slots == NULL)
+    {
+        free(scheduler);
+        return NULL;
+    }
+
+    scheduler->workers = workers;
+    for (uint32_t i = 0; i < workers; i++)
+    {
+        atomic_init(&scheduler->slots[i].range, 0);
+        atomic_init(&scheduler->slots[i].steals, 0);
+    }
+
+    return scheduler;
+}
+
+void destroy_pid_steal_scheduler(PIDStealSchedulerTypeDef_t *scheduler)
+{
+    if (scheduler == NULL)
+    {
+        return;
+    }
+
+    free(scheduler->slots);
+    free(scheduler);
+}
+
+/**
+ * @brief splits [0, count) evenly between the workers. Must not race with take_pid_steal_work.
+ *
+ * @param scheduler scheduler to reset
+ * @param count number of work items
+ */
+void reset_pid_steal_scheduler(PIDStealSchedulerTypeDef_t *scheduler, uint32_t count)
+{
+    if (scheduler == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < scheduler->workers; i++)
+    {
+        uint32_t begin = (uint32_t)(((uint64_t)count * i) / scheduler->workers);
+        uint32_t end = (uint32_t)(((uint64_t)count * (i + 1)) / scheduler->workers);
+        atomic_store_explicit(&scheduler->slots[i].range, pack_range(begin, end), memory_order_relaxed);
+        atomic_store_explicit(&scheduler->slots[i].steals, 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief gives every worker an explicit initial range, e.g. the shard it owns. Must not race with
+ *        take_pid_steal_work.
+ *
+ * @param scheduler scheduler to reset
+ * @param begin array with the first item of each worker
+ * @param end array with one past the last item of each worker
+ */
+void reset_pid_steal_scheduler_ranges(PIDStealSchedulerTypeDef_t *scheduler, const uint32_t *begin,
+                                      const uint32_t *end)
+{
+    if ((scheduler == NULL) || (begin == NULL) || (end == NULL))
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < scheduler->workers; i++)
+    {
+        atomic_store_explicit(&scheduler->slots[i].range, pack_range(begin[i], end[i]), memory_order_relaxed);
+        atomic_store_explicit(&scheduler->slots[i].steals, 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief moves the upper half of the largest other range into the thief's slot
+ *
+ * @return uint8_t 1 if something was stolen, 0 if every range is empty
+ */
+static uint8_t steal_work(PIDStealSchedulerTypeDef_t *scheduler, uint32_t thief)
+{
+    for (;;)
+    {
+        uint32_t victim = thief;
+        uint64_t victimRange = 0;
+        for (uint32_t i = 1; i < scheduler->workers; i++)
+        {
+            uint32_t candidate = (thief + i) % scheduler->workers;
+            uint64_t range = atomic_load_explicit(&scheduler->slots[candidate].range, memory_order_relaxed);
+            if (range_size(range) > range_size(victimRange))
+            {
+                victim = candidate;
+                victimRange = range;
+            }
+        }
+
+        if (range_size(victimRange) == 0)
+        {
+            return 0;
+        }
+
+        uint32_t next = range_next(victimRange);
+        uint32_t end = range_end(victimRange);
+        uint32_t middle = next + (range_size(victimRange) / 2);
+
+        if (atomic_compare_exchange_weak_explicit(&scheduler->slots[victim].range, &victimRange,
+                                                  pack_range(next, middle), memory_order_acq_rel,
+                                                  memory_order_relaxed))
+        {
+            // Only the owner refills its own slot, thieves never touch an empty range
+            atomic_store_explicit(&scheduler->slots[thief].range, pack_range(middle, end), memory_order_release);
+            atomic_fetch_add_explicit(&scheduler->slots[thief].steals, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief hands the worker up to grain items from its own range, stealing when it runs dry
+ *
+ * @param scheduler scheduler shared by all workers
+ * @param worker calling worker, each worker index must be used by a single thread
+ * @param grain maximum number of items to take at once
+ * @param begin first item to process
+ * @param end one past the last item to process
+ * @return uint8_t 1 if work was handed out, 0 once every range is empty
+ */
+uint8_t take_pid_steal_work(PIDStealSchedulerTypeDef_t *scheduler, uint32_t worker, uint32_t grain, uint32_t *begin,
+                            uint32_t *end)
+{
+    if ((scheduler == NULL) || (worker >= scheduler->workers) || (begin == NULL) || (end == NULL))
+    {
+        return 0;
+    }
+
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+
+    atomic_uint_fast64_t *slot = &scheduler->slots[worker].range;
+    for (;;)
+    {
+        uint64_t range = atomic_load_explicit(slot, memory_order_acquire);
+        uint32_t size = range_size(range);
+        if (size == 0)
+        {
+            if (!steal_work(scheduler, worker))
+            {
+                return 0;
+            }
+            continue;
+        }
+
+        uint32_t next = range_next(range);
+        uint32_t taken = (size < grain) ? size : grain;
+        if (atomic_compare_exchange_weak_explicit(slot, &range, pack_range(next + taken, range_end(range)),
+                                                  memory_order_acq_rel, memory_order_relaxed))
+        {
+            *begin = next;
+            *end = next + taken;
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief number of successful steals by the worker since the last reset, for load balance statistics
+ */
+uint32_t get_pid_steal_count(const PIDStealSchedulerTypeDef_t *scheduler, uint32_t worker)
+{
+    if ((scheduler == NULL) || (worker >= scheduler->workers))
+    {
+        return 0;
+    }
+
+    return atomic_load_explicit(&((PIDStealSchedulerTypeDef_t *)scheduler)->slots[worker].steals,
+                                memory_order_relaxed);
+}
+
+typedef struct
+{
+    PIDStealSchedulerTypeDef_t *scheduler;
+    uint32_t worker;
+    uint32_t grain;
+    PIDParallelBody_t body;
+    void *context;
+} PIDParallelWorkerTypeDef_t;
+
+static void *parallel_worker(void *argument)
+{
+    PIDParallelWorkerTypeDef_t *worker = argument;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    while (take_pid_steal_work(worker->scheduler, worker->worker, worker->grain, &begin, &end))
+    {
+        worker->body(worker->context, begin, end, worker->worker);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief calls body on every item of [0, count) from threads workers with work stealing. The calling thread is
+ *        worker 0, the call returns once every item has been processed.
+ *
+ * @param count number of items
+ * @param threads number of workers, 0 for one per hardware thread
+ * @param grain number of items handed out at once
+ * @param body called with a sub-range of items and the worker index
+ * @param context passed to body
+ * @return int 0 on success, -1 if the scheduler could not be created. Threads that fail to start are made up for
+ *         by the others.
+ */
+int run_pid_parallel_for(uint32_t count, uint32_t threads, uint32_t grain, PIDParallelBody_t body, void *context)
+{
+    if (body == NULL)
+    {
+        return -1;
+    }
+
+    if (threads == 0)
+    {
+        threads = get_pid_hardware_threads();
+    }
+
+    if (threads > count)
+    {
+        threads = (count > 0) ? count : 1;
+    }
+
+    PIDStealSchedulerTypeDef_t *scheduler = create_pid_steal_scheduler(threads);
+    PIDParallelWorkerTypeDef_t *workers = malloc(sizeof(*workers) * threads);
+    pthread_t *handles = malloc(sizeof(*handles) * threads);
+    uint8_t *started = calloc(threads, sizeof(*started));
+    if ((scheduler == NULL) || (workers == NULL) || (handles == NULL) || (started == NULL))
+    {
+        destroy_pid_steal_scheduler(scheduler);
+        free(workers);
+        free(handles);
+        free(started);
+        return -1;
+    }
+
+    reset_pid_steal_scheduler(scheduler, count);
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        workers[i] = (PIDParallelWorkerTypeDef_t){scheduler, i, grain, body, context};
+    }
+
+    for (uint32_t i = 1; i < threads; i++)
+    {
+        started[i] = (pthread_create(&handles[i], NULL, parallel_worker, &workers[i]) == 0);
+    }
+
+    parallel_worker(&workers[0]);
+
+    for (uint32_t i = 1; i < threads; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(handles[i], NULL);
+        }
+    }
+
+    destroy_pid_steal_scheduler(scheduler);
+    free(workers);
+    free(handles);
+    free(started);
+    return 0;
+}
+
+/**
+ * @brief number of online hardware threads, at least 1
+ */
+uint32_t get_pid_hardware_threads(void)
+{
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return (online > 0) ? (uint32_t)online : 1;
+}
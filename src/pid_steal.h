@@ -0,0 +1,28 @@
+#ifndef PID_STEAL_H
+#define PID_STEAL_H
+
+#include <stdint.h>
+
+/**
+ * @brief Work-stealing scheduler over index ranges. Every worker owns a range [next, end) that it consumes from the
+ *        front; an idle worker steals the upper half of the largest remaining range. Ranges live in one atomic word
+ *        per worker, on its own cache line, so taking work is a single compare-and-swap on a line the owner already
+ *        holds.
+ */
+typedef struct PIDStealSchedulerTypeDef PIDStealSchedulerTypeDef_t;
+
+typedef void (*PIDParallelBody_t)(void *context, uint32_t begin, uint32_t end, uint32_t worker);
+
+PIDStealSchedulerTypeDef_t *create_pid_steal_scheduler(uint32_t workers);
+void destroy_pid_steal_scheduler(PIDStealSchedulerTypeDef_t *scheduler);
+void reset_pid_steal_scheduler(PIDStealSchedulerTypeDef_t *scheduler, uint32_t count);
+void reset_pid_steal_scheduler_ranges(PIDStealSchedulerTypeDef_t *scheduler, const uint32_t *begin,
+                                      const uint32_t *end);
+uint8_t take_pid_steal_work(PIDStealSchedulerTypeDef_t *scheduler, uint32_t worker, uint32_t grain, uint32_t *begin,
+                            uint32_t *end);
+uint32_t get_pid_steal_count(const PIDStealSchedulerTypeDef_t *scheduler, uint32_t worker);
+
+int run_pid_parallel_for(uint32_t count, uint32_t threads, uint32_t grain, PIDParallelBody_t body, void *context);
+uint32_t get_pid_hardware_threads(void);
+
+#endif
@@ -0,0 +1,268 @@
+#include "pid_swap.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+typedef struct PIDProfileNodeTypeDef
+{
+    PIDGainProfileTypeDef_t profile;
+    uint64_t generation;
+    struct PIDProfileNodeTypeDef *nextRetired;
+} PIDProfileNodeTypeDef_t;
+
+/**
+ * @brief Written only by its reader, and only when the profile changed
+ */
+typedef struct
+{
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t acknowledged; // generation the reader has switched to
+    const PIDProfileNodeTypeDef_t *cached;
+} PIDProfileReaderTypeDef_t;
+
+struct PIDProfileSwapTypeDef
+{
+    // Read by every loop on every tick, written once per publication
+    _Alignas(PID_CACHE_LINE_SIZE) _Atomic(PIDProfileNodeTypeDef_t *) current;
+
+    // Tuner side
+    _Alignas(PID_CACHE_LINE_SIZE) pthread_mutex_t lock;
+    uint64_t generation;
+    PIDProfileNodeTypeDef_t *retired; // newest first
+    uint32_t retiredCount;
+
+    uint32_t readers;
+    PIDProfileReaderTypeDef_t *reader;
+};
+
+static PIDProfileNodeTypeDef_t *create_node(const PIDGainProfileTypeDef_t *profile, uint64_t generation)
+{
+    PIDProfileNodeTypeDef_t *node = malloc(sizeof(*node));
+    if (node != NULL)
+    {
+        node->profile = *profile;
+        node->generation = generation;
+        node->nextRetired = NULL;
+    }
+
+    return node;
+}
+
+/**
+ * @brief creates the swap with an initial profile that every reader starts on
+ *
+ * @param initial first profile, copied
+ * @param readers number of control loops that will call acquire_pid_profile, at least 1
+ * @return PIDProfileSwapTypeDef_t* NULL on failure
+ */
+PIDProfileSwapTypeDef_t *create_pid_profile_swap(const PIDGainProfileTypeDef_t *initial, uint32_t readers)
+{
+    if ((initial == NULL) || (readers == 0))
+    {
+        return NULL;
+    }
+
+    PIDProfileSwapTypeDef_t *swap = aligned_alloc(PID_CACHE_LINE_SIZE, sizeof(*swap));
+    if (swap == NULL)
+    {
+        return NULL;
+    }
+
+    swap->reader = aligned_alloc(PID_CACHE_LINE_SIZE, sizeof(PIDProfileReaderTypeDef_t) * readers);
+    PIDProfileNodeTypeDef_t *node = create_node(initial, 0);
+    if ((swap->reader == NULL) || (node == NULL) || (pthread_mutex_init(&swap->lock, NULL) != 0))
+    {
+        free(node);
+        free(swap->reader);
+        free(swap);
+        return NULL;
+    }
+
+    atomic_init(&swap->current, node);
+    swap->generation = 0;
+    swap->retired = NULL;
+    swap->retiredCount = 0;
+    swap->readers = readers;
+    for (uint32_t i = 0; i < readers; i++)
+    {
+        atomic_init(&swap->reader[i].acknowledged, 0);
+        swap->reader[i].cached = node;
+    }
+
+    return swap;
+}
+
+/**
+ * @brief frees the swap and every profile, no reader may use it any more
+ */
+void destroy_pid_profile_swap(PIDProfileSwapTypeDef_t *swap)
+{
+    if (swap == NULL)
+    {
+        return;
+    }
+
+    PIDProfileNodeTypeDef_t *node = swap->retired;
+    while (node != NULL)
+    {
+        PIDProfileNodeTypeDef_t *next = node->nextRetired;
+        free(node);
+        node = next;
+    }
+
+    free(atomic_load_explicit(&swap->current, memory_order_relaxed));
+    pthread_mutex_destroy(&swap->lock);
+    free(swap->reader);
+    free(swap);
+}
+
+/**
+ * @brief frees the retired profiles every reader has moved past. Must be called with the lock held.
+ */
+static uint32_t reclaim_locked(PIDProfileSwapTypeDef_t *swap)
+{
+    uint64_t oldest = UINT64_MAX;
+    for (uint32_t i = 0; i < swap->readers; i++)
+    {
+        uint64_t acknowledged = atomic_load_explicit(&swap->reader[i].acknowledged, memory_order_acquire);
+        oldest = (acknowledged < oldest) ? acknowledged : oldest;
+    }
+
+    // The list is newest first, everything after the first reclaimable node is older still
+    PIDProfileNodeTypeDef_t **link = &swap->retired;
+    while ((*link != NULL) && ((*link)->generation >= oldest))
+    {
+        link = &(*link)->nextRetired;
+    }
+
+    uint32_t freed = 0;
+    PIDProfileNodeTypeDef_t *node = *link;
+    *link = NULL;
+    while (node != NULL)
+    {
+        PIDProfileNodeTypeDef_t *next = node->nextRetired;
+        free(node);
+        node = next;
+        freed++;
+    }
+
+    swap->retiredCount -= freed;
+    return freed;
+}
+
+/**
+ * @brief publishes a copy of a profile to all readers and retires the previous one. Called from tuner threads, which
+ *        serialize on a lock the readers never take.
+ *
+ * @param swap profile swap
+ * @param profile new gains, limits and reference, copied
+ * @return int 0 on success, -1 on bad arguments or allocation failure
+ */
+int publish_pid_profile(PIDProfileSwapTypeDef_t *swap, const PIDGainProfileTypeDef_t *profile)
+{
+    if ((swap == NULL) || (profile == NULL))
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&swap->lock);
+
+    PIDProfileNodeTypeDef_t *node = create_node(profile, swap->generation + 1);
+    if (node == NULL)
+    {
+        pthread_mutex_unlock(&swap->lock);
+        return -1;
+    }
+
+    swap->generation++;
+    PIDProfileNodeTypeDef_t *previous = atomic_exchange_explicit(&swap->current, node, memory_order_acq_rel);
+    previous->nextRetired = swap->retired;
+    swap->retired = previous;
+    swap->retiredCount++;
+
+    reclaim_locked(swap);
+    pthread_mutex_unlock(&swap->lock);
+    return 0;
+}
+
+/**
+ * @brief profile to step with until the next call, to be called by a reader at every step boundary. One acquire
+ *        load; only when a new profile was published does the reader also acknowledge it with a release store. The
+ *        previously returned profile must not be used after this call.
+ *
+ * @param swap profile swap
+ * @param reader index of the calling control loop, each loop using its own
+ * @return const PIDGainProfileTypeDef_t* current profile
+ */
+const PIDGainProfileTypeDef_t *acquire_pid_profile(PIDProfileSwapTypeDef_t *swap, uint32_t reader)
+{
+    PIDProfileReaderTypeDef_t *slot = &swap->reader[reader];
+    const PIDProfileNodeTypeDef_t *node = atomic_load_explicit(&swap->current, memory_order_acquire);
+    if (node != slot->cached)
+    {
+        // Every use of older profiles happens before this store, and later loads of current cannot go back
+        slot->cached = node;
+        atomic_store_explicit(&slot->acknowledged, node->generation, memory_order_release);
+    }
+
+    return &node->profile;
+}
+
+/**
+ * @brief frees the retired profiles every reader has moved past. Publishing already does this; a tuner that stops
+ *        publishing can call it to release the last ones.
+ *
+ * @return uint32_t number of profiles freed
+ */
+uint32_t reclaim_pid_profiles(PIDProfileSwapTypeDef_t *swap)
+{
+    if (swap == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&swap->lock);
+    uint32_t freed = reclaim_locked(swap);
+    pthread_mutex_unlock(&swap->lock);
+    return freed;
+}
+
+/**
+ * @brief number of retired profiles still waiting for a reader to move past them
+ */
+uint32_t get_pid_profile_retired(PIDProfileSwapTypeDef_t *swap)
+{
+    if (swap == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&swap->lock);
+    uint32_t retired = swap->retiredCount;
+    pthread_mutex_unlock(&swap->lock);
+    return retired;
+}
+
+/**
+ * @brief loads a profile into a controller and performs calc_pid_output. The memories are kept, so a swap changes the
+ *        gains from this step on without a bump.
+ *
+ * @param pidObject representing a generic type which can be the voltage or the current stage
+ * @param profile profile from acquire_pid_profile
+ * @param currentOutput representing the current system output
+ * @return float
+ */
+float calc_pid_output_profile(PIDTypeDef_t *pidObject, const PIDGainProfileTypeDef_t *profile, float currentOutput)
+{
+    if ((pidObject == NULL) || (profile == NULL))
+    {
+        return 0;
+    }
+
+    pidObject->kI = profile->kI;
+    pidObject->KP = profile->KP;
+    pidObject->upperLimit = profile->upperLimit;
+    pidObject->lowerLimit = profile->lowerLimit;
+    pidObject->referencePoint = profile->referencePoint;
+    return calc_pid_output(pidObject, currentOutput);
+}
@@ -0,0 +1,23 @@
+#ifndef PID_SWAP_H
+#define PID_SWAP_H
+
+#include "pid_state.h"
+
+/**
+ * @brief Gain profile shared by running control loops and replaced as a whole. A tuner publishes a new immutable
+ *        profile with one atomic pointer swap; each control loop, a registered reader, picks it up with
+ *        acquire_pid_profile at its next step boundary. Retired profiles are freed once every reader has moved past
+ *        them, so a loop never sees a torn or freed gain set and never waits for the tuner.
+ */
+typedef struct PIDProfileSwapTypeDef PIDProfileSwapTypeDef_t;
+
+PIDProfileSwapTypeDef_t *create_pid_profile_swap(const PIDGainProfileTypeDef_t *initial, uint32_t readers);
+void destroy_pid_profile_swap(PIDProfileSwapTypeDef_t *swap);
+int publish_pid_profile(PIDProfileSwapTypeDef_t *swap, const PIDGainProfileTypeDef_t *profile);
+const PIDGainProfileTypeDef_t *acquire_pid_profile(PIDProfileSwapTypeDef_t *swap, uint32_t reader);
+uint32_t reclaim_pid_profiles(PIDProfileSwapTypeDef_t *swap);
+uint32_t get_pid_profile_retired(PIDProfileSwapTypeDef_t *swap);
+
+float calc_pid_output_profile(PIDTypeDef_t *pidObject, const PIDGainProfileTypeDef_t *profile, float currentOutput);
+
+#endif
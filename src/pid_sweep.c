@@ -0,0 +1,195 @@
+#include "pid_sweep.h"
+#include "pid_steal.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct
+{
+    const PIDSweepConfigTypeDef_t *config;
+    const PIDSweepCandidateTypeDef_t *candidates;
+    PIDSweepResultTypeDef_t *results;
+} PIDSweepJobTypeDef_t;
+
+static float grid_value(const PIDSweepRangeTypeDef_t *range, uint32_t point)
+{
+    if (range->points <= 1)
+    {
+        return range->min;
+    }
+
+    return range->min + ((range->max - range->min) * (float)point / (float)(range->points - 1));
+}
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief fills candidates with the cartesian product of the ranges, the first parameter varying fastest
+ *
+ * @param ranges array of PID_SWEEP_PARAMETERS ranges
+ * @param candidates array receiving the grid, may be NULL to only count
+ * @param capacity size of candidates
+ * @return uint32_t number of grid points, nothing is written if it exceeds capacity
+ */
+uint32_t build_pid_sweep_grid(const PIDSweepRangeTypeDef_t *ranges, PIDSweepCandidateTypeDef_t *candidates,
+                              uint32_t capacity)
+{
+    if (ranges == NULL)
+    {
+        return 0;
+    }
+
+    uint64_t count = 1;
+    for (uint32_t p = 0; p < PID_SWEEP_PARAMETERS; p++)
+    {
+        count *= (ranges[p].points > 1) ? ranges[p].points : 1;
+        if (count > UINT32_MAX)
+        {
+            return UINT32_MAX;
+        }
+    }
+
+    if ((candidates == NULL) || (count > capacity))
+    {
+        return (uint32_t)count;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t rest = i;
+        for (uint32_t p = 0; p < PID_SWEEP_PARAMETERS; p++)
+        {
+            uint32_t points = (ranges[p].points > 1) ? ranges[p].points : 1;
+            candidates[i].value[p] = grid_value(&ranges[p], rest % points);
+            rest /= points;
+        }
+    }
+
+    return (uint32_t)count;
+}
+
+/**
+ * @brief fills candidates with values drawn uniformly from each range. Candidate i only depends on seed and i, so a
+ *        sample can be extended or split without changing earlier candidates.
+ *
+ * @param ranges array of PID_SWEEP_PARAMETERS ranges, points is ignored
+ * @param seed random seed
+ * @param candidates array receiving the sample
+ * @param count number of candidates to draw
+ */
+void build_pid_sweep_random(const PIDSweepRangeTypeDef_t *ranges, uint64_t seed, PIDSweepCandidateTypeDef_t *candidates,
+                            uint32_t count)
+{
+    if ((ranges == NULL) || (candidates == NULL))
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t state = seed ^ ((uint64_t)i * 0xD1B54A32D192ED03ull);
+        for (uint32_t p = 0; p < PID_SWEEP_PARAMETERS; p++)
+        {
+            float unit = (float)(splitmix64(&state) >> 40) / (float)(1u << 24);
+            candidates[i].value[p] = ranges[p].min + ((ranges[p].max - ranges[p].min) * unit);
+        }
+    }
+}
+
+/**
+ * @brief copies the baseline cascade and overrides the swept gains and charge current
+ *
+ * @param baseline cascade providing everything that is not swept
+ * @param candidate swept values
+ * @param cascade cascade to fill
+ */
+void apply_pid_sweep_candidate(const PIDCascadeTypeDef_t *baseline, const PIDSweepCandidateTypeDef_t *candidate,
+                               PIDCascadeTypeDef_t *cascade)
+{
+    if ((baseline == NULL) || (candidate == NULL) || (cascade == NULL))
+    {
+        return;
+    }
+
+    *cascade = *baseline;
+    cascade->voltageStage.KP = candidate->value[PID_SWEEP_VOLTAGE_KP];
+    cascade->voltageStage.kI = candidate->value[PID_SWEEP_VOLTAGE_KI];
+    cascade->currentStage.KP = candidate->value[PID_SWEEP_CURRENT_KP];
+    cascade->currentStage.kI = candidate->value[PID_SWEEP_CURRENT_KI];
+    cascade->voltageStage.upperLimit = candidate->value[PID_SWEEP_CHARGE_CURRENT];
+}
+
+static void simulate_candidates(void *context, uint32_t begin, uint32_t end, uint32_t worker)
+{
+    (void)worker;
+    const PIDSweepJobTypeDef_t *job = context;
+    const PIDSweepConfigTypeDef_t *config = job->config;
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        PIDCascadeTypeDef_t cascade;
+        apply_pid_sweep_candidate(&config->baseline, &job->candidates[i], &cascade);
+
+        PIDPlantTypeDef_t plant;
+        init_pid_plant(&plant, &config->plant, config->initialStateOfCharge);
+
+        PIDSweepResultTypeDef_t *result = &job->results[i];
+        result->candidate = i;
+        run_pid_charge_cycle(&cascade, &plant, &config->limits, &result->charge);
+
+        const PIDChargeResultTypeDef_t *charge = &result->charge;
+        result->score = charge->terminated ? (charge->chargeTime + charge->settlingTime +
+                                              (config->overshootPenalty * charge->overshoot) +
+                                              (config->saturationPenalty * charge->saturationTime))
+                                           : INFINITY;
+    }
+}
+
+static int compare_results(const void *a, const void *b)
+{
+    const PIDSweepResultTypeDef_t *left = a;
+    const PIDSweepResultTypeDef_t *right = b;
+
+    if (left->score != right->score)
+    {
+        return (left->score < right->score) ? -1 : 1;
+    }
+
+    return (left->candidate < right->candidate) ? -1 : (left->candidate > right->candidate);
+}
+
+/**
+ * @brief simulates a closed-loop CC/CV charge for every candidate, spread over worker threads with work stealing,
+ *        and ranks the results best first. The ranking does not depend on the number of threads.
+ *
+ * @param config baseline cascade, plant, limits, score weights and thread count
+ * @param candidates array of count gain sets
+ * @param count number of candidates
+ * @param results array of count results, sorted by score on return
+ * @return int 0 on success, -1 on failure
+ */
+int run_pid_sweep(const PIDSweepConfigTypeDef_t *config, const PIDSweepCandidateTypeDef_t *candidates, uint32_t count,
+                  PIDSweepResultTypeDef_t *results)
+{
+    if ((config == NULL) || (candidates == NULL) || (results == NULL))
+    {
+        return -1;
+    }
+
+    PIDSweepJobTypeDef_t job = {config, candidates, results};
+
+    // One candidate at a time, a simulation is long enough to dwarf the cost of taking work
+    if (run_pid_parallel_for(count, config->threads, 1, simulate_candidates, &job) != 0)
+    {
+        return -1;
+    }
+
+    qsort(results, count, sizeof(*results), compare_results);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef PID_SWEEP_H
+#define PID_SWEEP_H
+
+#include "pid_plant.h"
+
+/**
+ * @brief Parameters a sweep can vary. The charge current is the upper limit of the voltage stage.
+ */
+typedef enum
+{
+    PID_SWEEP_VOLTAGE_KP = 0,
+    PID_SWEEP_VOLTAGE_KI,
+    PID_SWEEP_CURRENT_KP,
+    PID_SWEEP_CURRENT_KI,
+    PID_SWEEP_CHARGE_CURRENT,
+    PID_SWEEP_PARAMETERS,
+} PIDSweepParameter_t;
+
+/**
+ * @brief Range of one parameter. A grid samples points values evenly from min to max, a single point uses min.
+ */
+typedef struct
+{
+    float min;
+    float max;
+    uint32_t points;
+} PIDSweepRangeTypeDef_t;
+
+typedef struct
+{
+    float value[PID_SWEEP_PARAMETERS];
+} PIDSweepCandidateTypeDef_t;
+
+typedef struct
+{
+    PIDCascadeTypeDef_t baseline; // reference, limits and the memories every candidate starts from
+    PIDPlantConfigTypeDef_t plant;
+    float initialStateOfCharge;
+    PIDChargeLimitsTypeDef_t limits;
+    float overshootPenalty;  // score seconds per volt of overshoot
+    float saturationPenalty; // score seconds per second with the phase saturated
+    uint32_t threads;        // 0 for one per hardware thread
+} PIDSweepConfigTypeDef_t;
+
+typedef struct
+{
+    uint32_t candidate;
+    PIDChargeResultTypeDef_t charge;
+    float score; // lower is better, infinite if the charge did not terminate
+} PIDSweepResultTypeDef_t;
+
+uint32_t build_pid_sweep_grid(const PIDSweepRangeTypeDef_t *ranges, PIDSweepCandidateTypeDef_t *candidates,
+                              uint32_t capacity);
+void build_pid_sweep_random(const PIDSweepRangeTypeDef_t *ranges, uint64_t seed, PIDSweepCandidateTypeDef_t *candidates,
+                            uint32_t count);
+void apply_pid_sweep_candidate(const PIDCascadeTypeDef_t *baseline, const PIDSweepCandidateTypeDef_t *candidate,
+                               PIDCascadeTypeDef_t *cascade);
+int run_pid_sweep(const PIDSweepConfigTypeDef_t *config, const PIDSweepCandidateTypeDef_t *candidates, uint32_t count,
+                  PIDSweepResultTypeDef_t *results);
+
+#endif
@@ -0,0 +1,291 @@
+#include "pid_trace.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct PIDTraceRingTypeDef
+{
+    // Producer line: only the control loop writes here
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t head;
+    uint64_t cachedTail;
+    atomic_uint_fast64_t dropped;
+
+    // Consumer line
+    _Alignas(PID_CACHE_LINE_SIZE) atomic_uint_fast64_t tail;
+    uint64_t cachedHead;
+
+    // Read-only after creation, plus the consumer thread
+    _Alignas(PID_CACHE_LINE_SIZE) uint64_t capacity;
+    uint64_t mask;
+    PIDTraceRecordTypeDef_t *records;
+
+    pthread_t consumer;
+    atomic_int running;
+    uint8_t consumerStarted;
+    PIDTraceSink_t sink;
+    void *context;
+    PIDTraceRecordTypeDef_t *batch;
+    uint32_t batchSize;
+    uint32_t idleMicroseconds;
+};
+
+/**
+ * @brief allocates an empty ring
+ *
+ * @param capacity number of records, a power of two of at least 2
+ * @return PIDTraceRingTypeDef_t* NULL on failure or if capacity is not a power of two
+ */
+PIDTraceRingTypeDef_t *create_pid_trace_ring(uint32_t capacity)
+{
+    if ((capacity < 2) || ((capacity & (capacity - 1)) != 0))
+    {
+        return NULL;
+    }
+
+    PIDTraceRingTypeDef_t *ring = aligned_alloc(PID_CACHE_LINE_SIZE, sizeof(*ring));
+    if (ring == NULL)
+    {
+        return NULL;
+    }
+
+    size_t bytes = sizeof(PIDTraceRecordTypeDef_t) * capacity;
+    bytes = (bytes + PID_CACHE_LINE_SIZE - 1) & ~(size_t)(PID_CACHE_LINE_SIZE - 1);
+    ring->records = aligned_alloc(PID_CACHE_LINE_SIZE, bytes);
+    if (ring->records == NULL)
+    {
+        free(ring);
+        return NULL;
+    }
+
+    atomic_init(&ring->head, 0);
+    ring->cachedTail = 0;
+    atomic_init(&ring->dropped, 0);
+    atomic_init(&ring->tail, 0);
+    ring->cachedHead = 0;
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->running, 0);
+    ring->consumerStarted = 0;
+    ring->batch = NULL;
+
+    return ring;
+}
+
+/**
+ * @brief stops the consumer thread if one is running and frees the ring
+ */
+void destroy_pid_trace_ring(PIDTraceRingTypeDef_t *ring)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    stop_pid_trace_consumer(ring);
+    free(ring->records);
+    free(ring);
+}
+
+/**
+ * @brief pushes one record describing the step that just ran on pidObject. Must only be called from the producer
+ *        thread. Never blocks: the record is dropped and counted when the ring is full.
+ *
+ * @param ring ring to push to
+ * @param id identifies the controller, e.g. its index in a bank
+ * @param measurement measurement passed to the step
+ * @param pidObject controller after the step, provides the error and the integral memories
+ * @param output output returned by the step
+ * @return uint8_t 1 if the record was queued, 0 if it was dropped
+ */
+uint8_t push_pid_trace(PIDTraceRingTypeDef_t *ring, uint32_t id, float measurement, const PIDTypeDef_t *pidObject,
+                       float output)
+{
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+
+    // Only look at the consumer's line when the cached view says the ring is full
+    if ((head - ring->cachedTail) == ring->capacity)
+    {
+        ring->cachedTail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if ((head - ring->cachedTail) == ring->capacity)
+        {
+            atomic_store_explicit(&ring->dropped, dropped + 1, memory_order_relaxed);
+            return 0;
+        }
+    }
+
+    PIDTraceRecordTypeDef_t *record = &ring->records[head & ring->mask];
+    record->sequence = head + dropped;
+    record->id = id;
+    record->measurement = measurement;
+    record->error = pidObject->error;
+    record->previousError = pidObject->previousError;
+    record->previousOutput = pidObject->previousOutput;
+    record->output = output;
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * @brief copies up to maxRecords of the oldest records out of the ring. Must only be called from a single consumer
+ *        thread, and not while the consumer started by start_pid_trace_consumer is running.
+ *
+ * @return uint32_t number of records copied
+ */
+uint32_t pop_pid_trace_batch(PIDTraceRingTypeDef_t *ring, PIDTraceRecordTypeDef_t *records, uint32_t maxRecords)
+{
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if ((ring->cachedHead - tail) < maxRecords)
+    {
+        ring->cachedHead = atomic_load_explicit(&ring->head, memory_order_acquire);
+    }
+
+    uint64_t available = ring->cachedHead - tail;
+    uint32_t count = (available < maxRecords) ? (uint32_t)available : maxRecords;
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // At most two contiguous pieces, split where the ring wraps
+    uint64_t first = tail & ring->mask;
+    uint32_t firstCount = (uint32_t)(((ring->capacity - first) < count) ? (ring->capacity - first) : count);
+    memcpy(records, &ring->records[first], sizeof(*records) * firstCount);
+    memcpy(records + firstCount, ring->records, sizeof(*records) * (count - firstCount));
+
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+    return count;
+}
+
+/**
+ * @brief number of push_pid_trace calls so far, queued or dropped
+ */
+uint64_t get_pid_trace_pushed(const PIDTraceRingTypeDef_t *ring)
+{
+    PIDTraceRingTypeDef_t *mutableRing = (PIDTraceRingTypeDef_t *)ring;
+    return atomic_load_explicit(&mutableRing->head, memory_order_relaxed) +
+           atomic_load_explicit(&mutableRing->dropped, memory_order_relaxed);
+}
+
+/**
+ * @brief number of records dropped because the ring was full
+ */
+uint64_t get_pid_trace_dropped(const PIDTraceRingTypeDef_t *ring)
+{
+    return atomic_load_explicit(&((PIDTraceRingTypeDef_t *)ring)->dropped, memory_order_relaxed);
+}
+
+/**
+ * @brief calc_pid_output followed by a push of the step to ring. A NULL ring disables tracing.
+ *
+ * @param pidObject representing a generic type which can be the voltage or the current stage
+ * @param currentOutput representing the current system output
+ * @param ring ring to trace into, or NULL
+ * @param id identifies the controller in the trace
+ * @return float
+ */
+float calc_pid_output_traced(PIDTypeDef_t *pidObject, float currentOutput, PIDTraceRingTypeDef_t *ring, uint32_t id)
+{
+    float output = calc_pid_output(pidObject, currentOutput);
+    if (ring != NULL)
+    {
+        push_pid_trace(ring, id, currentOutput, pidObject, output);
+    }
+
+    return output;
+}
+
+static void *trace_consumer(void *argument)
+{
+    PIDTraceRingTypeDef_t *ring = argument;
+    PIDTraceRecordTypeDef_t *batch = ring->batch;
+
+    const struct timespec idle = {.tv_sec = ring->idleMicroseconds / 1000000,
+                                  .tv_nsec = (long)(ring->idleMicroseconds % 1000000) * 1000};
+    for (;;)
+    {
+        // Read the flag before draining so that the records pushed before the stop are always delivered
+        int running = atomic_load_explicit(&ring->running, memory_order_acquire);
+        uint32_t count = pop_pid_trace_batch(ring, batch, ring->batchSize);
+        if (count > 0)
+        {
+            ring->sink(ring->context, batch, count);
+            continue;
+        }
+
+        if (!running)
+        {
+            break;
+        }
+
+        nanosleep(&idle, NULL);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief starts a thread that drains the ring in batches and hands them to sink. The thread sleeps for
+ *        idleMicroseconds whenever the ring is empty, so the producer never has to wake it.
+ *
+ * @param ring ring to drain, at most one consumer per ring
+ * @param sink called from the consumer thread with every batch
+ * @param context passed to sink
+ * @param batchSize maximum number of records per sink call
+ * @param idleMicroseconds sleep between polls of an empty ring
+ * @return int 0 on success, -1 on bad arguments, if a consumer is already running, the batch buffer could not be
+ *         allocated or the thread could not start
+ */
+int start_pid_trace_consumer(PIDTraceRingTypeDef_t *ring, PIDTraceSink_t sink, void *context, uint32_t batchSize,
+                             uint32_t idleMicroseconds)
+{
+    if ((ring == NULL) || (sink == NULL) || (batchSize == 0) || ring->consumerStarted)
+    {
+        return -1;
+    }
+
+    // Allocated here rather than in the thread so that a failure is reported to the caller
+    ring->batch = malloc(sizeof(*ring->batch) * batchSize);
+    if (ring->batch == NULL)
+    {
+        return -1;
+    }
+
+    ring->sink = sink;
+    ring->context = context;
+    ring->batchSize = batchSize;
+    ring->idleMicroseconds = idleMicroseconds;
+    atomic_store_explicit(&ring->running, 1, memory_order_release);
+
+    if (pthread_create(&ring->consumer, NULL, trace_consumer, ring) != 0)
+    {
+        atomic_store_explicit(&ring->running, 0, memory_order_release);
+        free(ring->batch);
+        ring->batch = NULL;
+        return -1;
+    }
+
+    ring->consumerStarted = 1;
+    return 0;
+}
+
+/**
+ * @brief stops the consumer thread once it has delivered every record pushed before the call
+ */
+void stop_pid_trace_consumer(PIDTraceRingTypeDef_t *ring)
+{
+    if ((ring == NULL) || !ring->consumerStarted)
+    {
+        return;
+    }
+
+    atomic_store_explicit(&ring->running, 0, memory_order_release);
+    pthread_join(ring->consumer, NULL);
+    free(ring->batch);
+    ring->batch = NULL;
+    ring->consumerStarted = 0;
+}
@@ -0,0 +1,43 @@
+#ifndef PID_TRACE_H
+#define PID_TRACE_H
+
+#include "pid.h"
+
+/**
+ * @brief One traced controller step, 32 bytes so that two records share a cache line. The sequence is assigned by
+ *        the producer to every push, including dropped ones, so the consumer can see where records were lost.
+ */
+typedef struct
+{
+    uint64_t sequence;
+    uint32_t id;
+    float measurement;
+    float error;
+    float previousError;
+    float previousOutput;
+    float output;
+} PIDTraceRecordTypeDef_t;
+
+/**
+ * @brief Wait-free single-producer/single-consumer ring of trace records. The control loop pushes, a single consumer
+ *        pops; a full ring drops the record and counts it instead of blocking the producer.
+ */
+typedef struct PIDTraceRingTypeDef PIDTraceRingTypeDef_t;
+
+typedef void (*PIDTraceSink_t)(void *context, const PIDTraceRecordTypeDef_t *records, uint32_t count);
+
+PIDTraceRingTypeDef_t *create_pid_trace_ring(uint32_t capacity);
+void destroy_pid_trace_ring(PIDTraceRingTypeDef_t *ring);
+uint8_t push_pid_trace(PIDTraceRingTypeDef_t *ring, uint32_t id, float measurement, const PIDTypeDef_t *pidObject,
+                       float output);
+uint32_t pop_pid_trace_batch(PIDTraceRingTypeDef_t *ring, PIDTraceRecordTypeDef_t *records, uint32_t maxRecords);
+uint64_t get_pid_trace_pushed(const PIDTraceRingTypeDef_t *ring);
+uint64_t get_pid_trace_dropped(const PIDTraceRingTypeDef_t *ring);
+
+float calc_pid_output_traced(PIDTypeDef_t *pidObject, float currentOutput, PIDTraceRingTypeDef_t *ring, uint32_t id);
+
+int start_pid_trace_consumer(PIDTraceRingTypeDef_t *ring, PIDTraceSink_t sink, void *context, uint32_t batchSize,
+                             uint32_t idleMicroseconds);
+void stop_pid_trace_consumer(PIDTraceRingTypeDef_t *ring);
+
+#endif
@@ -0,0 +1,651 @@
+#include "pid_trace_file.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Columns are compressed with the XOR scheme of Gorilla (Pelkonen et al., VLDB 2015) adapted to 32-bit
+ *        floats. The first value of a block is stored as is, every following one as the XOR with its predecessor:
+ *        '0' for an unchanged value, '10' + bits when the changed bits fit in the window of the previous value,
+ *        '11' + 5 bits of leading zeros + 5 bits of length - 1 + bits otherwise. Slowly moving signals and saturated
+ *        outputs shrink to a few bits per step.
+ */
+
+// Worst case of a value: 2 control bits, 10 bits of window and 32 bits
+#define PID_TRACE_MAX_VALUE_BYTES 6
+
+_Static_assert(sizeof(PIDTraceFileHeaderTypeDef_t) == 56, "header layout is part of the file format");
+_Static_assert(sizeof(PIDTraceFileBlockTypeDef_t) == 48, "index layout is part of the file format");
+
+typedef struct
+{
+    uint8_t *bytes;
+    size_t size;
+    uint64_t accumulator;
+    uint32_t pending; // bits held in accumulator
+} PIDBitWriterTypeDef_t;
+
+typedef struct
+{
+    const uint8_t *bytes;
+    size_t size;
+    size_t position;
+    uint64_t accumulator;
+    uint32_t available;
+} PIDBitReaderTypeDef_t;
+
+struct PIDTraceWriterTypeDef
+{
+    FILE *file;
+    PIDTraceFileHeaderTypeDef_t header;
+    float *columns[PID_TRACE_COLUMNS]; // rows of the open block
+    uint32_t blockFill;
+    uint8_t *encoded;
+    PIDTraceFileBlockTypeDef_t *index;
+    uint32_t indexCapacity;
+    uint8_t failed;
+};
+
+struct PIDTraceReaderTypeDef
+{
+    FILE *file;
+    PIDTraceFileHeaderTypeDef_t header;
+    PIDTraceFileBlockTypeDef_t *index;
+    uint8_t *encoded;
+    float *columns[PID_TRACE_COLUMNS]; // decoded columns of the cached block
+    uint32_t cachedBlock;
+    uint32_t cachedColumns; // bit mask of the columns of cachedBlock that are decoded
+};
+
+static uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void write_bits(PIDBitWriterTypeDef_t *writer, uint32_t value, uint32_t bits)
+{
+    // bits is at most 32, the accumulator never holds more than 7 + 32
+    writer->accumulator = (writer->accumulator << bits) | (value & (uint32_t)((1ull << bits) - 1));
+    writer->pending += bits;
+    while (writer->pending >= 8)
+    {
+        writer->pending -= 8;
+        writer->bytes[writer->size++] = (uint8_t)(writer->accumulator >> writer->pending);
+    }
+}
+
+static void flush_bits(PIDBitWriterTypeDef_t *writer)
+{
+    if (writer->pending > 0)
+    {
+        writer->bytes[writer->size++] = (uint8_t)(writer->accumulator << (8 - writer->pending));
+        writer->pending = 0;
+    }
+}
+
+static uint32_t read_bits(PIDBitReaderTypeDef_t *reader, uint32_t bits)
+{
+    while (reader->available < bits)
+    {
+        // Reading past the end yields zeros, the row count bounds the decoder
+        uint8_t next = (reader->position < reader->size) ? reader->bytes[reader->position] : 0;
+        reader->position++;
+        reader->accumulator = (reader->accumulator << 8) | next;
+        reader->available += 8;
+    }
+
+    reader->available -= bits;
+    return (uint32_t)((reader->accumulator >> reader->available) & ((1ull << bits) - 1));
+}
+
+/**
+ * @brief compresses count values into bytes, which must hold count * PID_TRACE_MAX_VALUE_BYTES
+ *
+ * @return uint32_t number of bytes written
+ */
+static uint32_t encode_column(const float *values, uint32_t count, uint8_t *bytes)
+{
+    PIDBitWriterTypeDef_t writer = {bytes, 0, 0, 0};
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint32_t previous = float_bits(values[0]);
+    write_bits(&writer, previous, 32);
+
+    uint32_t leading = 33; // no window yet
+    uint32_t trailing = 0;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        uint32_t bits = float_bits(values[i]);
+        uint32_t difference = bits ^ previous;
+        previous = bits;
+
+        if (difference == 0)
+        {
+            write_bits(&writer, 0, 1);
+            continue;
+        }
+
+        uint32_t newLeading = (uint32_t)__builtin_clz(difference);
+        uint32_t newTrailing = (uint32_t)__builtin_ctz(difference);
+        if ((leading <= 32) && (newLeading >= leading) && (newTrailing >= trailing))
+        {
+            write_bits(&writer, 2, 2);
+            write_bits(&writer, difference >> trailing, 32 - leading - trailing);
+            continue;
+        }
+
+        // A difference is never 0, so at most 31 leading zeros and a length of 1 to 32 fit in 5 bits each
+        leading = newLeading;
+        trailing = newTrailing;
+        uint32_t length = 32 - leading - trailing;
+        write_bits(&writer, 3, 2);
+        write_bits(&writer, leading, 5);
+        write_bits(&writer, length - 1, 5);
+        write_bits(&writer, difference >> trailing, length);
+    }
+
+    flush_bits(&writer);
+    return (uint32_t)writer.size;
+}
+
+static void decode_column(const uint8_t *bytes, uint32_t size, uint32_t count, float *values)
+{
+    PIDBitReaderTypeDef_t reader = {bytes, size, 0, 0, 0};
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint32_t previous = read_bits(&reader, 32);
+    values[0] = bits_float(previous);
+
+    uint32_t leading = 0;
+    uint32_t trailing = 0;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        if (read_bits(&reader, 1) != 0)
+        {
+            if (read_bits(&reader, 1) != 0)
+            {
+                leading = read_bits(&reader, 5);
+                trailing = 32 - leading - (read_bits(&reader, 5) + 1);
+            }
+
+            previous ^= read_bits(&reader, 32 - leading - trailing) << trailing;
+        }
+
+        values[i] = bits_float(previous);
+    }
+}
+
+/**
+ * @brief fills a trace step from a controller that has just computed output from measurement
+ */
+void fill_pid_trace_step(const PIDTypeDef_t *pidObject, float measurement, float output, PIDTraceStepTypeDef_t *step)
+{
+    if ((pidObject == NULL) || (step == NULL))
+    {
+        return;
+    }
+
+    step->value[PID_TRACE_REFERENCE] = pidObject->referencePoint;
+    step->value[PID_TRACE_MEASUREMENT] = measurement;
+    step->value[PID_TRACE_ERROR] = pidObject->error;
+    step->value[PID_TRACE_PREVIOUS_ERROR] = pidObject->previousError;
+    step->value[PID_TRACE_PREVIOUS_OUTPUT] = pidObject->previousOutput;
+    step->value[PID_TRACE_OUTPUT] = output;
+}
+
+static void free_pid_trace_writer(PIDTraceWriterTypeDef_t *writer)
+{
+    for (uint32_t i = 0; i < PID_TRACE_COLUMNS; i++)
+    {
+        free(writer->columns[i]);
+    }
+
+    free(writer->encoded);
+    free(writer->index);
+    free(writer);
+}
+
+/**
+ * @brief creates or truncates a trace file and writes a provisional header
+ *
+ * @param path trace file
+ * @param pidObject controller whose gains and limits are recorded in the header, may be NULL
+ * @param blockRows rows per block, 0 for PID_TRACE_FILE_BLOCK_ROWS. Larger blocks compress slightly better, smaller
+ *        ones make random access cheaper.
+ * @return PIDTraceWriterTypeDef_t* NULL on failure
+ */
+PIDTraceWriterTypeDef_t *create_pid_trace_writer(const char *path, const PIDTypeDef_t *pidObject, uint32_t blockRows)
+{
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    if (blockRows == 0)
+    {
+        blockRows = PID_TRACE_FILE_BLOCK_ROWS;
+    }
+
+    PIDTraceWriterTypeDef_t *writer = calloc(1, sizeof(*writer));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+
+    uint8_t allocated = 1;
+    for (uint32_t i = 0; i < PID_TRACE_COLUMNS; i++)
+    {
+        writer->columns[i] = malloc(sizeof(float) * blockRows);
+        allocated = allocated && (writer->columns[i] != NULL);
+    }
+    writer->encoded = malloc((size_t)blockRows * PID_TRACE_MAX_VALUE_BYTES);
+    if (!allocated || (writer->encoded == NULL))
+    {
+        free_pid_trace_writer(writer);
+        return NULL;
+    }
+
+    writer->header.magic = PID_TRACE_FILE_MAGIC;
+    writer->header.version = PID_TRACE_FILE_VERSION;
+    writer->header.columns = PID_TRACE_COLUMNS;
+    writer->header.blockRows = blockRows;
+    if (pidObject != NULL)
+    {
+        writer->header.kI = pidObject->kI;
+        writer->header.KP = pidObject->KP;
+        writer->header.kD = pidObject->kD;
+        writer->header.upperLimit = pidObject->upperLimit;
+        writer->header.lowerLimit = pidObject->lowerLimit;
+    }
+
+    writer->file = fopen(path, "wb");
+    if ((writer->file == NULL) || (fwrite(&writer->header, sizeof(writer->header), 1, writer->file) != 1))
+    {
+        if (writer->file != NULL)
+        {
+            fclose(writer->file);
+        }
+        free_pid_trace_writer(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+static int flush_pid_trace_block(PIDTraceWriterTypeDef_t *writer)
+{
+    if (writer->blockFill == 0)
+    {
+        return 0;
+    }
+
+    if (writer->header.blocks == writer->indexCapacity)
+    {
+        uint32_t capacity = (writer->indexCapacity > 0) ? (writer->indexCapacity * 2) : 64;
+        PIDTraceFileBlockTypeDef_t *index = realloc(writer->index, sizeof(*index) * capacity);
+        if (index == NULL)
+        {
+            return -1;
+        }
+        writer->index = index;
+        writer->indexCapacity = capacity;
+    }
+
+    // Without a file position, e.g. on a pipe, the block cannot be indexed
+    long offset = ftell(writer->file);
+    if (offset < 0)
+    {
+        return -1;
+    }
+
+    PIDTraceFileBlockTypeDef_t *block = &writer->index[writer->header.blocks];
+    memset(block, 0, sizeof(*block));
+    block->firstRow = writer->header.rows;
+    block->offset = (uint64_t)offset;
+    block->rows = writer->blockFill;
+
+    for (uint32_t i = 0; i < PID_TRACE_COLUMNS; i++)
+    {
+        block->columnBytes[i] = encode_column(writer->columns[i], writer->blockFill, writer->encoded);
+        if (fwrite(writer->encoded, 1, block->columnBytes[i], writer->file) != block->columnBytes[i])
+        {
+            return -1;
+        }
+    }
+
+    writer->header.blocks++;
+    writer->header.rows += writer->blockFill;
+    writer->blockFill = 0;
+    return 0;
+}
+
+/**
+ * @brief appends one step, compressing and writing a block whenever blockRows steps have been collected
+ *
+ * @return int 0 on success, -1 on a write error, after which the writer only accepts close_pid_trace_writer
+ */
+int append_pid_trace_step(PIDTraceWriterTypeDef_t *writer, const PIDTraceStepTypeDef_t *step)
+{
+    if ((writer == NULL) || (step == NULL) || writer->failed)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < PID_TRACE_COLUMNS; i++)
+    {
+        writer->columns[i][writer->blockFill] = step->value[i];
+    }
+
+    if ((++writer->blockFill == writer->header.blockRows) && (flush_pid_trace_block(writer) != 0))
+    {
+        writer->failed = 1;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief writes the last partial block, the block index and the final header, then frees the writer
+ *
+ * @return int 0 if the complete file was written, -1 otherwise
+ */
+int close_pid_trace_writer(PIDTraceWriterTypeDef_t *writer)
+{
+    if (writer == NULL)
+    {
+        return -1;
+    }
+
+    int status = writer->failed ? -1 : flush_pid_trace_block(writer);
+    if (status == 0)
+    {
+        long indexOffset = ftell(writer->file);
+        writer->header.indexOffset = (uint64_t)indexOffset;
+        if ((indexOffset < 0) ||
+            (fwrite(writer->index, sizeof(*writer->index), writer->header.blocks, writer->file) !=
+             writer->header.blocks) ||
+            (fseek(writer->file, 0, SEEK_SET) != 0) ||
+            (fwrite(&writer->header, sizeof(writer->header), 1, writer->file) != 1))
+        {
+            status = -1;
+        }
+    }
+
+    if (fclose(writer->file) != 0)
+    {
+        status = -1;
+    }
+
+    free_pid_trace_writer(writer);
+    return status;
+}
+
+/**
+ * @brief whether the index covers rows 0 to header.rows exactly once, in order, with no block larger than the
+ *        decode buffers. The readers index the buffers with these numbers and trust nothing else.
+ */
+static uint8_t is_valid_index(const PIDTraceReaderTypeDef_t *reader)
+{
+    const PIDTraceFileHeaderTypeDef_t *header = &reader->header;
+    uint64_t nextRow = 0;
+    for (uint32_t i = 0; i < header->blocks; i++)
+    {
+        const PIDTraceFileBlockTypeDef_t *block = &reader->index[i];
+        if ((block->firstRow != nextRow) || (block->rows == 0) || (block->rows > header->blockRows))
+        {
+            return 0;
+        }
+        nextRow += block->rows;
+    }
+
+    return nextRow == header->rows;
+}
+
+/**
+ * @brief opens a trace file and loads its block index
+ *
+ * @return PIDTraceReaderTypeDef_t* NULL if the file cannot be read, is not a complete trace or its index does not
+ *         match its header
+ */
+PIDTraceReaderTypeDef_t *open_pid_trace_reader(const char *path)
+{
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    PIDTraceReaderTypeDef_t *reader = calloc(1, sizeof(*reader));
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL)
+    {
+        free(reader);
+        return NULL;
+    }
+
+    PIDTraceFileHeaderTypeDef_t *header = &reader->header;
+    if ((fread(header, sizeof(*header), 1, reader->file) != 1) || (header->magic != PID_TRACE_FILE_MAGIC) ||
+        (header->version != PID_TRACE_FILE_VERSION) || (header->columns != PID_TRACE_COLUMNS) ||
+        (header->blockRows == 0) || (header->indexOffset == 0))
+    {
+        close_pid_trace_reader(reader);
+        return NULL;
+    }
+
+    reader->cachedBlock = UINT32_MAX;
+    reader->index = malloc(sizeof(*reader->index) * ((header->blocks > 0) ? header->blocks : 1));
+    reader->encoded = malloc((size_t)header->blockRows * PID_TRACE_MAX_VALUE_BYTES);
+    uint8_t allocated = (reader->index != NULL) && (reader->encoded != NULL);
+    for (uint32_t i = 0; i < PID_TRACE_COLUMNS; i++)
+    {
+        reader->columns[i] = malloc(sizeof(float) * header->blockRows);
+        allocated = allocated && (reader->columns[i] != NULL);
+    }
+
+    if (!allocated || (fseek(reader->file, (long)header->indexOffset, SEEK_SET) != 0) ||
+        (fread(reader->index, sizeof(*reader->index), header->blocks, reader->file) != header->blocks) ||
+        !is_valid_index(reader))
+    {
+        close_pid_trace_reader(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+void close_pid_trace_reader(PIDTraceReaderTypeDef_t *reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+
+    if (reader->file != NULL)
+    {
+        fclose(reader->file);
+    }
+
+    for (uint32_t i = 0; i < PID_TRACE_COLUMNS; i++)
+    {
+        free(reader->columns[i]);
+    }
+
+    free(reader->index);
+    free(reader->encoded);
+    free(reader);
+}
+
+/**
+ * @brief header of an open trace, with the gains, the number of rows and the number of blocks
+ */
+const PIDTraceFileHeaderTypeDef_t *get_pid_trace_header(const PIDTraceReaderTypeDef_t *reader)
+{
+    return (reader != NULL) ? &reader->header : NULL;
+}
+
+static uint32_t find_block(const PIDTraceReaderTypeDef_t *reader, uint64_t row)
+{
+    uint32_t low = 0;
+    uint32_t high = reader->header.blocks;
+    while (high - low > 1)
+    {
+        uint32_t middle = low + ((high - low) / 2);
+        if (reader->index[middle].firstRow <= row)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief decodes one column of a block into the cache unless it is already there
+ */
+static int load_column(PIDTraceReaderTypeDef_t *reader, uint32_t blockIndex, uint32_t column)
+{
+    if (reader->cachedBlock != blockIndex)
+    {
+        reader->cachedBlock = blockIndex;
+        reader->cachedColumns = 0;
+    }
+
+    if (reader->cachedColumns & (1u << column))
+    {
+        return 0;
+    }
+
+    const PIDTraceFileBlockTypeDef_t *block = &reader->index[blockIndex];
+    uint64_t offset = block->offset;
+    for (uint32_t i = 0; i < column; i++)
+    {
+        offset += block->columnBytes[i];
+    }
+
+    uint32_t bytes = block->columnBytes[column];
+    if ((block->rows > reader->header.blockRows) ||
+        (bytes > (size_t)reader->header.blockRows * PID_TRACE_MAX_VALUE_BYTES) ||
+        (fseek(reader->file, (long)offset, SEEK_SET) != 0) ||
+        (fread(reader->encoded, 1, bytes, reader->file) != bytes))
+    {
+        return -1;
+    }
+
+    decode_column(reader->encoded, bytes, block->rows, reader->columns[column]);
+    reader->cachedColumns |= 1u << column;
+    return 0;
+}
+
+/**
+ * @brief reads one column of rows [firstRow, firstRow + count), decoding only that column of the blocks involved
+ *
+ * @param reader open trace
+ * @param column column to read
+ * @param firstRow first row to read
+ * @param count number of rows
+ * @param values receives up to count values
+ * @return uint64_t number of rows read, fewer than count at the end of the trace or on a read error
+ */
+uint64_t read_pid_trace_column(PIDTraceReaderTypeDef_t *reader, PIDTraceColumn_t column, uint64_t firstRow,
+                               uint64_t count, float *values)
+{
+    if ((reader == NULL) || (values == NULL) || ((uint32_t)column >= PID_TRACE_COLUMNS))
+    {
+        return 0;
+    }
+
+    uint64_t done = 0;
+    while ((done < count) && (firstRow + done < reader->header.rows))
+    {
+        uint64_t row = firstRow + done;
+        uint32_t blockIndex = find_block(reader, row);
+        if (load_column(reader, blockIndex, column) != 0)
+        {
+            break;
+        }
+
+        const PIDTraceFileBlockTypeDef_t *block = &reader->index[blockIndex];
+        uint64_t start = row - block->firstRow;
+        uint64_t take = block->rows - start;
+        if (take > count - done)
+        {
+            take = count - done;
+        }
+
+        memcpy(&values[done], &reader->columns[column][start], sizeof(float) * take);
+        done += take;
+    }
+
+    return done;
+}
+
+/**
+ * @brief reads complete steps of rows [firstRow, firstRow + count)
+ *
+ * @return uint64_t number of steps read, fewer than count at the end of the trace or on a read error
+ */
+uint64_t read_pid_trace_steps(PIDTraceReaderTypeDef_t *reader, uint64_t firstRow, uint64_t count,
+                              PIDTraceStepTypeDef_t *steps)
+{
+    if ((reader == NULL) || (steps == NULL))
+    {
+        return 0;
+    }
+
+    uint64_t done = 0;
+    while ((done < count) && (firstRow + done < reader->header.rows))
+    {
+        uint64_t row = firstRow + done;
+        uint32_t blockIndex = find_block(reader, row);
+        for (uint32_t column = 0; column < PID_TRACE_COLUMNS; column++)
+        {
+            if (load_column(reader, blockIndex, column) != 0)
+            {
+                return done;
+            }
+        }
+
+        const PIDTraceFileBlockTypeDef_t *block = &reader->index[blockIndex];
+        uint64_t start = row - block->firstRow;
+        uint64_t take = block->rows - start;
+        if (take > count - done)
+        {
+            take = count - done;
+        }
+
+        for (uint64_t i = 0; i < take; i++)
+        {
+            for (uint32_t column = 0; column < PID_TRACE_COLUMNS; column++)
+            {
+                steps[done + i].value[column] = reader->columns[column][start + i];
+            }
+        }
+        done += take;
+    }
+
+    return done;
+}
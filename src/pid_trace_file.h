@@ -0,0 +1,81 @@
+#ifndef PID_TRACE_FILE_H
+#define PID_TRACE_FILE_H
+
+#include "pid.h"
+
+#define PID_TRACE_FILE_MAGIC 0x43525450u // "PTRC" on a little endian host
+#define PID_TRACE_FILE_VERSION 1
+#define PID_TRACE_FILE_BLOCK_ROWS 4096
+
+/**
+ * @brief Columns of a traced controller step, in the order they are stored in a block
+ */
+typedef enum
+{
+    PID_TRACE_REFERENCE = 0,
+    PID_TRACE_MEASUREMENT,
+    PID_TRACE_ERROR,
+    PID_TRACE_PREVIOUS_ERROR,
+    PID_TRACE_PREVIOUS_OUTPUT,
+    PID_TRACE_OUTPUT,
+    PID_TRACE_COLUMNS
+} PIDTraceColumn_t;
+
+typedef struct
+{
+    float value[PID_TRACE_COLUMNS];
+} PIDTraceStepTypeDef_t;
+
+/**
+ * @brief File header. The gains and limits are those of the controller when the writer was created. The file is
+ *        this header, then the blocks, then one PIDTraceFileBlockTypeDef_t per block at indexOffset. The header and
+ *        the index are written as host structs, in the byte order of the writing host; a reader of the other byte
+ *        order sees a wrong magic and rejects the file. The compressed blocks are a byte stream and portable.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t columns;
+    uint32_t blockRows;
+    float kI;
+    float KP;
+    float kD;
+    float upperLimit;
+    float lowerLimit;
+    uint32_t blocks;
+    uint64_t rows;
+    uint64_t indexOffset;
+} PIDTraceFileHeaderTypeDef_t;
+
+/**
+ * @brief Index entry of a block. Each column is compressed on its own, columnBytes[i] bytes after column i - 1,
+ *        so a scan of one column reads and decodes only that column.
+ */
+typedef struct
+{
+    uint64_t firstRow;
+    uint64_t offset;
+    uint32_t rows;
+    uint32_t columnBytes[PID_TRACE_COLUMNS];
+    uint32_t reserved;
+} PIDTraceFileBlockTypeDef_t;
+
+typedef struct PIDTraceWriterTypeDef PIDTraceWriterTypeDef_t;
+typedef struct PIDTraceReaderTypeDef PIDTraceReaderTypeDef_t;
+
+void fill_pid_trace_step(const PIDTypeDef_t *pidObject, float measurement, float output, PIDTraceStepTypeDef_t *step);
+
+PIDTraceWriterTypeDef_t *create_pid_trace_writer(const char *path, const PIDTypeDef_t *pidObject, uint32_t blockRows);
+int append_pid_trace_step(PIDTraceWriterTypeDef_t *writer, const PIDTraceStepTypeDef_t *step);
+int close_pid_trace_writer(PIDTraceWriterTypeDef_t *writer);
+
+PIDTraceReaderTypeDef_t *open_pid_trace_reader(const char *path);
+void close_pid_trace_reader(PIDTraceReaderTypeDef_t *reader);
+const PIDTraceFileHeaderTypeDef_t *get_pid_trace_header(const PIDTraceReaderTypeDef_t *reader);
+uint64_t read_pid_trace_steps(PIDTraceReaderTypeDef_t *reader, uint64_t firstRow, uint64_t count,
+                              PIDTraceStepTypeDef_t *steps);
+uint64_t read_pid_trace_column(PIDTraceReaderTypeDef_t *reader, PIDTraceColumn_t column, uint64_t firstRow,
+                               uint64_t count, float *values);
+
+#endif
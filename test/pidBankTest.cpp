@@ -0,0 +1,189 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_bank.h"
+}
+
+/**
+ * @brief Controllers covering the proportional, integral, saturation and fault injection scenarios of pidTest.cpp
+ */
+static std::vector<PIDTypeDef_t> scenario_controllers()
+{
+    return {
+        {.kI = 0, .KP = 4, .upperLimit = 2000, .lowerLimit = -2000, .referencePoint = 50.4},
+        {.kI = 0.5, .KP = 0, .upperLimit = 2000, .lowerLimit = -2000, .referencePoint = 46.8},
+        {.kI = 0.5, .KP = 0, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 50.4},
+        {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0, .referencePoint = 3},
+        {.kI = 0.5, .KP = 0, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 0, .previousOutput = 3},
+        {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6, .previousError = 0.3,
+         .previousOutput = 3},
+        {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 50.4},
+    };
+}
+
+/**
+ * @brief The batch must produce bit-identical outputs and memories to calling calc_pid_output on each controller.
+ */
+TEST(CALC_PID_OUTPUT_BATCH, MATCHES_SCALAR)
+{
+    std::vector<PIDTypeDef_t> scalar = scenario_controllers();
+    const uint32_t count = scalar.size();
+    const float measurements[] = {50, 44.4, 50.3, 0, 0.1, 49.3, -3};
+
+    BankStorage storage(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        load_pid_bank_entry(&storage.bank, i, &scalar[i]);
+    }
+
+    std::vector<float> output(count);
+    for (uint8_t step = 0; step < 50; step++)
+    {
+        calc_pid_output_batch(&storage.bank, measurements, output.data());
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float expected = calc_pid_output(&scalar[i], measurements[i]);
+            EXPECT_EQ(expected, output[i]);
+            EXPECT_EQ(scalar[i].error, storage.error[i]);
+            EXPECT_EQ(scalar[i].previousError, storage.previousError[i]);
+            EXPECT_EQ(scalar[i].previousOutput, storage.previousOutput[i]);
+        }
+    }
+}
+
+/**
+ * @brief Runs SIMPLE_10_LOOP_TEST with the voltage and current stages as two single-controller banks
+ */
+TEST(CALC_PID_OUTPUT_BATCH, CASCADE_10_LOOP_TEST)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0, .referencePoint = 0};
+
+    BankStorage voltageBank(1);
+    BankStorage currentBank(1);
+    load_pid_bank_entry(&voltageBank.bank, 0, &voltageStage);
+    load_pid_bank_entry(&currentBank.bank, 0, &currentStage);
+
+    float operatingPoint = 39.6;
+    float currentReference = 0;
+    float phase = 0;
+    const float zero = 0;
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        float voltage = operatingPoint + (0.1 * i);
+        calc_pid_output_batch(&voltageBank.bank, &voltage, &currentReference);
+        currentBank.referencePoint[0] = currentReference;
+        calc_pid_output_batch(&currentBank.bank, &zero, &phase);
+    }
+
+    EXPECT_EQ(currentReference, 3);
+    EXPECT_EQ(phase, 42.75);
+}
+
+/**
+ * @brief Resetting a bank clears the integral memories of every controller and leaves the gains untouched
+ */
+TEST(CALC_PID_OUTPUT_BATCH, RESET_BANK_MEMORY)
+{
+    std::vector<PIDTypeDef_t> controllers = scenario_controllers();
+    const uint32_t count = controllers.size();
+    BankStorage storage(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        load_pid_bank_entry(&storage.bank, i, &controllers[i]);
+    }
+
+    std::vector<float> measurements(count, -3);
+    std::vector<float> output(count);
+    calc_pid_output_batch(&storage.bank, measurements.data(), output.data());
+    reset_pid_bank_memory(&storage.bank);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PIDTypeDef_t pidObject = {};
+        store_pid_bank_entry(&storage.bank, i, &pidObject);
+        EXPECT_EQ(pidObject.error, 0);
+        EXPECT_EQ(pidObject.previousError, 0);
+        EXPECT_EQ(pidObject.previousOutput, 0);
+        EXPECT_EQ(pidObject.kI, controllers[i].kI);
+        EXPECT_EQ(pidObject.KP, controllers[i].KP);
+    }
+}
+
+/**
+ * @brief With no deadband the quiescent batch matches calc_pid_output_batch bit for bit, while saturated
+ *        controllers with a constant measurement drop out of the active list and come back when it changes
+ */
+TEST(CALC_PID_OUTPUT_BATCH_QUIESCENT, MATCHES_BATCH_AND_COMPACTS)
+{
+    const uint32_t count = 1000;
+    BankStorage plain(count);
+    BankStorage quiet(count);
+    const PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        load_pid_bank_entry(&plain.bank, i, &voltageStage);
+        load_pid_bank_entry(&quiet.bank, i, &voltageStage);
+    }
+
+    std::vector<uint32_t> active(count);
+    std::vector<uint32_t> idle(count);
+    std::vector<float> cachedOutput(count);
+    PIDBankQuiescenceTypeDef_t quiescence = {active.data(), 0, idle.data(), 0, cachedOutput.data(), 0};
+    reset_pid_bank_quiescence(&quiescence, count);
+
+    // Bays 0 to 899 sit below the reference at a constant voltage, the others keep moving around it
+    std::vector<float> measurement(count);
+    std::vector<float> expected(count);
+    std::vector<float> output(count);
+    for (uint32_t step = 0; step < 60; step++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            measurement[i] = (i < 900) ? 45.0f : 49.6f + (0.01f * float((step + i) % 7)) - 0.03f;
+        }
+        if (step == 40)
+        {
+            // Bays 0 to 99 step above the reference
+            for (uint32_t i = 0; i < 100; i++)
+            {
+                measurement[i] = 52.0f;
+            }
+        }
+
+        calc_pid_output_batch(&plain.bank, measurement.data(), expected.data());
+        uint32_t stepped = calc_pid_output_batch_quiescent(&quiet.bank, &quiescence, measurement.data(), output.data());
+        ASSERT_EQ(quiescence.activeCount + quiescence.idleCount, count);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ASSERT_EQ(output[i], expected[i]) << "bay " << i << " step " << step;
+            ASSERT_EQ(quiet.previousOutput[i], plain.previousOutput[i]) << "bay " << i << " step " << step;
+            ASSERT_EQ(quiet.previousError[i], plain.previousError[i]) << "bay " << i << " step " << step;
+        }
+
+        if (step == 10)
+        {
+            EXPECT_EQ(stepped, 100u);
+        }
+        else if (step == 40)
+        {
+            EXPECT_EQ(stepped, 200u);
+        }
+    }
+
+    // The constant bays are all idle, whatever the moving ones happen to be doing on the last step
+    uint32_t constantIdle = 0;
+    for (uint32_t j = 0; j < quiescence.idleCount; j++)
+    {
+        constantIdle += (idle[j] < 900);
+    }
+    EXPECT_EQ(constantIdle, 900u);
+}
@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+extern "C"
+{
+#include "pid_cascade.h"
+}
+
+static_assert(sizeof(PIDCascadeTypeDef_t) == PID_CACHE_LINE_SIZE, "both stages must fit in one cache line");
+static_assert(alignof(PIDCascadeTypeDef_t) == PID_CACHE_LINE_SIZE, "a cascade must not straddle cache lines");
+
+/**
+ * @brief SIMPLE_10_LOOP_TEST without wiring the current stage reference by hand
+ */
+TEST(CALC_CASCADE, SIMPLE_10_LOOP_TEST)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0, .referencePoint = 0};
+
+    PIDCascadeTypeDef_t cascade;
+    load_cascade_stages(&cascade, &voltageStage, &currentStage);
+
+    float operatingPoint = 39.6;
+    float phase = 0;
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        phase = calc_cascade_output(&cascade, (operatingPoint + (0.1 * i)), 0);
+    }
+
+    EXPECT_EQ(cascade.currentStage.referencePoint, 3);
+    EXPECT_EQ(phase, 42.75);
+}
+
+/**
+ * @brief CC_CV_TRANSITION_TEST without wiring the current stage reference by hand
+ */
+TEST(CALC_CASCADE, CC_CV_TRANSITION_TEST)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6,
+                                 .previousError = 0.3, .previousOutput = 3};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0, .referencePoint = 0,
+                                 .previousError = 2.25, .previousOutput = 100};
+
+    PIDCascadeTypeDef_t cascade;
+    load_cascade_stages(&cascade, &voltageStage, &currentStage);
+
+    float operatingPoint = 49.3;
+    float phase = 0;
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        phase = calc_cascade_output(&cascade, operatingPoint, 3);
+
+        if (operatingPoint < 49.6)
+        {
+            operatingPoint += 0.1;
+        }
+    }
+
+    EXPECT_EQ(uint32_t(cascade.currentStage.referencePoint * 1000), 1775);
+    EXPECT_EQ(uint32_t(1000 * phase), 93269);
+}
+
+/**
+ * @brief The batched cascade must match stepping each stage with calc_pid_output
+ */
+TEST(CALC_CASCADE, BATCH_MATCHES_SCALAR)
+{
+    const uint32_t count = 5;
+    std::vector<PIDTypeDef_t> voltageStages(count);
+    std::vector<PIDTypeDef_t> currentStages(count);
+    std::vector<PIDCascadeTypeDef_t> cascades(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        voltageStages[i] = {.kI = 0.75f, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+        currentStages[i] = {.kI = 0.25f * (i + 1), .KP = 0.1f * i, .upperLimit = 100, .lowerLimit = 0};
+        load_cascade_stages(&cascades[i], &voltageStages[i], &currentStages[i]);
+    }
+
+    std::vector<float> voltage(count);
+    std::vector<float> current(count);
+    std::vector<float> phase(count);
+    for (uint8_t step = 0; step < 60; step++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            voltage[i] = 47 + (0.05f * step) + (0.3f * i);
+            current[i] = 0.02f * step;
+        }
+
+        calc_cascade_output_batch(cascades.data(), count, voltage.data(), current.data(), phase.data());
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            currentStages[i].referencePoint = calc_pid_output(&voltageStages[i], voltage[i]);
+            float expected = calc_pid_output(&currentStages[i], current[i]);
+            EXPECT_EQ(expected, phase[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PIDTypeDef_t voltageStage = {};
+        PIDTypeDef_t currentStage = {};
+        store_cascade_stages(&cascades[i], &voltageStage, &currentStage);
+        EXPECT_EQ(voltageStage.previousOutput, voltageStages[i].previousOutput);
+        EXPECT_EQ(currentStage.previousError, currentStages[i].previousError);
+        EXPECT_EQ(currentStage.referencePoint, currentStages[i].referencePoint);
+    }
+}
+
+/**
+ * @brief Resetting a cascade clears the memories of both stages
+ */
+TEST(CALC_CASCADE, RESET_CASCADE_MEMORY)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 50.4};
+    PIDTypeDef_t currentStage = {.kI = 0.5, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+
+    PIDCascadeTypeDef_t cascade;
+    load_cascade_stages(&cascade, &voltageStage, &currentStage);
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        calc_cascade_output(&cascade, -3, -3);
+    }
+
+    reset_cascade_memory(&cascade);
+    EXPECT_EQ(cascade.voltageStage.previousError, 0);
+    EXPECT_EQ(cascade.voltageStage.previousOutput, 0);
+    EXPECT_EQ(cascade.currentStage.previousError, 0);
+    EXPECT_EQ(cascade.currentStage.previousOutput, 0);
+    EXPECT_EQ(cascade.currentStage.referencePoint, 0);
+    EXPECT_EQ(cascade.voltageStage.referencePoint, 50.4f);
+}
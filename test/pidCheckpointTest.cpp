@@ -0,0 +1,178 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_checkpoint.h"
+}
+
+static void step(PIDBankTypeDef_t *bank, uint32_t firstTick, uint32_t ticks, std::vector<float> &output)
+{
+    std::vector<float> measurement(bank->count);
+    for (uint32_t tick = firstTick; tick < firstTick + ticks; tick++)
+    {
+        for (uint32_t channel = 0; channel < bank->count; channel++)
+        {
+            measurement[channel] = measurement_at(tick, channel);
+        }
+        calc_pid_output_batch(bank, measurement.data(), output.data());
+    }
+}
+
+TEST(PID_CHECKPOINT, BAD_FILES)
+{
+    PIDCheckpointTypeDef_t checkpoint;
+    EXPECT_EQ(create_pid_checkpoint(temp_path("pid_checkpoint_bad.bin").c_str(), 0, &checkpoint), -1);
+    EXPECT_EQ(open_pid_checkpoint(temp_path("pid_checkpoint_missing.bin").c_str(), &checkpoint), -1);
+
+    const std::string path = temp_path("pid_checkpoint_bad.bin");
+    ASSERT_EQ(create_pid_checkpoint(path.c_str(), 100, &checkpoint), 0);
+    EXPECT_EQ(checkpoint.header->columnStride, 448u);
+    close_pid_checkpoint(&checkpoint);
+
+    // Header tampered with: the count no longer matches the header checksum
+    FILE *file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    uint32_t count = 200;
+    fseek(file, offsetof(PIDCheckpointHeaderTypeDef_t, count), SEEK_SET);
+    fwrite(&count, sizeof(count), 1, file);
+    fclose(file);
+    EXPECT_EQ(open_pid_checkpoint(path.c_str(), &checkpoint), -1);
+
+    // Truncated
+    ASSERT_EQ(create_pid_checkpoint(path.c_str(), 100, &checkpoint), 0);
+    close_pid_checkpoint(&checkpoint);
+    ASSERT_EQ(truncate(path.c_str(), sizeof(PIDCheckpointHeaderTypeDef_t) + (7 * 448)), 0);
+    EXPECT_EQ(open_pid_checkpoint(path.c_str(), &checkpoint), -1);
+}
+
+/**
+ * @brief A bank closed and reopened carries on exactly as an uninterrupted one, without a bump
+ */
+TEST(PID_CHECKPOINT, WARM_RESTART_AFTER_CLOSE)
+{
+    const uint32_t count = 1000;
+    const std::string path = temp_path("pid_checkpoint_restart.bin");
+    PIDCheckpointTypeDef_t checkpoint;
+    ASSERT_EQ(create_pid_checkpoint(path.c_str(), count, &checkpoint), 0);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        load_pid_bank_entry(&checkpoint.bank, i, &VOLTAGE_STAGE);
+    }
+
+    BankStorage reference(count, VOLTAGE_STAGE);
+    std::vector<float> output(count);
+    std::vector<float> expected(count);
+    step(&checkpoint.bank, 0, 150, output);
+    step(&reference.bank, 0, 150, expected);
+    close_pid_checkpoint(&checkpoint);
+
+    ASSERT_EQ(open_pid_checkpoint(path.c_str(), &checkpoint), 0);
+    EXPECT_EQ(verify_pid_checkpoint(&checkpoint), PID_CHECKPOINT_CLEAN);
+    ASSERT_EQ(checkpoint.bank.count, count);
+    for (uint32_t tick = 150; tick < 200; tick++)
+    {
+        step(&checkpoint.bank, tick, 1, output);
+        step(&reference.bank, tick, 1, expected);
+        ASSERT_EQ(output, expected);
+    }
+    EXPECT_EQ(sync_pid_checkpoint(&checkpoint), 0);
+    const uint64_t columnStride = checkpoint.header->columnStride;
+    close_pid_checkpoint(&checkpoint);
+
+    // Modified behind the checkpoint's back while closed
+    FILE *file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    float previousOutput = 1.5f;
+    fseek(file, sizeof(PIDCheckpointHeaderTypeDef_t) + (7 * columnStride), SEEK_SET);
+    fwrite(&previousOutput, sizeof(previousOutput), 1, file);
+    fclose(file);
+    ASSERT_EQ(open_pid_checkpoint(path.c_str(), &checkpoint), 0);
+    EXPECT_EQ(verify_pid_checkpoint(&checkpoint), PID_CHECKPOINT_CORRUPT);
+    close_pid_checkpoint(&checkpoint);
+}
+
+/**
+ * @brief Only one attachment at a time; a refused create leaves the attached file untouched
+ */
+TEST(PID_CHECKPOINT, EXCLUSIVE_ATTACH)
+{
+    const uint32_t count = 4;
+    const std::string path = temp_path("pid_checkpoint_exclusive.bin");
+    PIDCheckpointTypeDef_t checkpoint;
+    ASSERT_EQ(create_pid_checkpoint(path.c_str(), count, &checkpoint), 0);
+    load_pid_bank_entry(&checkpoint.bank, 0, &VOLTAGE_STAGE);
+
+    PIDCheckpointTypeDef_t second;
+    EXPECT_EQ(open_pid_checkpoint(path.c_str(), &second), -1);
+    EXPECT_EQ(create_pid_checkpoint(path.c_str(), count, &second), -1);
+    EXPECT_EQ(checkpoint.bank.KP[0], VOLTAGE_STAGE.KP);
+    close_pid_checkpoint(&checkpoint);
+
+    ASSERT_EQ(open_pid_checkpoint(path.c_str(), &second), 0);
+    EXPECT_EQ(verify_pid_checkpoint(&second), PID_CHECKPOINT_CLEAN);
+    EXPECT_EQ(second.bank.KP[0], VOLTAGE_STAGE.KP);
+    close_pid_checkpoint(&second);
+    remove(path.c_str());
+}
+
+/**
+ * @brief A process killed without closing leaves an unclean checkpoint that still holds the memories of its last
+ *        tick, so the restarted process carries on without a bump
+ */
+TEST(PID_CHECKPOINT, WARM_RESTART_AFTER_CRASH)
+{
+    const uint32_t count = 64;
+    const std::string path = temp_path("pid_checkpoint_crash.bin");
+    PIDCheckpointTypeDef_t checkpoint;
+    ASSERT_EQ(create_pid_checkpoint(path.c_str(), count, &checkpoint), 0);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        load_pid_bank_entry(&checkpoint.bank, i, &VOLTAGE_STAGE);
+    }
+    close_pid_checkpoint(&checkpoint);
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        PIDCheckpointTypeDef_t crashing;
+        if (open_pid_checkpoint(path.c_str(), &crashing) != 0)
+        {
+            _exit(1);
+        }
+        std::vector<float> output(count);
+        step(&crashing.bank, 0, 120, output);
+        _exit(0);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+
+    ASSERT_EQ(open_pid_checkpoint(path.c_str(), &checkpoint), 0);
+    EXPECT_EQ(verify_pid_checkpoint(&checkpoint), PID_CHECKPOINT_UNCLEAN);
+
+    BankStorage reference(count, VOLTAGE_STAGE);
+    std::vector<float> output(count);
+    std::vector<float> expected(count);
+    step(&reference.bank, 0, 120, expected);
+    for (uint32_t tick = 120; tick < 140; tick++)
+    {
+        step(&checkpoint.bank, tick, 1, output);
+        step(&reference.bank, tick, 1, expected);
+        ASSERT_EQ(output, expected);
+    }
+
+    close_pid_checkpoint(&checkpoint);
+    ASSERT_EQ(open_pid_checkpoint(path.c_str(), &checkpoint), 0);
+    EXPECT_EQ(verify_pid_checkpoint(&checkpoint), PID_CHECKPOINT_CLEAN);
+    close_pid_checkpoint(&checkpoint);
+}
@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+
+#include "pid.hpp"
+
+/**
+ * @brief The full PI controller must match calc_pid_output step for step, including both saturations
+ */
+TEST(PID_CONTROLLER, PI_MATCHES_C)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6,
+                                 .previousError = 0.3, .previousOutput = 3};
+    pid::Controller<float> controller(voltageStage);
+
+    float operatingPoint = 45;
+    for (uint8_t i = 0; i < 80; i++)
+    {
+        float expected = calc_pid_output(&voltageStage, operatingPoint);
+        EXPECT_EQ(controller.step(operatingPoint), expected);
+        EXPECT_EQ(controller.previousError, voltageStage.previousError);
+        EXPECT_EQ(controller.previousOutput, voltageStage.previousOutput);
+        operatingPoint += 0.07f;
+    }
+}
+
+/**
+ * @brief SIMPLE_10_LOOP_TEST with an integral-only current stage, the KP = 0 multiply is compiled away
+ */
+TEST(PID_CONTROLLER, SIMPLE_10_LOOP_TEST)
+{
+    pid::Controller<float, pid::Mode::PI> voltageStage;
+    voltageStage.kI = 0.75;
+    voltageStage.KP = 4;
+    voltageStage.upperLimit = 3;
+    voltageStage.referencePoint = 49.6;
+
+    pid::Controller<float, pid::Mode::I> currentStage;
+    currentStage.kI = 0.75;
+    currentStage.upperLimit = 100;
+
+    float operatingPoint = 39.6;
+    float currentReference = 0;
+    float phase = 0;
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        currentReference = voltageStage.step(operatingPoint + (0.1 * i));
+        currentStage.referencePoint = currentReference;
+        phase = currentStage.step(0);
+    }
+
+    EXPECT_EQ(currentReference, 3);
+    EXPECT_EQ(phase, 42.75);
+}
+
+/**
+ * @brief A proportional-only controller behaves like calc_pid_output with kI = 0, as in PROPORTIONAL_NEGATIVE_TEST
+ */
+TEST(PID_CONTROLLER, PROPORTIONAL_ONLY)
+{
+    PIDTypeDef_t pidObject = {.kI = 0, .KP = 4, .upperLimit = 2000, .lowerLimit = -2000, .referencePoint = 50.4};
+    pid::Controller<float, pid::Mode::P> controller(pidObject);
+
+    EXPECT_EQ(controller.step(54), calc_pid_output(&pidObject, 54));
+    EXPECT_EQ(pidObject.previousOutput, 0);
+
+    // Storing leaves the integral fields it does not have untouched
+    pidObject.kI = 0.75;
+    controller.store(pidObject);
+    EXPECT_EQ(pidObject.kI, 0.75f);
+    EXPECT_EQ(pidObject.error, controller.error);
+}
+
+/**
+ * @brief A controller only carries the gains and memories of the terms its Mode compiles in
+ */
+TEST(PID_CONTROLLER, MODE_LAYOUT)
+{
+    // upperLimit, lowerLimit, error and referencePoint
+    constexpr std::size_t common = 4 * sizeof(float);
+
+    static_assert(sizeof(pid::Controller<float, pid::Mode::P>) == common + sizeof(float), "KP");
+    static_assert(sizeof(pid::Controller<float, pid::Mode::I>) == common + (3 * sizeof(float)),
+                  "kI and the integral memories");
+    static_assert(sizeof(pid::Controller<float, pid::Mode::PI>) == common + (4 * sizeof(float)), "KP and kI");
+    static_assert(sizeof(pid::Controller<float, pid::Mode::PID>) == common + (8 * sizeof(float)),
+                  "KP, kI and the derivative term");
+    static_assert(sizeof(pid::Controller<double, pid::Mode::P, pid::Saturation::None>) == 5 * sizeof(double), "KP");
+}
+
+/**
+ * @brief An integral-only controller matches calc_pid_output with KP = 0 even with inverted limits, where the
+ *        saturated integral is not within the limits
+ */
+TEST(PID_CONTROLLER, INTEGRAL_ONLY_INVERTED_LIMITS)
+{
+    PIDTypeDef_t pidObject = {.kI = 0.75, .KP = 0, .upperLimit = -1, .lowerLimit = 1, .referencePoint = 49.6};
+    pid::Controller<float, pid::Mode::I> controller(pidObject);
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        float measurement = 39.6 + (0.1 * i);
+        EXPECT_EQ(controller.step(measurement), calc_pid_output(&pidObject, measurement));
+    }
+}
+
+/**
+ * @brief Without saturation the integral keeps accumulating past the limits
+ */
+TEST(PID_CONTROLLER, NO_SATURATION)
+{
+    pid::Controller<double, pid::Mode::I, pid::Saturation::None> controller;
+    controller.kI = 0.75;
+    controller.upperLimit = 100;
+    controller.referencePoint = 3;
+
+    double ret = 0;
+    for (uint8_t i = 0; i < 30; i++)
+    {
+        ret = controller.step(0);
+    }
+
+    EXPECT_DOUBLE_EQ(ret, 2.25 + (29 * 4.5));
+
+    controller.reset();
+    EXPECT_EQ(controller.previousOutput, 0);
+    EXPECT_EQ(controller.previousError, 0);
+}
+
+/**
+ * @brief The controller can run at compile time
+ */
+TEST(PID_CONTROLLER, CONSTEXPR_STEP)
+{
+    constexpr float phase = [] {
+        pid::Controller<float, pid::Mode::I> currentStage;
+        currentStage.kI = 0.75;
+        currentStage.upperLimit = 100;
+        currentStage.referencePoint = 3;
+        float ret = 0;
+        for (int i = 0; i < 10; i++)
+        {
+            ret = currentStage.step(0);
+        }
+        return ret;
+    }();
+
+    static_assert(phase == 42.75f, "INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_PHASE_1 at compile time");
+    EXPECT_EQ(phase, 42.75f);
+}
+
+/**
+ * @brief The PID controller must match calc_pid_output_derivative step for step
+ */
+TEST(PID_CONTROLLER, PID_MATCHES_C)
+{
+    PIDTypeDef_t voltageStage = {
+        .kI = 0.75, .KP = 4, .kD = 6, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDDerivativeTypeDef_t derivative = {.filterCoefficient = 0.3};
+    reset_pid_derivative_memory(&derivative, 48);
+
+    pid::Controller<float, pid::Mode::PID> controller(voltageStage);
+    controller.filterCoefficient = 0.3;
+    controller.reset_derivative(48);
+
+    float operatingPoint = 48;
+    for (uint8_t i = 0; i < 80; i++)
+    {
+        float expected = calc_pid_output_derivative(&voltageStage, &derivative, operatingPoint);
+        EXPECT_EQ(controller.step(operatingPoint), expected);
+        EXPECT_EQ(controller.derivative, derivative.derivative);
+        operatingPoint += (i < 40) ? 0.05f : -0.03f;
+    }
+}
@@ -0,0 +1,161 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <complex>
+
+#include "pid_discrete.hpp"
+
+static constexpr PIDContinuousGainsTypeDef_t voltageGains = {.KP = 4, .kI = 1500, .kD = 0.002f,
+                                                             .filterTimeConstant = 0.004f};
+
+static constexpr auto tustinGains = pid::compile_gains<PID_DISCRETE_TUSTIN>(voltageGains, 0.001f);
+static constexpr auto eulerGains = pid::compile_gains<PID_DISCRETE_FORWARD_EULER>(voltageGains, 0.001f);
+
+// Folded at compile time
+static_assert(tustinGains.KP == 4, "proportional gain is per sample already");
+static_assert(tustinGains.kI == eulerGains.kI, "the integral is trapezoidal with every method");
+static_assert(eulerGains.filterCoefficient == 0.001f / 0.004f, "forward Euler filter");
+static_assert(pid::compile_gains<PID_DISCRETE_TUSTIN>({.kD = 1}, 0.001f).filterCoefficient == 1, "unfiltered");
+
+static void expect_gains_eq(const PIDDiscreteGainsTypeDef_t &actual, const PIDDiscreteGainsTypeDef_t &expected)
+{
+    EXPECT_EQ(actual.kI, expected.kI);
+    EXPECT_EQ(actual.KP, expected.KP);
+    EXPECT_EQ(actual.kD, expected.kD);
+    EXPECT_EQ(actual.filterCoefficient, expected.filterCoefficient);
+}
+
+TEST(COMPILE_PID_GAINS, MATCHES_CONSTEXPR)
+{
+    PIDDiscreteGainsTypeDef_t gains;
+    ASSERT_EQ(compile_pid_gains(&voltageGains, 0.001f, PID_DISCRETE_TUSTIN, &gains), 0);
+    expect_gains_eq(gains, tustinGains);
+    ASSERT_EQ(compile_pid_gains(&voltageGains, 0.001f, PID_DISCRETE_FORWARD_EULER, &gains), 0);
+    expect_gains_eq(gains, eulerGains);
+
+    EXPECT_FLOAT_EQ(tustinGains.kI, 0.75f);
+    EXPECT_FLOAT_EQ(tustinGains.kD, 2);
+    EXPECT_FLOAT_EQ(tustinGains.filterCoefficient, 0.002f / 0.009f);
+}
+
+TEST(COMPILE_PID_GAINS, REJECTS_BAD_ARGUMENTS)
+{
+    PIDDiscreteGainsTypeDef_t gains;
+    PIDContinuousGainsTypeDef_t negativeFilter = {.filterTimeConstant = -1};
+
+    EXPECT_EQ(compile_pid_gains(&voltageGains, 0, PID_DISCRETE_TUSTIN, &gains), -1);
+    EXPECT_EQ(compile_pid_gains(&voltageGains, NAN, PID_DISCRETE_TUSTIN, &gains), -1);
+    EXPECT_EQ(compile_pid_gains(&negativeFilter, 0.001f, PID_DISCRETE_TUSTIN, &gains), -1);
+    EXPECT_EQ(compile_pid_gains(&voltageGains, 0.001f, (PIDDiscretization_t)7, &gains), -1);
+    EXPECT_EQ(compile_pid_gains(NULL, 0.001f, PID_DISCRETE_TUSTIN, &gains), -1);
+
+    // Forward Euler is unstable once the sample period reaches twice the filter time constant, Tustin never is
+    EXPECT_EQ(compile_pid_gains(&voltageGains, 0.008f, PID_DISCRETE_FORWARD_EULER, &gains), -1);
+    EXPECT_EQ(compile_pid_gains(&voltageGains, 0.008f, PID_DISCRETE_TUSTIN, &gains), 0);
+    // In a constant expression this would not compile, at run time it gives zero coefficients
+    expect_gains_eq(pid::compile_gains<PID_DISCRETE_FORWARD_EULER>(voltageGains, 0.008f), {});
+}
+
+/**
+ * @brief The integral must ramp at kI per second and error whatever the loop rate
+ */
+TEST(COMPILE_PID_GAINS, INTEGRAL_INDEPENDENT_OF_RATE)
+{
+    const PIDContinuousGainsTypeDef_t integralOnly = {.kI = 2};
+    const float samplePeriods[] = {0.01f, 0.001f, 0.0001f};
+
+    for (float samplePeriod : samplePeriods)
+    {
+        PIDDiscreteGainsTypeDef_t gains;
+        ASSERT_EQ(compile_pid_gains(&integralOnly, samplePeriod, PID_DISCRETE_TUSTIN, &gains), 0);
+
+        PIDTypeDef_t voltageStage = {.upperLimit = 100, .lowerLimit = -100, .referencePoint = 50.4};
+        load_pid_discrete_gains(&voltageStage, NULL, &gains);
+
+        // 0.5 V of error for one second
+        float output = 0;
+        const uint32_t steps = (uint32_t)std::lround(1 / samplePeriod);
+        for (uint32_t i = 0; i < steps; i++)
+        {
+            output = calc_pid_output(&voltageStage, 49.9f);
+        }
+
+        // Trapezoid with a zero error before the first step: half a sample short of the full second
+        EXPECT_NEAR(output, 2 * 0.5f * (1 - (samplePeriod / 2)), 1e-3f);
+    }
+}
+
+/**
+ * @brief A measurement step through the filtered derivative follows kD / Tf * exp(-t / Tf) closely with Tustin
+ */
+TEST(COMPILE_PID_GAINS, DERIVATIVE_FOLLOWS_CONTINUOUS)
+{
+    constexpr PIDContinuousGainsTypeDef_t derivativeOnly = {.kD = 0.002f, .filterTimeConstant = 0.004f};
+    constexpr float samplePeriod = 0.0001f;
+    constexpr auto gains = pid::compile_gains<PID_DISCRETE_TUSTIN>(derivativeOnly, samplePeriod);
+
+    pid::Controller<float, pid::Mode::PID, pid::Saturation::None> controller;
+    pid::load_gains(controller, gains);
+
+    PIDTypeDef_t currentStage = {.upperLimit = 100, .lowerLimit = -100};
+    PIDDerivativeTypeDef_t derivative = {};
+    load_pid_discrete_gains(&currentStage, &derivative, &gains);
+
+    // Unit drop of the measurement at t = 0
+    for (uint32_t i = 1; i <= 200; i++)
+    {
+        float output = controller.step(-1);
+        EXPECT_EQ(calc_pid_output_derivative(&currentStage, &derivative, -1), output);
+
+        float t = (float)i * samplePeriod;
+        float continuous = (0.002f / 0.004f) * std::exp(-(t - (samplePeriod / 2)) / 0.004f);
+        EXPECT_NEAR(output, continuous, 0.01f);
+    }
+}
+
+/**
+ * @brief The Tustin coefficients are the full bilinear transform of kD * s / (1 + Tf * s), numerator included: the
+ *        step matches the difference equation obtained by substituting s = 2 / T * (1 - z^-1) / (1 + z^-1), and its
+ *        frequency response is the continuous one at the prewarped frequency 2 / T * tan(w * T / 2)
+ */
+TEST(COMPILE_PID_GAINS, TUSTIN_IS_BILINEAR)
+{
+    const double kD = 0.002;
+    const double filterTimeConstant = 0.004;
+    const double samplePeriod = 0.001;
+    const PIDContinuousGainsTypeDef_t derivativeOnly = {.kD = (float)kD,
+                                                        .filterTimeConstant = (float)filterTimeConstant};
+    PIDDiscreteGainsTypeDef_t gains;
+    ASSERT_EQ(compile_pid_gains(&derivativeOnly, (float)samplePeriod, PID_DISCRETE_TUSTIN, &gains), 0);
+
+    for (double w : {1.0, 100.0, 1000.0, 3000.0})
+    {
+        const std::complex<double> zInverse = std::exp(std::complex<double>(0, -w * samplePeriod));
+        const std::complex<double> discrete = ((double)gains.filterCoefficient * (double)gains.kD * (1.0 - zInverse)) /
+                                              (1.0 - ((1.0 - (double)gains.filterCoefficient) * zInverse));
+        const std::complex<double> s(0, (2 / samplePeriod) * std::tan(w * samplePeriod / 2));
+        const std::complex<double> continuous = (kD * s) / (1.0 + (filterTimeConstant * s));
+        EXPECT_LT(std::abs(discrete - continuous), 1e-5 * std::abs(continuous)) << "w " << w;
+    }
+
+    // (2 Tf + T) d[n] = (2 Tf - T) d[n-1] - 2 kD (y[n] - y[n-1]), the derivative being taken on the measurement
+    const double pole = ((2 * filterTimeConstant) - samplePeriod) / ((2 * filterTimeConstant) + samplePeriod);
+    const double gain = (2 * kD) / ((2 * filterTimeConstant) + samplePeriod);
+
+    PIDTypeDef_t currentStage = {.upperLimit = 100, .lowerLimit = -100};
+    PIDDerivativeTypeDef_t derivative = {};
+    load_pid_discrete_gains(&currentStage, &derivative, &gains);
+    reset_pid_derivative_memory(&derivative, 0);
+
+    double expected = 0;
+    double previousMeasurement = 0;
+    for (uint32_t i = 0; i < 400; i++)
+    {
+        double measurement = std::sin(0.05 * i) + ((i >= 200) ? 0.5 : 0);
+        expected = (pole * expected) - (gain * (measurement - previousMeasurement));
+        previousMeasurement = measurement;
+
+        float output = calc_pid_output_derivative(&currentStage, &derivative, (float)measurement);
+        ASSERT_NEAR(output, expected, 1e-5) << "step " << i;
+    }
+}
@@ -0,0 +1,221 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "pid_cascade.h"
+#include "pid_executor.h"
+}
+
+static const PIDExecutorConfigTypeDef_t MILLISECOND = {.basePeriodNs = 1000000, .cpu = -1, .priority = 0};
+
+struct Trace
+{
+    std::vector<std::pair<int, uint64_t>> calls;
+};
+
+static void record_voltage(void *context, uint64_t tick)
+{
+    static_cast<Trace *>(context)->calls.emplace_back(0, tick);
+}
+
+static void record_current(void *context, uint64_t tick)
+{
+    static_cast<Trace *>(context)->calls.emplace_back(1, tick);
+}
+
+TEST(PID_EXECUTOR, CREATE_AND_ADD_GROUPS)
+{
+    PIDExecutorConfigTypeDef_t zero = MILLISECOND;
+    zero.basePeriodNs = 0;
+    EXPECT_EQ(create_pid_executor(&zero), nullptr);
+    EXPECT_EQ(create_pid_executor(NULL), nullptr);
+
+    PIDExecutorTypeDef_t *executor = create_pid_executor(&MILLISECOND);
+    ASSERT_NE(executor, nullptr);
+
+    Trace trace;
+    EXPECT_EQ(add_pid_executor_group(executor, 0, 0, record_voltage, &trace), -1);
+    EXPECT_EQ(add_pid_executor_group(executor, 4, 4, record_voltage, &trace), -1);
+    EXPECT_EQ(add_pid_executor_group(executor, 4, 0, NULL, &trace), -1);
+    for (int i = 0; i < PID_EXECUTOR_MAX_GROUPS; i++)
+    {
+        EXPECT_EQ(add_pid_executor_group(executor, 1, 0, record_voltage, &trace), i);
+    }
+    EXPECT_EQ(add_pid_executor_group(executor, 1, 0, record_voltage, &trace), -1);
+
+    destroy_pid_executor(executor);
+}
+
+/**
+ * @brief A 20 kHz current group and a 1 kHz voltage group: the voltage group runs on every 20th tick at its phase,
+ *        before the current group of the same tick
+ */
+TEST(PID_EXECUTOR, GROUP_RATES)
+{
+    PIDExecutorConfigTypeDef_t config = {.basePeriodNs = 50000, .cpu = -1, .priority = 0};
+    PIDExecutorTypeDef_t *executor = create_pid_executor(&config);
+    ASSERT_NE(executor, nullptr);
+
+    Trace trace;
+    ASSERT_EQ(add_pid_executor_group(executor, 20, 3, record_voltage, &trace), 0);
+    ASSERT_EQ(add_pid_executor_group(executor, 1, 0, record_current, &trace), 1);
+
+    for (uint64_t tick = 0; tick < 2000; tick++)
+    {
+        run_pid_executor_tick(executor, tick);
+    }
+
+    EXPECT_EQ(get_pid_executor_group_runs(executor, 0), 100u);
+    EXPECT_EQ(get_pid_executor_group_runs(executor, 1), 2000u);
+    EXPECT_EQ(get_pid_executor_group_runs(executor, 2), 0u);
+    ASSERT_EQ(trace.calls.size(), 2100u);
+
+    size_t index = 0;
+    for (uint64_t tick = 0; tick < 2000; tick++)
+    {
+        if ((tick % 20) == 3)
+        {
+            ASSERT_EQ(trace.calls[index++], std::make_pair(0, tick));
+        }
+        ASSERT_EQ(trace.calls[index++], std::make_pair(1, tick));
+    }
+
+    destroy_pid_executor(executor);
+}
+
+/**
+ * @brief Running the two stages of a cascade separately gives the same result as calc_cascade_output
+ */
+TEST(PID_EXECUTOR, SPLIT_CASCADE_STAGES)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+    PIDCascadeTypeDef_t fused;
+    PIDCascadeTypeDef_t split;
+    load_cascade_stages(&fused, &voltageStage, &currentStage);
+    load_cascade_stages(&split, &voltageStage, &currentStage);
+
+    for (int i = 0; i < 50; i++)
+    {
+        float voltage = 45.0f + 0.1f * i;
+        float current = 0.05f * i;
+        float reference = calc_cascade_voltage_output(&split, voltage);
+        float phase = calc_cascade_current_output(&split, current);
+        ASSERT_EQ(calc_cascade_output(&fused, voltage, current), phase);
+        ASSERT_EQ(fused.currentStage.referencePoint, reference);
+    }
+
+    EXPECT_EQ(calc_cascade_voltage_output(NULL, 0), 0);
+    EXPECT_EQ(calc_cascade_current_output(NULL, 0), 0);
+}
+
+static void count_tick(void *context, uint64_t)
+{
+    (*static_cast<uint64_t *>(context))++;
+}
+
+TEST(PID_EXECUTOR, REAL_TIME_RUN)
+{
+    PIDExecutorTypeDef_t *executor = create_pid_executor(&MILLISECOND);
+    ASSERT_NE(executor, nullptr);
+
+    uint64_t fast = 0;
+    uint64_t slow = 0;
+    add_pid_executor_group(executor, 1, 0, count_tick, &fast);
+    add_pid_executor_group(executor, 10, 0, count_tick, &slow);
+
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(run_pid_executor(executor, 50), 0);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    PIDExecutorStatsTypeDef_t stats;
+    get_pid_executor_stats(executor, &stats);
+    EXPECT_EQ(stats.ticks, 50u);
+    EXPECT_EQ(fast + stats.skippedTicks, 50u);
+    EXPECT_LE(slow, 5u);
+    // The first tick is released immediately, the last one 49 periods later
+    EXPECT_GE(elapsed, std::chrono::milliseconds(49));
+
+    // Tick numbers continue across runs
+    ASSERT_EQ(run_pid_executor(executor, 10), 0);
+    get_pid_executor_stats(executor, &stats);
+    EXPECT_EQ(stats.ticks, 60u);
+
+    destroy_pid_executor(executor);
+}
+
+static void overrun_on_tick_5(void *context, uint64_t tick)
+{
+    (*static_cast<uint64_t *>(context))++;
+    if (tick == 5)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(3500));
+    }
+}
+
+/**
+ * @brief A tick that runs over several periods is counted and the deadlines it covered are skipped instead of being
+ *        run back to back
+ */
+TEST(PID_EXECUTOR, OVERRUN_SKIPS_TICKS)
+{
+    PIDExecutorTypeDef_t *executor = create_pid_executor(&MILLISECOND);
+    ASSERT_NE(executor, nullptr);
+
+    uint64_t runs = 0;
+    add_pid_executor_group(executor, 1, 0, overrun_on_tick_5, &runs);
+    ASSERT_EQ(run_pid_executor(executor, 20), 0);
+
+    PIDExecutorStatsTypeDef_t stats;
+    get_pid_executor_stats(executor, &stats);
+    EXPECT_EQ(stats.ticks, 20u);
+    EXPECT_GE(stats.overruns, 1u);
+    EXPECT_GE(stats.skippedTicks, 2u);
+    EXPECT_EQ(runs + stats.skippedTicks, 20u);
+    EXPECT_GE(stats.maxLatenessNs, 0u);
+
+    destroy_pid_executor(executor);
+}
+
+struct StopContext
+{
+    PIDExecutorTypeDef_t *executor;
+    uint64_t runs;
+};
+
+static void stop_on_tick_7(void *context, uint64_t tick)
+{
+    StopContext *stop = static_cast<StopContext *>(context);
+    stop->runs++;
+    // Tick 7 itself may have been skipped after an overrun
+    if (tick >= 7)
+    {
+        stop_pid_executor(stop->executor);
+    }
+}
+
+/**
+ * @brief Pinning and SCHED_FIFO are best effort, the executor runs whether or not they are granted, until stopped
+ */
+TEST(PID_EXECUTOR, STOP_AND_SCHEDULING_FALLBACK)
+{
+    PIDExecutorConfigTypeDef_t config = {.basePeriodNs = 200000, .cpu = 0, .priority = 10};
+    PIDExecutorTypeDef_t *executor = create_pid_executor(&config);
+    ASSERT_NE(executor, nullptr);
+
+    StopContext stop = {executor, 0};
+    add_pid_executor_group(executor, 1, 0, stop_on_tick_7, &stop);
+    ASSERT_EQ(run_pid_executor(executor, 0), 0);
+
+    PIDExecutorStatsTypeDef_t stats;
+    get_pid_executor_stats(executor, &stats);
+    EXPECT_GE(stats.ticks, 8u);
+    EXPECT_EQ(stop.runs + stats.skippedTicks, stats.ticks);
+    EXPECT_EQ(stats.pinned, 1);
+
+    destroy_pid_executor(executor);
+}
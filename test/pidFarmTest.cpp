@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_farm.h"
+}
+
+TEST(PID_FARM, CREATE_AND_CAPACITY)
+{
+    PIDFarmConfigTypeDef_t config = {.workers = 2, .capacity = 0, .pin = 0};
+    EXPECT_EQ(create_pid_farm(&config), nullptr);
+    EXPECT_EQ(create_pid_farm(NULL), nullptr);
+
+    config.capacity = 3;
+    PIDFarmTypeDef_t *farm = create_pid_farm(&config);
+    ASSERT_NE(farm, nullptr);
+
+    EXPECT_EQ(add_pid_farm_bay(farm, &VOLTAGE_STAGE), 0);
+    EXPECT_EQ(add_pid_farm_bay(farm, &VOLTAGE_STAGE), 1);
+    EXPECT_EQ(add_pid_farm_bay(farm, &VOLTAGE_STAGE), 2);
+    EXPECT_EQ(add_pid_farm_bay(farm, &VOLTAGE_STAGE), -1);
+    EXPECT_EQ(add_pid_farm_bay(farm, NULL), -1);
+
+    EXPECT_EQ(remove_pid_farm_bay(farm, 1), 0);
+    EXPECT_EQ(remove_pid_farm_bay(farm, 1), -1);
+    EXPECT_EQ(remove_pid_farm_bay(farm, 3), -1);
+    EXPECT_EQ(add_pid_farm_bay(farm, &VOLTAGE_STAGE), 1);
+
+    PIDFarmStatsTypeDef_t stats;
+    get_pid_farm_stats(farm, &stats);
+    EXPECT_EQ(stats.bays, 3u);
+    EXPECT_EQ(stats.workers, 2u);
+
+    destroy_pid_farm(farm);
+}
+
+/**
+ * @brief Every bay gives the same outputs as a controller stepped on its own, whatever the number of workers, also
+ *        after bays have been removed and added between ticks
+ */
+TEST(PID_FARM, MATCHES_SCALAR_STEPS)
+{
+    const uint32_t capacity = 1000;
+    const uint32_t workers[] = {1, 3, 8};
+
+    for (uint32_t workerCount : workers)
+    {
+        PIDFarmConfigTypeDef_t config = {.workers = workerCount, .capacity = capacity, .pin = 0};
+        PIDFarmTypeDef_t *farm = create_pid_farm(&config);
+        ASSERT_NE(farm, nullptr);
+
+        std::vector<PIDTypeDef_t> reference(capacity);
+        std::vector<bool> used(capacity, false);
+        for (uint32_t i = 0; i < capacity; i++)
+        {
+            reference[i] = VOLTAGE_STAGE;
+            reference[i].referencePoint += 0.001f * float(i);
+            ASSERT_EQ(add_pid_farm_bay(farm, &reference[i]), int(i));
+            used[i] = true;
+        }
+
+        std::vector<float> measurement(capacity);
+        std::vector<float> output(capacity);
+        for (uint32_t tick = 0; tick < 40; tick++)
+        {
+            if (tick == 20)
+            {
+                for (uint32_t bay = 0; bay < capacity; bay += 3)
+                {
+                    ASSERT_EQ(remove_pid_farm_bay(farm, bay), 0);
+                    used[bay] = false;
+                }
+            }
+            else if (tick == 30)
+            {
+                // Removed indices are handed out again
+                for (uint32_t i = 0; i < capacity / 6; i++)
+                {
+                    int bay = add_pid_farm_bay(farm, &VOLTAGE_STAGE);
+                    ASSERT_GE(bay, 0);
+                    ASSERT_EQ(bay % 3, 0);
+                    ASSERT_FALSE(used[bay]);
+                    reference[bay] = VOLTAGE_STAGE;
+                    used[bay] = true;
+                }
+            }
+
+            for (uint32_t bay = 0; bay < capacity; bay++)
+            {
+                measurement[bay] = measurement_at(tick, bay);
+                output[bay] = -1;
+            }
+
+            run_pid_farm_tick(farm, measurement.data(), output.data());
+
+            for (uint32_t bay = 0; bay < capacity; bay++)
+            {
+                if (used[bay])
+                {
+                    ASSERT_EQ(output[bay], calc_pid_output(&reference[bay], measurement[bay]))
+                        << "bay " << bay << " tick " << tick << " workers " << workerCount;
+                }
+                else
+                {
+                    ASSERT_EQ(output[bay], -1);
+                }
+            }
+        }
+
+        PIDTypeDef_t stored;
+        ASSERT_EQ(store_pid_farm_bay(farm, 1, &stored), 0);
+        EXPECT_EQ(stored.previousOutput, reference[1].previousOutput);
+        uint32_t unused = 0;
+        while (used[unused])
+        {
+            unused++;
+        }
+        EXPECT_EQ(store_pid_farm_bay(farm, unused, &stored), -1);
+
+        PIDFarmStatsTypeDef_t stats;
+        get_pid_farm_stats(farm, &stats);
+        EXPECT_EQ(stats.ticks, 40u);
+
+        destroy_pid_farm(farm);
+    }
+}
+
+/**
+ * @brief Shards stay within one bay of each other as bays come and go
+ */
+TEST(PID_FARM, SHARDS_STAY_BALANCED)
+{
+    PIDFarmConfigTypeDef_t config = {.workers = 4, .capacity = 64, .pin = 0};
+    PIDFarmTypeDef_t *farm = create_pid_farm(&config);
+    ASSERT_NE(farm, nullptr);
+
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        ASSERT_GE(add_pid_farm_bay(farm, &VOLTAGE_STAGE), 0);
+    }
+
+    // Emptying the bays in index order drains the shards unevenly without rebalancing
+    for (uint32_t bay = 0; bay < 60; bay++)
+    {
+        ASSERT_EQ(remove_pid_farm_bay(farm, bay), 0);
+
+        uint32_t smallest = UINT32_MAX;
+        uint32_t largest = 0;
+        uint32_t total = 0;
+        for (uint32_t worker = 0; worker < 4; worker++)
+        {
+            uint32_t size = get_pid_farm_shard_size(farm, worker);
+            smallest = std::min(smallest, size);
+            largest = std::max(largest, size);
+            total += size;
+        }
+        ASSERT_LE(largest - smallest, 1u);
+        ASSERT_EQ(total, 63u - bay);
+    }
+
+    PIDTypeDef_t changed = VOLTAGE_STAGE;
+    changed.KP = 7;
+    EXPECT_EQ(load_pid_farm_bay(farm, 62, &changed), 0);
+    EXPECT_EQ(load_pid_farm_bay(farm, 0, &changed), -1);
+    PIDTypeDef_t stored;
+    ASSERT_EQ(store_pid_farm_bay(farm, 62, &stored), 0);
+    EXPECT_EQ(stored.KP, 7);
+
+    destroy_pid_farm(farm);
+}
+
+/**
+ * @brief Pinning is best effort, the farm runs whether or not the affinity is granted
+ */
+TEST(PID_FARM, PINNED_WORKERS)
+{
+    PIDFarmConfigTypeDef_t config = {.workers = 0, .capacity = 256, .pin = 1};
+    PIDFarmTypeDef_t *farm = create_pid_farm(&config);
+    ASSERT_NE(farm, nullptr);
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        ASSERT_GE(add_pid_farm_bay(farm, &VOLTAGE_STAGE), 0);
+    }
+
+    std::vector<float> measurement(256, 45.0f);
+    std::vector<float> output(256);
+    for (uint32_t tick = 0; tick < 100; tick++)
+    {
+        run_pid_farm_tick(farm, measurement.data(), output.data());
+    }
+
+    PIDFarmStatsTypeDef_t stats;
+    get_pid_farm_stats(farm, &stats);
+    EXPECT_EQ(stats.ticks, 100u);
+    EXPECT_GE(stats.workers, 1u);
+    EXPECT_LE(stats.pinnedWorkers, stats.workers);
+
+    destroy_pid_farm(farm);
+}
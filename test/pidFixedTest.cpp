@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#define ANSI_COLOR_YELLOW "\x1b[33m"
+#define ANSI_COLOR_RESET "\x1b[0m"
+
+extern "C"
+{
+#include "pid_fixed.h"
+}
+
+/**
+ * @brief Saturating helpers clamp instead of wrapping
+ */
+TEST(PID_FIXED, SATURATING_ARITHMETIC)
+{
+    EXPECT_EQ(pid_fixed_add(INT32_MAX, 1), INT32_MAX);
+    EXPECT_EQ(pid_fixed_sub(INT32_MIN, 1), INT32_MIN);
+    EXPECT_EQ(pid_fixed_mul(INT32_MAX, INT32_MAX, PID_FIXED_Q16), INT32_MAX);
+    EXPECT_EQ(pid_fixed_mul(pid_float_to_fixed(1.5, PID_FIXED_Q16), pid_float_to_fixed(-2, PID_FIXED_Q16),
+                            PID_FIXED_Q16),
+              pid_float_to_fixed(-3, PID_FIXED_Q16));
+    EXPECT_EQ(pid_float_to_fixed(1e9, PID_FIXED_Q16), INT32_MAX);
+    EXPECT_EQ(pid_fixed_to_float(pid_float_to_fixed(49.6, PID_FIXED_Q24), PID_FIXED_Q24), 49.6f);
+}
+
+/**
+ * @brief NaN has no Q format value and converts to 0 instead of hitting an undefined conversion
+ */
+TEST(PID_FIXED, NAN_CONVERTS_TO_ZERO)
+{
+    EXPECT_EQ(pid_float_to_fixed(NAN, PID_FIXED_Q16), 0);
+    EXPECT_EQ(pid_float_to_fixed(-NAN, PID_FIXED_Q24), 0);
+    EXPECT_EQ(pid_float_to_fixed(INFINITY, PID_FIXED_Q16), INT32_MAX);
+    EXPECT_EQ(pid_float_to_fixed(-INFINITY, PID_FIXED_Q16), INT32_MIN);
+}
+
+/**
+ * @brief Saturation limits are exact in fixed point, as in INTEGRAL_POSITIVE_SATURATION
+ */
+TEST(PID_FIXED, INTEGRAL_POSITIVE_SATURATION)
+{
+    PIDTypeDef_t pidObject = {.kI = 0.5, .KP = 0, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 46.8};
+    PIDFixedTypeDef_t fixedObject;
+    load_pid_fixed(&fixedObject, &pidObject, PID_FIXED_Q16);
+
+    int32_t ret = calc_pid_fixed_output(&fixedObject, pid_float_to_fixed(30, PID_FIXED_Q16));
+    EXPECT_EQ(ret, pid_float_to_fixed(3, PID_FIXED_Q16));
+
+    reset_pid_fixed_memory(&fixedObject);
+    EXPECT_EQ(fixedObject.previousOutput, 0);
+    EXPECT_EQ(fixedObject.previousError, 0);
+}
+
+/**
+ * @brief One scenario of pidTest.cpp: a voltage stage driving a current stage, with measurements given per step
+ */
+struct Scenario
+{
+    const char *name;
+    PIDTypeDef_t voltageStage;
+    PIDTypeDef_t currentStage;
+    uint8_t steps;
+    std::function<float(uint8_t)> voltage;
+    std::function<float(uint8_t)> current;
+};
+
+/**
+ * @brief Runs a scenario through the float and the fixed-point path and returns the largest absolute difference of
+ *        the current reference and phase outputs over all steps
+ */
+static float max_deviation(const Scenario &scenario, uint8_t fractionalBits)
+{
+    PIDTypeDef_t voltageStage = scenario.voltageStage;
+    PIDTypeDef_t currentStage = scenario.currentStage;
+    PIDFixedTypeDef_t fixedVoltage;
+    PIDFixedTypeDef_t fixedCurrent;
+    load_pid_fixed(&fixedVoltage, &voltageStage, fractionalBits);
+    load_pid_fixed(&fixedCurrent, &currentStage, fractionalBits);
+
+    float deviation = 0;
+    for (uint8_t i = 0; i < scenario.steps; i++)
+    {
+        float voltage = scenario.voltage(i);
+        float current = scenario.current(i);
+
+        float currentReference = calc_pid_output(&voltageStage, voltage);
+        currentStage.referencePoint = currentReference;
+        float phase = calc_pid_output(&currentStage, current);
+
+        int32_t fixedReference = calc_pid_fixed_output(&fixedVoltage, pid_float_to_fixed(voltage, fractionalBits));
+        fixedCurrent.referencePoint = fixedReference;
+        int32_t fixedPhase = calc_pid_fixed_output(&fixedCurrent, pid_float_to_fixed(current, fractionalBits));
+
+        deviation = std::fmax(deviation,
+                              std::fabs(currentReference - pid_fixed_to_float(fixedReference, fractionalBits)));
+        deviation = std::fmax(deviation, std::fabs(phase - pid_fixed_to_float(fixedPhase, fractionalBits)));
+    }
+
+    return deviation;
+}
+
+/**
+ * @brief Differential test of the fixed-point path against the float path over the integration scenarios of
+ *        pidTest.cpp. The deviation is reported per scenario and Q format. Input quantization error accumulates
+ *        through two cascaded integrators, so the bound grows with the square of the number of steps.
+ */
+TEST(PID_FIXED, DIFFERENTIAL_AGAINST_FLOAT)
+{
+    const PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    const PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+    PIDTypeDef_t transitionVoltage = voltageStage;
+    transitionVoltage.previousError = 0.3;
+    transitionVoltage.previousOutput = 3;
+    PIDTypeDef_t transitionCurrent = currentStage;
+    transitionCurrent.previousError = 2.25;
+    transitionCurrent.previousOutput = 100;
+    PIDTypeDef_t integralOnly = {.kI = 0.5, .KP = 0, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 50.4};
+
+    const std::vector<Scenario> scenarios = {
+        {"SIMPLE_10_LOOP_TEST", voltageStage, currentStage, 10, [](uint8_t i) { return 39.6 + (0.1 * i); },
+         [](uint8_t) { return 0.0f; }},
+        {"SIMPLE_50_LOOP_TEST", voltageStage, currentStage, 50, [](uint8_t i) { return 39.6 + (0.1 * i); },
+         [](uint8_t) { return 0.0f; }},
+        {"CC_CV_TRANSITION_TEST", transitionVoltage, transitionCurrent, 10,
+         [](uint8_t i) { return std::fmin(49.3 + (0.1 * i), 49.6); }, [](uint8_t) { return 3.0f; }},
+        {"INTEGRAL_ACCUMULATION_SATURATION", integralOnly, currentStage, 50, [](uint8_t) { return 50.3f; },
+         [](uint8_t) { return 0.0f; }},
+        {"FAULT_NEGATIVE_VOLTAGE", voltageStage, currentStage, 10, [](uint8_t) { return -3.0f; },
+         [](uint8_t) { return -3.0f; }},
+    };
+
+    const uint8_t formats[] = {PID_FIXED_Q15, PID_FIXED_Q16};
+
+    printf(ANSI_COLOR_YELLOW "=====================================\r\n");
+    for (uint8_t q : formats)
+    {
+        for (const Scenario &scenario : scenarios)
+        {
+            float deviation = max_deviation(scenario, q);
+            printf("Q%u %-34s max deviation %g\r\n", q, scenario.name, deviation);
+
+            float lsb = 1.0f / float(1 << q);
+            EXPECT_LE(deviation, scenario.steps * scenario.steps * lsb) << scenario.name << " Q" << unsigned(q);
+        }
+    }
+    printf("=====================================\r\n" ANSI_COLOR_RESET);
+}
@@ -0,0 +1,279 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "pid.h"
+#include "pid_executor.h"
+#include "pid_farm.h"
+#include "pid_instr.h"
+}
+
+/**
+ * @brief Buckets are contiguous, every value lies in [floor, next floor) and a bucket spans at most 1/16th of its
+ *        floor
+ */
+TEST(PID_INSTR, BUCKET_LAYOUT)
+{
+    for (uint32_t bucket = 0; bucket < PID_HISTOGRAM_BUCKETS; bucket++)
+    {
+        uint64_t floor = get_pid_histogram_bucket_floor(bucket);
+        ASSERT_EQ(get_pid_histogram_bucket(floor), bucket);
+        if (bucket > 0)
+        {
+            ASSERT_EQ(get_pid_histogram_bucket(floor - 1), bucket - 1);
+        }
+        if ((bucket + 1 < PID_HISTOGRAM_BUCKETS) && (floor >= PID_HISTOGRAM_SUB_BUCKETS))
+        {
+            uint64_t width = get_pid_histogram_bucket_floor(bucket + 1) - floor;
+            ASSERT_LE(width * PID_HISTOGRAM_SUB_BUCKETS, floor);
+        }
+    }
+
+    EXPECT_EQ(get_pid_histogram_bucket(UINT64_MAX), PID_HISTOGRAM_BUCKETS - 1);
+}
+
+TEST(PID_INSTR, PERCENTILES)
+{
+    PIDHistogramTypeDef_t *histogram = create_pid_histogram();
+    ASSERT_NE(histogram, nullptr);
+    auto snapshot = std::make_unique<PIDHistogramSnapshotTypeDef_t>();
+
+    snapshot_pid_histogram(histogram, snapshot.get(), 0);
+    EXPECT_EQ(snapshot->count, 0u);
+    EXPECT_EQ(get_pid_histogram_percentile(snapshot.get(), 50), 0u);
+
+    for (uint64_t value = 1; value <= 10000; value++)
+    {
+        record_pid_histogram(histogram, value);
+    }
+
+    snapshot_pid_histogram(histogram, snapshot.get(), 1);
+    EXPECT_EQ(snapshot->count, 10000u);
+    EXPECT_EQ(snapshot->sum, 50005000u);
+    EXPECT_EQ(snapshot->min, 1u);
+    EXPECT_EQ(snapshot->max, 10000u);
+    EXPECT_NEAR((double)get_pid_histogram_percentile(snapshot.get(), 50), 5000, 5000 / 16.0);
+    EXPECT_NEAR((double)get_pid_histogram_percentile(snapshot.get(), 99), 9900, 9900 / 16.0);
+    EXPECT_EQ(get_pid_histogram_percentile(snapshot.get(), 100), get_pid_histogram_bucket_floor(
+                                                                     get_pid_histogram_bucket(10000)));
+    EXPECT_EQ(get_pid_histogram_percentile(snapshot.get(), 0), 1u);
+
+    // The reset emptied it
+    snapshot_pid_histogram(histogram, snapshot.get(), 0);
+    EXPECT_EQ(snapshot->count, 0u);
+    EXPECT_EQ(snapshot->min, UINT64_MAX);
+
+    destroy_pid_histogram(histogram);
+}
+
+/**
+ * @brief Values recorded while another thread snapshots and resets are counted exactly once
+ */
+TEST(PID_INSTR, CONCURRENT_SNAPSHOTS)
+{
+    PIDHistogramTypeDef_t *histogram = create_pid_histogram();
+    ASSERT_NE(histogram, nullptr);
+
+    const uint32_t writers = 4;
+    const uint64_t perWriter = 100000;
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writers; w++)
+    {
+        threads.emplace_back([histogram, w]() {
+            for (uint64_t i = 0; i < perWriter; i++)
+            {
+                record_pid_histogram(histogram, (i * (w + 1)) % 5000);
+            }
+        });
+    }
+
+    auto snapshot = std::make_unique<PIDHistogramSnapshotTypeDef_t>();
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        snapshot_pid_histogram(histogram, snapshot.get(), 1);
+        total += snapshot->count;
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    snapshot_pid_histogram(histogram, snapshot.get(), 1);
+    total += snapshot->count;
+    EXPECT_EQ(total, writers * perWriter);
+
+    destroy_pid_histogram(histogram);
+}
+
+/**
+ * @brief Saturations counted on different threads land on different shards and are summed by the snapshot
+ */
+TEST(PID_INSTR, CONCURRENT_SATURATIONS)
+{
+    reset_pid_instrumentation();
+
+    const uint32_t writers = 4;
+    const uint64_t perWriter = 100000;
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writers; w++)
+    {
+        threads.emplace_back([]() {
+            for (uint64_t i = 0; i < perWriter; i++)
+            {
+                record_pid_saturation((PIDSaturationBranch_t)(i % PID_SATURATION_BRANCHES));
+            }
+        });
+    }
+
+    auto snapshot = std::make_unique<PIDInstrumentationSnapshotTypeDef_t>();
+    uint64_t total[PID_SATURATION_BRANCHES] = {};
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        snapshot_pid_instrumentation(snapshot.get(), 1);
+        for (uint32_t branch = 0; branch < PID_SATURATION_BRANCHES; branch++)
+        {
+            total[branch] += snapshot->saturation[branch];
+        }
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    snapshot_pid_instrumentation(snapshot.get(), 1);
+    for (uint32_t branch = 0; branch < PID_SATURATION_BRANCHES; branch++)
+    {
+        total[branch] += snapshot->saturation[branch];
+    }
+    EXPECT_EQ(total[PID_SATURATION_NONE], writers * ((perWriter + 2) / 3));
+    EXPECT_EQ(total[PID_SATURATION_UPPER], writers * ((perWriter + 1) / 3));
+    EXPECT_EQ(total[PID_SATURATION_LOWER], writers * (perWriter / 3));
+}
+
+TEST(PID_INSTR, PERIOD_JITTER)
+{
+    reset_pid_instrumentation();
+
+    PIDPeriodTrackerTypeDef_t tracker;
+    init_pid_period_tracker(&tracker, 0.001);
+    EXPECT_NEAR((double)tracker.nominalPeriod, 0.001 * get_pid_instr_ticks_per_second(), 1);
+
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        record_pid_period(&tracker);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto snapshot = std::make_unique<PIDInstrumentationSnapshotTypeDef_t>();
+    snapshot_pid_instrumentation(snapshot.get(), 1);
+    EXPECT_EQ(snapshot->jitter.count, 5u);
+    EXPECT_GT(snapshot->ticksPerSecond, 0);
+}
+
+/**
+ * @brief With the hooks built in, every scalar step records its latency and each saturation branch is counted
+ */
+TEST(PID_INSTR, STEP_HOOKS)
+{
+    if (!is_pid_instrumentation_enabled())
+    {
+        GTEST_SKIP() << "built without PID_ENABLE_INSTRUMENTATION";
+    }
+
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    reset_pid_instrumentation();
+
+    // Far below the reference: integral and output saturate at the upper limit
+    calc_pid_output(&voltageStage, 40);
+    // Far above: both saturate at the lower limit
+    calc_pid_output(&voltageStage, 100);
+    // Just below the reference with empty memories: neither saturates
+    reset_pid_memory(&voltageStage);
+    calc_pid_output(&voltageStage, 49.5);
+
+    auto snapshot = std::make_unique<PIDInstrumentationSnapshotTypeDef_t>();
+    snapshot_pid_instrumentation(snapshot.get(), 1);
+    EXPECT_EQ(snapshot->stepLatency.count, 3u);
+    EXPECT_EQ(snapshot->saturation[PID_SATURATION_UPPER], 2u);
+    EXPECT_EQ(snapshot->saturation[PID_SATURATION_LOWER], 2u);
+    EXPECT_EQ(snapshot->saturation[PID_SATURATION_NONE], 2u);
+}
+
+static void count_run(void *context, uint64_t)
+{
+    (*static_cast<uint32_t *>(context))++;
+}
+
+/**
+ * @brief With the hooks built in, every timed run of an executor group after its first one records a period
+ */
+TEST(PID_INSTR, EXECUTOR_JITTER)
+{
+    if (!is_pid_instrumentation_enabled())
+    {
+        GTEST_SKIP() << "built without PID_ENABLE_INSTRUMENTATION";
+    }
+
+    PIDExecutorConfigTypeDef_t config = {.basePeriodNs = 1000000, .cpu = -1, .priority = 0};
+    PIDExecutorTypeDef_t *executor = create_pid_executor(&config);
+    ASSERT_NE(executor, nullptr);
+    uint32_t fast = 0;
+    uint32_t slow = 0;
+    ASSERT_EQ(add_pid_executor_group(executor, 1, 0, count_run, &fast), 0);
+    ASSERT_EQ(add_pid_executor_group(executor, 2, 1, count_run, &slow), 1);
+
+    // Simulated ticks are not timed
+    run_pid_executor_tick(executor, 0);
+    run_pid_executor_tick(executor, 1);
+    reset_pid_instrumentation();
+
+    ASSERT_EQ(run_pid_executor(executor, 10), 0);
+    auto snapshot = std::make_unique<PIDInstrumentationSnapshotTypeDef_t>();
+    snapshot_pid_instrumentation(snapshot.get(), 1);
+
+    // Ticks 0 and 1 ran the fast group twice and the slow one once; the first timed run of each group has no period
+    EXPECT_EQ(fast + slow, get_pid_executor_group_runs(executor, 0) + get_pid_executor_group_runs(executor, 1));
+    EXPECT_EQ(snapshot->jitter.count, (fast - 2 - 1) + (slow - 1 - 1));
+    destroy_pid_executor(executor);
+}
+
+/**
+ * @brief With the hooks built in, every worker of a farm with a nominal period records each tick after its first
+ */
+TEST(PID_INSTR, FARM_JITTER)
+{
+    if (!is_pid_instrumentation_enabled())
+    {
+        GTEST_SKIP() << "built without PID_ENABLE_INSTRUMENTATION";
+    }
+
+    PIDFarmConfigTypeDef_t config = {.workers = 2, .capacity = 8, .pin = 0, .periodNs = 1000000};
+    PIDFarmTypeDef_t *farm = create_pid_farm(&config);
+    ASSERT_NE(farm, nullptr);
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        ASSERT_GE(add_pid_farm_bay(farm, &voltageStage), 0);
+    }
+
+    std::vector<float> measurement(8, 49.5f);
+    std::vector<float> output(8);
+    reset_pid_instrumentation();
+    for (uint32_t tick = 0; tick < 5; tick++)
+    {
+        run_pid_farm_tick(farm, measurement.data(), output.data());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto snapshot = std::make_unique<PIDInstrumentationSnapshotTypeDef_t>();
+    snapshot_pid_instrumentation(snapshot.get(), 1);
+    EXPECT_EQ(snapshot->jitter.count, 2u * 4u);
+    destroy_pid_farm(farm);
+}
@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+
+#define ANSI_COLOR_YELLOW "\x1b[33m"
+#define ANSI_COLOR_RESET "\x1b[0m"
+
+extern "C"
+{
+#include "pid_plant.h"
+}
+
+/**
+ * @brief The open-circuit voltage follows the cell table scaled to 12 cells, clamped outside 0 to 1
+ */
+TEST(PID_PLANT, OPEN_CIRCUIT_VOLTAGE)
+{
+    PIDPlantConfigTypeDef_t config;
+    get_pid_plant_default_config(&config);
+    PIDPlantTypeDef_t plant;
+    init_pid_plant(&plant, &config, 0);
+
+    EXPECT_FLOAT_EQ(get_pid_plant_ocv(&plant, 0), 36);
+    EXPECT_FLOAT_EQ(get_pid_plant_ocv(&plant, 1), 50.4);
+    EXPECT_FLOAT_EQ(get_pid_plant_ocv(&plant, 0.95), 12 * 4.125);
+    EXPECT_FLOAT_EQ(get_pid_plant_ocv(&plant, -1), 36);
+    EXPECT_FLOAT_EQ(get_pid_plant_ocv(&plant, 2), 50.4);
+    EXPECT_FLOAT_EQ(plant.voltage, 36);
+}
+
+/**
+ * @brief At constant phase the charge grows linearly and the RC pair settles to I * R1
+ */
+TEST(PID_PLANT, CONSTANT_PHASE_RESPONSE)
+{
+    PIDPlantConfigTypeDef_t config;
+    get_pid_plant_default_config(&config);
+    PIDPlantTypeDef_t plant;
+    init_pid_plant(&plant, &config, 0.5);
+
+    const uint32_t steps = 600000;
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        step_pid_plant(&plant, 60);
+    }
+
+    float current = 60 * config.phaseGain;
+    EXPECT_FLOAT_EQ(plant.current, current);
+    EXPECT_NEAR(plant.stateOfCharge, 0.5 + (current * steps * config.samplePeriod / (3600 * config.capacityAh)), 1e-6);
+    EXPECT_NEAR(plant.polarizationVoltage, current * config.polarizationResistance, 1e-3);
+    EXPECT_FLOAT_EQ(plant.voltage, get_pid_plant_ocv(&plant, plant.stateOfCharge) +
+                                       (current * config.seriesResistance) + plant.polarizationVoltage);
+}
+
+/**
+ * @brief Full CC/CV charge with the gains of CC_CV_TRANSITION_TEST: constant current until the voltage reaches
+ *        49.6 V, then constant voltage until the current falls to C/20
+ */
+TEST(PID_PLANT, FULL_CHARGE_CYCLE)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+    PIDCascadeTypeDef_t cascade;
+    load_cascade_stages(&cascade, &voltageStage, &currentStage);
+
+    PIDPlantConfigTypeDef_t config;
+    get_pid_plant_default_config(&config);
+    PIDPlantTypeDef_t plant;
+    init_pid_plant(&plant, &config, 0.1);
+
+    PIDChargeLimitsTypeDef_t limits = {
+        .terminationCurrent = config.capacityAh / 20, .settlingBand = 0.01, .maxSteps = 10000000};
+    PIDChargeResultTypeDef_t result;
+
+    auto start = std::chrono::steady_clock::now();
+    run_pid_charge_cycle(&cascade, &plant, &limits, &result);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf(ANSI_COLOR_YELLOW "=====================================\r\n");
+    printf("charge %.0f s, CV from %.0f s, SoC %.3f, peak %.4f V, %.1f ms wall, %.1f Msteps/s\r\n",
+           result.chargeTime, result.constantVoltageStep * config.samplePeriod, result.finalStateOfCharge,
+           result.peakVoltage, ms, result.steps / ms / 1000);
+    printf("=====================================\r\n" ANSI_COLOR_RESET);
+
+    EXPECT_EQ(result.terminated, 1);
+    EXPECT_GT(result.constantVoltageStep, 0);
+    EXPECT_LT(result.constantVoltageStep, result.steps);
+    EXPECT_LT(result.peakVoltage, 49.6 + 0.01);
+    EXPECT_LT(result.overshoot, 0.01);
+    EXPECT_LT(result.settlingTime, result.chargeTime);
+    EXPECT_GT(result.finalStateOfCharge, 0.9);
+    EXPECT_LT(plant.current, limits.terminationCurrent);
+}
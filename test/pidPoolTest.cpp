@@ -0,0 +1,155 @@
+#include "gtest/gtest.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+extern "C"
+{
+#include "pid_pool.h"
+}
+
+static PIDTypeDef_t bay_controller(float referencePoint)
+{
+    return {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = referencePoint};
+}
+
+TEST(PID_POOL, BAD_ARGUMENTS)
+{
+    EXPECT_EQ(create_pid_pool(0), nullptr);
+
+    PIDPoolTypeDef_t *pool = create_pid_pool(2);
+    ASSERT_NE(pool, nullptr);
+    const PIDTypeDef_t controller = bay_controller(49.6);
+
+    EXPECT_FALSE(is_pid_pool_handle_valid(pool, add_pid_pool_controller(pool, NULL)));
+    EXPECT_TRUE(is_pid_pool_handle_valid(pool, add_pid_pool_controller(pool, &controller)));
+    EXPECT_TRUE(is_pid_pool_handle_valid(pool, add_pid_pool_controller(pool, &controller)));
+
+    // Full
+    PIDPoolHandleTypeDef_t full = add_pid_pool_controller(pool, &controller);
+    EXPECT_FALSE(is_pid_pool_handle_valid(pool, full));
+    EXPECT_EQ(get_pid_pool_controller(pool, full), nullptr);
+    EXPECT_EQ(remove_pid_pool_controller(pool, full), -1);
+    EXPECT_EQ(get_pid_pool_count(pool), 2u);
+
+    EXPECT_FALSE(is_pid_pool_handle_valid(pool, get_pid_pool_dense_handle(pool, 2)));
+    EXPECT_FALSE(is_pid_pool_handle_valid(pool, {7, 1}));
+    EXPECT_FALSE(is_pid_pool_handle_valid(pool, {0, 0}));
+
+    destroy_pid_pool(pool);
+}
+
+/**
+ * @brief A handle kept past the removal of its controller is rejected, even once the slot has been reused
+ */
+TEST(PID_POOL, STALE_HANDLES_ARE_DETECTED)
+{
+    PIDPoolTypeDef_t *pool = create_pid_pool(4);
+    ASSERT_NE(pool, nullptr);
+
+    const PIDTypeDef_t first = bay_controller(49.6);
+    const PIDTypeDef_t second = bay_controller(3);
+    PIDPoolHandleTypeDef_t removed = add_pid_pool_controller(pool, &first);
+    ASSERT_EQ(remove_pid_pool_controller(pool, removed), 0);
+    EXPECT_FALSE(is_pid_pool_handle_valid(pool, removed));
+    EXPECT_EQ(remove_pid_pool_controller(pool, removed), -1);
+
+    PIDPoolHandleTypeDef_t reused = add_pid_pool_controller(pool, &second);
+    EXPECT_EQ(reused.slot, removed.slot);
+    EXPECT_NE(reused.generation, removed.generation);
+    EXPECT_EQ(get_pid_pool_controller(pool, removed), nullptr);
+    EXPECT_EQ(get_pid_pool_dense_index(pool, removed), -1);
+    ASSERT_NE(get_pid_pool_controller(pool, reused), nullptr);
+    EXPECT_EQ(get_pid_pool_controller(pool, reused)->referencePoint, 3);
+
+    destroy_pid_pool(pool);
+}
+
+/**
+ * @brief Removal fills the gap with the last controller, keeping the live controllers at the front of the dense
+ *        array, and every surviving handle keeps reaching its own controller
+ */
+TEST(PID_POOL, REMOVAL_KEEPS_DENSE)
+{
+    PIDPoolTypeDef_t *pool = create_pid_pool(8);
+    ASSERT_NE(pool, nullptr);
+
+    std::vector<PIDPoolHandleTypeDef_t> handles;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        const PIDTypeDef_t controller = bay_controller((float)i);
+        handles.push_back(add_pid_pool_controller(pool, &controller));
+    }
+
+    ASSERT_EQ(remove_pid_pool_controller(pool, handles[1]), 0);
+    EXPECT_EQ(get_pid_pool_count(pool), 4u);
+
+    // The last controller moved into dense position 1
+    const PIDTypeDef_t *dense = get_pid_pool_dense(pool);
+    const float expected[] = {0, 4, 2, 3};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(dense[i].referencePoint, expected[i]);
+        PIDPoolHandleTypeDef_t handle = get_pid_pool_dense_handle(pool, i);
+        EXPECT_EQ(get_pid_pool_dense_index(pool, handle), (int)i);
+    }
+    EXPECT_EQ(get_pid_pool_dense_index(pool, handles[4]), 1);
+    EXPECT_EQ(get_pid_pool_controller(pool, handles[4])->referencePoint, 4);
+
+    // Removing the last dense controller moves nothing
+    ASSERT_EQ(remove_pid_pool_controller(pool, handles[3]), 0);
+    EXPECT_EQ(get_pid_pool_dense_index(pool, handles[2]), 2);
+
+    destroy_pid_pool(pool);
+}
+
+/**
+ * @brief Bays plugged in and removed at random, stepped every round through the dense array, must behave exactly
+ *        like controllers kept on their own
+ */
+TEST(PID_POOL, CHURN_MATCHES_INDIVIDUAL_CONTROLLERS)
+{
+    const uint32_t capacity = 64;
+    PIDPoolTypeDef_t *pool = create_pid_pool(capacity);
+    ASSERT_NE(pool, nullptr);
+
+    std::mt19937 random(42);
+    std::vector<std::pair<PIDPoolHandleTypeDef_t, PIDTypeDef_t>> bays;
+    std::vector<float> measurement(capacity);
+    std::vector<float> output(capacity);
+    for (uint32_t round = 0; round < 500; round++)
+    {
+        if ((bays.size() < capacity) && ((random() % 3) != 0))
+        {
+            const PIDTypeDef_t controller = bay_controller(45.0f + (float)(random() % 50) * 0.1f);
+            PIDPoolHandleTypeDef_t handle = add_pid_pool_controller(pool, &controller);
+            ASSERT_TRUE(is_pid_pool_handle_valid(pool, handle));
+            bays.push_back({handle, controller});
+        }
+        if (!bays.empty() && ((random() % 3) == 0))
+        {
+            size_t victim = random() % bays.size();
+            ASSERT_EQ(remove_pid_pool_controller(pool, bays[victim].first), 0);
+            bays.erase(bays.begin() + (long)victim);
+        }
+
+        ASSERT_EQ(get_pid_pool_count(pool), bays.size());
+        for (auto &bay : bays)
+        {
+            int dense = get_pid_pool_dense_index(pool, bay.first);
+            ASSERT_GE(dense, 0);
+            measurement[(uint32_t)dense] = 44.0f + (float)(random() % 100) * 0.1f;
+        }
+
+        calc_pid_pool_output(pool, measurement.data(), output.data());
+        for (auto &bay : bays)
+        {
+            uint32_t dense = (uint32_t)get_pid_pool_dense_index(pool, bay.first);
+            ASSERT_EQ(output[dense], calc_pid_output(&bay.second, measurement[dense]));
+            ASSERT_EQ(get_pid_pool_controller(pool, bay.first)->previousOutput, bay.second.previousOutput);
+        }
+    }
+
+    destroy_pid_pool(pool);
+}
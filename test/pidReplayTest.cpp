@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_replay.h"
+}
+
+/**
+ * @brief Writes a log of channels x samples measurements drifting around the voltage reference
+ */
+static void write_measurements(const std::string &path, uint32_t channels, uint64_t samples)
+{
+    PIDSampleLogTypeDef_t log;
+    ASSERT_EQ(create_pid_sample_log(path.c_str(), channels, samples, 1000, 500, &log), 0);
+    for (uint64_t row = 0; row < samples; row++)
+    {
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            log.samples[(row * channels) + channel] = measurement_at(row, channel);
+        }
+    }
+    close_pid_sample_log(&log);
+}
+
+TEST(PID_REPLAY, OPEN_AND_SEEK)
+{
+    const std::string path = temp_path("pid_replay_seek.log");
+    write_measurements(path, 3, 100);
+
+    PIDSampleLogTypeDef_t log;
+    ASSERT_EQ(open_pid_sample_log(path.c_str(), &log), 0);
+    EXPECT_EQ(log.header->channels, 3u);
+    EXPECT_EQ(log.header->samples, 100u);
+    EXPECT_EQ(log.samples[(7 * 3) + 2], 45.0f + 0.07f + 0.2f);
+
+    // Rows are 500 ns apart from t = 1000 ns
+    EXPECT_EQ(find_pid_sample_index(&log, 0), 0u);
+    EXPECT_EQ(find_pid_sample_index(&log, 1000), 0u);
+    EXPECT_EQ(find_pid_sample_index(&log, 1499), 0u);
+    EXPECT_EQ(find_pid_sample_index(&log, 1500), 1u);
+    EXPECT_EQ(find_pid_sample_index(&log, 1000 + (42 * 500)), 42u);
+    EXPECT_EQ(find_pid_sample_index(&log, 1000000), 100u);
+    close_pid_sample_log(&log);
+
+    EXPECT_EQ(open_pid_sample_log(temp_path("pid_replay_missing.log").c_str(), &log), -1);
+
+    // A log cut short of the rows its header announces is rejected
+    ASSERT_EQ(truncate(path.c_str(), sizeof(PIDSampleLogHeaderTypeDef_t) + (99 * 3 * sizeof(float))), 0);
+    EXPECT_EQ(open_pid_sample_log(path.c_str(), &log), -1);
+    remove(path.c_str());
+}
+
+/**
+ * @brief A shape whose size overflows is rejected before any file is created
+ */
+TEST(PID_REPLAY, CREATE_SIZE_OVERFLOW)
+{
+    const std::string path = temp_path("pid_replay_overflow.log");
+    PIDSampleLogTypeDef_t log;
+
+    // 2^62 rows of 4 channels would wrap to a header-only size
+    EXPECT_EQ(create_pid_sample_log(path.c_str(), 4, uint64_t(1) << 62, 1000, 500, &log), -1);
+    EXPECT_EQ(create_pid_sample_log(path.c_str(), UINT32_MAX, UINT64_MAX, 1000, 500, &log), -1);
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+}
+
+/**
+ * @brief Scalar and batched replays match stepping the controllers by hand, also when the log is replayed in two
+ *        pieces
+ */
+TEST(PID_REPLAY, SCALAR_AND_BATCH_MATCH)
+{
+    const uint32_t channels = 37;
+    const uint64_t samples = 2000;
+    const std::string inputPath = temp_path("pid_replay_input.log");
+    const std::string scalarPath = temp_path("pid_replay_scalar.log");
+    const std::string batchPath = temp_path("pid_replay_batch.log");
+    write_measurements(inputPath, channels, samples);
+
+    PIDSampleLogTypeDef_t input;
+    PIDSampleLogTypeDef_t scalar;
+    PIDSampleLogTypeDef_t batch;
+    ASSERT_EQ(open_pid_sample_log(inputPath.c_str(), &input), 0);
+    ASSERT_EQ(create_pid_sample_log(scalarPath.c_str(), channels, samples, 1000, 500, &scalar), 0);
+    ASSERT_EQ(create_pid_sample_log(batchPath.c_str(), channels, samples, 1000, 500, &batch), 0);
+
+    std::vector<PIDTypeDef_t> controllers(channels, VOLTAGE_STAGE);
+    std::vector<float> columns(8 * channels);
+    PIDBankTypeDef_t bank = {&columns[0],
+                             &columns[channels],
+                             &columns[2 * channels],
+                             &columns[3 * channels],
+                             &columns[4 * channels],
+                             &columns[5 * channels],
+                             &columns[6 * channels],
+                             &columns[7 * channels],
+                             channels};
+    for (uint32_t i = 0; i < channels; i++)
+    {
+        load_pid_bank_entry(&bank, i, &VOLTAGE_STAGE);
+    }
+
+    const uint64_t first = 100;
+    ASSERT_EQ(replay_pid_samples(controllers.data(), &input, &scalar, first, 700), 0);
+    ASSERT_EQ(replay_pid_samples(controllers.data(), &input, &scalar, first + 700, samples - first - 700), 0);
+    ASSERT_EQ(replay_pid_samples_batch(&bank, &input, &batch, first, samples - first), 0);
+
+    std::vector<PIDTypeDef_t> expected(channels, VOLTAGE_STAGE);
+    for (uint64_t row = 0; row < samples; row++)
+    {
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            uint64_t index = (row * channels) + channel;
+            if (row < first)
+            {
+                ASSERT_EQ(scalar.samples[index], 0);
+                ASSERT_EQ(batch.samples[index], 0);
+                continue;
+            }
+
+            float output = calc_pid_output(&expected[channel], input.samples[index]);
+            ASSERT_EQ(scalar.samples[index], output) << "row " << row << " channel " << channel;
+            ASSERT_EQ(batch.samples[index], output) << "row " << row << " channel " << channel;
+        }
+    }
+
+    // Ranges past the end of either log and mismatched banks are refused
+    EXPECT_EQ(replay_pid_samples(controllers.data(), &input, &scalar, samples - 1, 2), -1);
+    // A log opened for reading is mapped read-only and cannot take the results
+    EXPECT_EQ(replay_pid_samples(controllers.data(), &input, &input, 0, 1), -1);
+    EXPECT_EQ(replay_pid_samples_batch(&bank, &input, &input, 0, 1), -1);
+    bank.count = channels - 1;
+    EXPECT_EQ(replay_pid_samples_batch(&bank, &input, &batch, 0, 1), -1);
+
+    const float firstOutput = scalar.samples[first * channels];
+    const float lastOutput = scalar.samples[(samples * channels) - 1];
+    close_pid_sample_log(&input);
+    close_pid_sample_log(&scalar);
+    close_pid_sample_log(&batch);
+
+    // The results were written through the mapping and read back from the file
+    PIDSampleLogTypeDef_t reopened;
+    ASSERT_EQ(open_pid_sample_log(scalarPath.c_str(), &reopened), 0);
+    EXPECT_EQ(reopened.header->samples, samples);
+    EXPECT_EQ(reopened.samples[(samples * channels) - 1], lastOutput);
+    EXPECT_EQ(reopened.samples[first * channels], firstOutput);
+    EXPECT_GT(firstOutput, 0);
+    close_pid_sample_log(&reopened);
+
+    remove(inputPath.c_str());
+    remove(scalarPath.c_str());
+    remove(batchPath.c_str());
+}
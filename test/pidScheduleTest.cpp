@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "pid_schedule.hpp"
+
+/**
+ * @brief Voltage stage retuned over the pack voltage: softer and with less headroom near the 49.6 V reference
+ */
+static constexpr PIDScheduleBreakpointTypeDef_t voltageBreakpoints[] = {
+    {40, {.kI = 1.0, .KP = 6, .upperLimit = 3, .lowerLimit = 0}},
+    {48, {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0}},
+    {50, {.kI = 0.25, .KP = 1, .upperLimit = 2, .lowerLimit = 0}},
+    {56, {.kI = 0.5, .KP = 2, .upperLimit = 1, .lowerLimit = -1}},
+};
+
+static constexpr auto voltageSchedule = pid::make_schedule<33>(40.0f, 56.0f, voltageBreakpoints);
+
+// Grid points at 0.5 V, every breakpoint falls on one and is reproduced exactly
+static_assert(voltageSchedule.lookup(48).KP == 4, "breakpoint reproduced");
+static_assert(voltageSchedule.lookup(49).kI == 0.5f, "halfway between breakpoints");
+static_assert(voltageSchedule.lookup(-100).KP == 6, "clamped below");
+static_assert(voltageSchedule.lookup(100).lowerLimit == -1, "clamped above");
+
+static void expect_entry_eq(const PIDScheduleEntryTypeDef_t &actual, const PIDScheduleEntryTypeDef_t &expected)
+{
+    EXPECT_EQ(actual.kI, expected.kI);
+    EXPECT_EQ(actual.KP, expected.KP);
+    EXPECT_EQ(actual.upperLimit, expected.upperLimit);
+    EXPECT_EQ(actual.lowerLimit, expected.lowerLimit);
+}
+
+TEST(PID_SCHEDULE, BUILD_REJECTS_BAD_ARGUMENTS)
+{
+    PIDScheduleTableTypeDef_t table;
+    PIDScheduleEntryTypeDef_t entries[4];
+    const PIDScheduleBreakpointTypeDef_t unordered[] = {voltageBreakpoints[1], voltageBreakpoints[0]};
+
+    EXPECT_EQ(build_pid_schedule_table(&table, entries, 1, 40, 56, voltageBreakpoints, 4), -1);
+    EXPECT_EQ(build_pid_schedule_table(&table, entries, 4, 56, 40, voltageBreakpoints, 4), -1);
+    EXPECT_EQ(build_pid_schedule_table(&table, entries, 4, 40, 56, voltageBreakpoints, 0), -1);
+    EXPECT_EQ(build_pid_schedule_table(&table, entries, 4, 40, 56, unordered, 2), -1);
+    EXPECT_EQ(build_pid_schedule_table(NULL, entries, 4, 40, 56, voltageBreakpoints, 4), -1);
+    EXPECT_EQ(build_pid_schedule_table(&table, entries, 4, 40, 56, voltageBreakpoints, 4), 0);
+}
+
+/**
+ * @brief The table built at run time must equal the one built at compile time bit for bit, and so must lookups
+ */
+TEST(PID_SCHEDULE, RUNTIME_MATCHES_CONSTEXPR)
+{
+    PIDScheduleTableTypeDef_t table;
+    PIDScheduleEntryTypeDef_t entries[33];
+    ASSERT_EQ(build_pid_schedule_table(&table, entries, 33, 40, 56, voltageBreakpoints, 4), 0);
+
+    EXPECT_EQ(table.origin, voltageSchedule.origin);
+    EXPECT_EQ(table.inverseSpacing, voltageSchedule.inverseSpacing);
+    EXPECT_EQ(std::memcmp(entries, voltageSchedule.entries, sizeof(entries)), 0);
+
+    const PIDScheduleTableTypeDef_t view = voltageSchedule.view();
+    for (float operatingPoint = 38; operatingPoint < 58; operatingPoint += 0.037f)
+    {
+        PIDScheduleEntryTypeDef_t runtime, constant;
+        lookup_pid_schedule(&table, operatingPoint, &runtime);
+        lookup_pid_schedule(&view, operatingPoint, &constant);
+        expect_entry_eq(runtime, voltageSchedule.lookup(operatingPoint));
+        expect_entry_eq(constant, runtime);
+    }
+}
+
+/**
+ * @brief With the breakpoints on grid points the table interpolates exactly like the breakpoints do
+ */
+TEST(PID_SCHEDULE, LOOKUP_INTERPOLATES)
+{
+    const PIDScheduleTableTypeDef_t table = voltageSchedule.view();
+    PIDScheduleEntryTypeDef_t entry;
+
+    lookup_pid_schedule(&table, 44, &entry);
+    expect_entry_eq(entry, {.kI = 0.875, .KP = 5, .upperLimit = 3, .lowerLimit = 0});
+
+    lookup_pid_schedule(&table, 53, &entry);
+    expect_entry_eq(entry, {.kI = 0.375, .KP = 1.5, .upperLimit = 1.5, .lowerLimit = -0.5});
+
+    lookup_pid_schedule(&table, 56, &entry);
+    expect_entry_eq(entry, voltageBreakpoints[3].entry);
+
+    lookup_pid_schedule(&table, NAN, &entry);
+    expect_entry_eq(entry, voltageBreakpoints[0].entry);
+    lookup_pid_schedule(&table, INFINITY, &entry);
+    expect_entry_eq(entry, voltageBreakpoints[3].entry);
+}
+
+TEST(PID_SCHEDULE, APPLY_KEEPS_MEMORIES)
+{
+    PIDTypeDef_t voltageStage = {.kI = 9, .KP = 9, .upperLimit = 9, .lowerLimit = 9, .referencePoint = 49.6,
+                                 .previousError = 0.3, .previousOutput = 1.5};
+    const PIDScheduleTableTypeDef_t table = voltageSchedule.view();
+
+    apply_pid_schedule(&table, &voltageStage, 50);
+    EXPECT_EQ(voltageStage.kI, 0.25f);
+    EXPECT_EQ(voltageStage.KP, 1);
+    EXPECT_EQ(voltageStage.upperLimit, 2);
+    EXPECT_EQ(voltageStage.lowerLimit, 0);
+    EXPECT_EQ(voltageStage.referencePoint, 49.6f);
+    EXPECT_EQ(voltageStage.previousError, 0.3f);
+    EXPECT_EQ(voltageStage.previousOutput, 1.5f);
+
+    pid::Controller<float> controller(voltageStage);
+    voltageSchedule.apply(controller, 44);
+    EXPECT_EQ(controller.KP, 5);
+    EXPECT_EQ(controller.previousOutput, 1.5f);
+}
+
+/**
+ * @brief Scheduling every step must give the same outputs through the C controller, the template and a bank
+ */
+TEST(PID_SCHEDULE, BATCH_MATCHES_SCALAR)
+{
+    const uint32_t count = 5;
+    const PIDScheduleTableTypeDef_t table = voltageSchedule.view();
+    std::vector<PIDTypeDef_t> scalar(count, {.referencePoint = 49.6});
+    std::vector<pid::Controller<float>> controllers(count, pid::Controller<float>(scalar[0]));
+
+    std::vector<float> kI(count), KP(count), upperLimit(count), lowerLimit(count), error(count), referencePoint(count),
+        previousError(count), previousOutput(count);
+    PIDBankTypeDef_t bank = {kI.data(),    KP.data(),         upperLimit.data(),     lowerLimit.data(),
+                             error.data(), referencePoint.data(), previousError.data(), previousOutput.data(),
+                             count};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        load_pid_bank_entry(&bank, i, &scalar[i]);
+    }
+
+    std::vector<float> measurement = {38, 44.3, 49.1, 52.7, 60};
+    std::vector<float> output(count);
+    for (uint8_t step = 0; step < 60; step++)
+    {
+        apply_pid_schedule_batch(&table, &bank, measurement.data());
+        calc_pid_output_batch(&bank, measurement.data(), output.data());
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            apply_pid_schedule(&table, &scalar[i], measurement[i]);
+            voltageSchedule.apply(controllers[i], measurement[i]);
+            float expected = calc_pid_output(&scalar[i], measurement[i]);
+            EXPECT_EQ(output[i], expected);
+            EXPECT_EQ(controllers[i].step(measurement[i]), expected);
+
+            // Drift towards the reference through several segments
+            measurement[i] += (49.6f - measurement[i]) * 0.05f;
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_seqlock.h"
+}
+
+TEST(PID_SEQLOCK, BAD_ARGUMENTS)
+{
+    EXPECT_EQ(create_pid_seqlock(0), nullptr);
+
+    PIDSeqlockTypeDef_t *seqlock = create_pid_seqlock(2);
+    ASSERT_NE(seqlock, nullptr);
+
+    PIDSnapshotTypeDef_t snapshot;
+    EXPECT_EQ(read_pid_snapshot(seqlock, 2, &snapshot), -1);
+    EXPECT_EQ(read_pid_snapshot(seqlock, 0, NULL), -1);
+    EXPECT_EQ(read_pid_snapshot(NULL, 0, &snapshot), -1);
+
+    // Nothing published yet
+    ASSERT_EQ(read_pid_snapshot(seqlock, 1, &snapshot), 0);
+    EXPECT_EQ(snapshot.steps, 0u);
+    EXPECT_EQ(snapshot.pidObject.referencePoint, 0);
+
+    destroy_pid_seqlock(seqlock);
+}
+
+/**
+ * @brief Publishing does not change the output, and the snapshot holds the state right after the last step
+ */
+TEST(PID_SEQLOCK, SNAPSHOT_MATCHES_STEPS)
+{
+    PIDSeqlockTypeDef_t *seqlock = create_pid_seqlock(4);
+    ASSERT_NE(seqlock, nullptr);
+
+    PIDTypeDef_t published = VOLTAGE_STAGE;
+    PIDTypeDef_t plain = VOLTAGE_STAGE;
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        float measurement = 45.0f + 0.2f * i;
+        float output = calc_pid_output_published(&published, measurement, seqlock, 3);
+        ASSERT_EQ(output, calc_pid_output(&plain, measurement));
+
+        PIDSnapshotTypeDef_t snapshot;
+        ASSERT_EQ(read_pid_snapshot(seqlock, 3, &snapshot), 0);
+        EXPECT_EQ(snapshot.steps, i + 1);
+        EXPECT_EQ(snapshot.measurement, measurement);
+        EXPECT_EQ(snapshot.output, output);
+        EXPECT_EQ(snapshot.pidObject.referencePoint, plain.referencePoint);
+        EXPECT_EQ(snapshot.pidObject.error, plain.error);
+        EXPECT_EQ(snapshot.pidObject.previousError, plain.previousError);
+        EXPECT_EQ(snapshot.pidObject.previousOutput, plain.previousOutput);
+    }
+
+    PIDSnapshotTypeDef_t untouched;
+    ASSERT_EQ(read_pid_snapshot(seqlock, 2, &untouched), 0);
+    EXPECT_EQ(untouched.steps, 0u);
+
+    destroy_pid_seqlock(seqlock);
+}
+
+/**
+ * @brief Readers hammering a slot while it is republished must only ever see whole publications, in order. Every
+ *        field of publication n holds n, so a torn read shows up as differing fields.
+ */
+TEST(PID_SEQLOCK, CONCURRENT_READERS_SEE_CONSISTENT_SNAPSHOTS)
+{
+    const uint32_t publications = 200000;
+    const uint32_t readers = 4;
+    PIDSeqlockTypeDef_t *seqlock = create_pid_seqlock(1);
+    ASSERT_NE(seqlock, nullptr);
+
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> torn(0);
+    std::atomic<uint64_t> reordered(0);
+    std::atomic<uint64_t> reads(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t reader = 0; reader < readers; reader++)
+    {
+        threads.emplace_back([&]() {
+            uint64_t lastSteps = 0;
+            uint64_t localReads = 0;
+            do
+            {
+                PIDSnapshotTypeDef_t snapshot;
+                read_pid_snapshot(seqlock, 0, &snapshot);
+                localReads++;
+
+                const float expected = (float)snapshot.steps;
+                const PIDTypeDef_t &pid = snapshot.pidObject;
+                if ((pid.kI != expected) || (pid.KP != expected) || (pid.kD != expected) ||
+                    (pid.upperLimit != expected) || (pid.lowerLimit != expected) || (pid.error != expected) ||
+                    (pid.referencePoint != expected) || (pid.previousError != expected) ||
+                    (pid.previousOutput != expected) || (snapshot.measurement != expected) ||
+                    (snapshot.output != expected))
+                {
+                    torn++;
+                }
+                if (snapshot.steps < lastSteps)
+                {
+                    reordered++;
+                }
+                lastSteps = snapshot.steps;
+            } while (!done.load(std::memory_order_acquire));
+            reads += localReads;
+        });
+    }
+
+    for (uint32_t n = 1; n <= publications; n++)
+    {
+        const float value = (float)n;
+        const PIDTypeDef_t pidObject = {value, value, value, value, value, value, value, value, value};
+        publish_pid_snapshot(seqlock, 0, &pidObject, value, value);
+    }
+    done.store(true, std::memory_order_release);
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_EQ(reordered.load(), 0u);
+    EXPECT_GE(reads.load(), (uint64_t)readers);
+
+    PIDSnapshotTypeDef_t last;
+    ASSERT_EQ(read_pid_snapshot(seqlock, 0, &last), 0);
+    EXPECT_EQ(last.steps, publications);
+    EXPECT_EQ(last.output, (float)publications);
+
+    destroy_pid_seqlock(seqlock);
+}
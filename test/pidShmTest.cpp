@@ -0,0 +1,296 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_shm.h"
+}
+
+static std::string segment_name(const char *test)
+{
+    return "/pidShmTest-" + std::to_string(getpid()) + "-" + test;
+}
+
+TEST(PID_SHM, BAD_ARGUMENTS)
+{
+    PIDShmTypeDef_t shm;
+    const std::string name = segment_name("bad");
+    EXPECT_EQ(create_pid_shm(name.c_str(), 0, 16, &shm), -1);
+    EXPECT_EQ(create_pid_shm(name.c_str(), 4, 12, &shm), -1);
+    EXPECT_EQ(create_pid_shm(name.c_str(), 4, 1, &shm), -1);
+    EXPECT_EQ(open_pid_shm(name.c_str(), &shm), -1);
+}
+
+/**
+ * @brief A full measurement ring drops and counts frames instead of blocking the producer, and the sequence shows
+ *        where they were lost
+ */
+TEST(PID_SHM, FULL_RING_DROPS)
+{
+    const std::string name = segment_name("drops");
+    PIDShmTypeDef_t shm;
+    ASSERT_EQ(create_pid_shm(name.c_str(), 3, 4, &shm), 0);
+    EXPECT_EQ(shm.slotBytes, 64u);
+
+    for (uint32_t frame = 0; frame < 6; frame++)
+    {
+        PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&shm, PID_SHM_MEASUREMENT);
+        if (frame < 4)
+        {
+            ASSERT_NE(slot, nullptr);
+            pid_shm_frame_values(slot)[0] = (float)frame;
+            commit_pid_shm_write(&shm, PID_SHM_MEASUREMENT, 100 + frame);
+        }
+        else
+        {
+            EXPECT_EQ(slot, nullptr);
+        }
+    }
+    EXPECT_EQ(get_pid_shm_dropped(&shm, PID_SHM_MEASUREMENT), 2u);
+
+    const PIDShmFrameTypeDef_t *frame = peek_pid_shm_frame(&shm, PID_SHM_MEASUREMENT);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->sequence, 0u);
+    EXPECT_EQ(frame->timestampNs, 100u);
+    release_pid_shm_frame(&shm, PID_SHM_MEASUREMENT);
+
+    PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&shm, PID_SHM_MEASUREMENT);
+    ASSERT_NE(slot, nullptr);
+    commit_pid_shm_write(&shm, PID_SHM_MEASUREMENT, 200);
+
+    for (uint64_t expected : {1u, 2u, 3u, 6u})
+    {
+        frame = peek_pid_shm_frame(&shm, PID_SHM_MEASUREMENT);
+        ASSERT_NE(frame, nullptr);
+        EXPECT_EQ(frame->sequence, expected);
+        release_pid_shm_frame(&shm, PID_SHM_MEASUREMENT);
+    }
+    EXPECT_EQ(peek_pid_shm_frame(&shm, PID_SHM_MEASUREMENT), nullptr);
+
+    close_pid_shm(&shm);
+    EXPECT_EQ(unlink_pid_shm(name.c_str()), 0);
+}
+
+/**
+ * @brief A consumer sleeping on the futex is woken by the next frame, and an empty ring times out
+ */
+TEST(PID_SHM, WAIT_WAKES_ON_FRAME)
+{
+    const std::string name = segment_name("wait");
+    PIDShmTypeDef_t consumer;
+    ASSERT_EQ(create_pid_shm(name.c_str(), 1, 8, &consumer), 0);
+    PIDShmTypeDef_t producer;
+    ASSERT_EQ(open_pid_shm(name.c_str(), &producer), 0);
+
+    EXPECT_EQ(wait_pid_shm_frame(&consumer, PID_SHM_MEASUREMENT, 1000000), -1);
+
+    std::thread thread([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&producer, PID_SHM_MEASUREMENT);
+        pid_shm_frame_values(slot)[0] = 49.6f;
+        commit_pid_shm_write(&producer, PID_SHM_MEASUREMENT, 1);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(wait_pid_shm_frame(&consumer, PID_SHM_MEASUREMENT, 5000000000u), 0);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(4));
+    thread.join();
+
+    const PIDShmFrameTypeDef_t *frame = peek_pid_shm_frame(&consumer, PID_SHM_MEASUREMENT);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(pid_shm_frame_const_values(frame)[0], 49.6f);
+
+    close_pid_shm(&producer);
+    close_pid_shm(&consumer);
+    unlink_pid_shm(name.c_str());
+}
+
+/**
+ * @brief Measurements and outputs bounced between two threads, each sleeping on the futex for the other's frame.
+ *        A lost wake would leave a wait running into its timeout.
+ */
+TEST(PID_SHM, PING_PONG_NEVER_TIMES_OUT)
+{
+    const uint32_t rounds = 100000;
+    const std::string name = segment_name("pingpong");
+    PIDShmTypeDef_t controller;
+    ASSERT_EQ(create_pid_shm(name.c_str(), 1, 4, &controller), 0);
+    PIDShmTypeDef_t sensor;
+    ASSERT_EQ(open_pid_shm(name.c_str(), &sensor), 0);
+
+    uint32_t controllerTimeouts = 0;
+    std::thread thread([&]() {
+        for (uint32_t round = 0; round < rounds; round++)
+        {
+            if (wait_pid_shm_frame(&controller, PID_SHM_MEASUREMENT, 1000000000u) != 0)
+            {
+                controllerTimeouts++;
+                break;
+            }
+            float value = pid_shm_frame_const_values(peek_pid_shm_frame(&controller, PID_SHM_MEASUREMENT))[0];
+            release_pid_shm_frame(&controller, PID_SHM_MEASUREMENT);
+
+            PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&controller, PID_SHM_OUTPUT);
+            pid_shm_frame_values(slot)[0] = value;
+            commit_pid_shm_write(&controller, PID_SHM_OUTPUT, round);
+        }
+    });
+
+    uint32_t sensorTimeouts = 0;
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&sensor, PID_SHM_MEASUREMENT);
+        if (slot == nullptr)
+        {
+            ADD_FAILURE() << "measurement ring full in round " << round;
+            break;
+        }
+        pid_shm_frame_values(slot)[0] = float(round);
+        commit_pid_shm_write(&sensor, PID_SHM_MEASUREMENT, round);
+
+        if (wait_pid_shm_frame(&sensor, PID_SHM_OUTPUT, 1000000000u) != 0)
+        {
+            sensorTimeouts++;
+            break;
+        }
+        EXPECT_EQ(pid_shm_frame_const_values(peek_pid_shm_frame(&sensor, PID_SHM_OUTPUT))[0], float(round));
+        release_pid_shm_frame(&sensor, PID_SHM_OUTPUT);
+    }
+
+    thread.join();
+    EXPECT_EQ(sensorTimeouts, 0u);
+    EXPECT_EQ(controllerTimeouts, 0u);
+
+    close_pid_shm(&sensor);
+    close_pid_shm(&controller);
+    unlink_pid_shm(name.c_str());
+}
+
+/**
+ * @brief Measurements produced by a separate process are stepped in place and give exactly the outputs of stepping
+ *        the same measurements from local memory
+ */
+TEST(PID_SHM, CROSS_PROCESS_STEPS_MATCH_LOCAL)
+{
+    const uint32_t channels = 24;
+    const uint32_t frames = 1000;
+    const std::string name = segment_name("process");
+    PIDShmTypeDef_t shm;
+    ASSERT_EQ(create_pid_shm(name.c_str(), channels, 1024, &shm), 0);
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        PIDShmTypeDef_t sensor;
+        if (open_pid_shm(name.c_str(), &sensor) != 0)
+        {
+            _exit(1);
+        }
+
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&sensor, PID_SHM_MEASUREMENT);
+            if (slot == NULL)
+            {
+                _exit(2);
+            }
+            for (uint32_t channel = 0; channel < channels; channel++)
+            {
+                pid_shm_frame_values(slot)[channel] = measurement_at(frame, channel);
+            }
+            commit_pid_shm_write(&sensor, PID_SHM_MEASUREMENT, 1000 + frame);
+        }
+
+        close_pid_shm(&sensor);
+        _exit(0);
+    }
+
+    BankStorage bank(channels, VOLTAGE_STAGE);
+    uint32_t processed = 0;
+    while (processed < frames)
+    {
+        ASSERT_EQ(wait_pid_shm_frame(&shm, PID_SHM_MEASUREMENT, 5000000000u), 0);
+        processed += step_pid_shm_batch(&bank.bank, &shm, frames - processed);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+
+    BankStorage local(channels, VOLTAGE_STAGE);
+    std::vector<float> measurement(channels);
+    std::vector<float> expected(channels);
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            measurement[channel] = measurement_at(frame, channel);
+        }
+        calc_pid_output_batch(&local.bank, measurement.data(), expected.data());
+
+        const PIDShmFrameTypeDef_t *output = peek_pid_shm_frame(&shm, PID_SHM_OUTPUT);
+        ASSERT_NE(output, nullptr);
+        EXPECT_EQ(output->sequence, frame);
+        EXPECT_EQ(output->timestampNs, 1000u + frame);
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            ASSERT_EQ(pid_shm_frame_const_values(output)[channel], expected[channel]);
+        }
+        release_pid_shm_frame(&shm, PID_SHM_OUTPUT);
+    }
+
+    EXPECT_EQ(get_pid_shm_dropped(&shm, PID_SHM_MEASUREMENT), 0u);
+    close_pid_shm(&shm);
+    unlink_pid_shm(name.c_str());
+}
+
+/**
+ * @brief A full output ring holds the measurements back rather than dropping outputs
+ */
+TEST(PID_SHM, FULL_OUTPUT_RING_STOPS_STEPPING)
+{
+    const std::string name = segment_name("backpressure");
+    PIDShmTypeDef_t shm;
+    ASSERT_EQ(create_pid_shm(name.c_str(), 2, 4, &shm), 0);
+
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&shm, PID_SHM_MEASUREMENT);
+        ASSERT_NE(slot, nullptr);
+        pid_shm_frame_values(slot)[0] = measurement_at(frame, 0);
+        pid_shm_frame_values(slot)[1] = measurement_at(frame, 1);
+        commit_pid_shm_write(&shm, PID_SHM_MEASUREMENT, frame);
+    }
+
+    BankStorage bank(2, VOLTAGE_STAGE);
+    EXPECT_EQ(step_pid_shm_batch(&bank.bank, &shm, 3), 3u);
+    EXPECT_EQ(step_pid_shm_batch(&bank.bank, &shm, 10), 1u);
+    EXPECT_EQ(step_pid_shm_batch(&bank.bank, &shm, 10), 0u);
+
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&shm, PID_SHM_MEASUREMENT);
+        ASSERT_NE(slot, nullptr);
+        commit_pid_shm_write(&shm, PID_SHM_MEASUREMENT, 4 + frame);
+    }
+    EXPECT_EQ(step_pid_shm_batch(&bank.bank, &shm, 10), 0u);
+
+    release_pid_shm_frame(&shm, PID_SHM_OUTPUT);
+    EXPECT_EQ(step_pid_shm_batch(&bank.bank, &shm, 10), 1u);
+    EXPECT_EQ(get_pid_shm_dropped(&shm, PID_SHM_OUTPUT), 0u);
+
+    BankStorage wrongSize(3, VOLTAGE_STAGE);
+    EXPECT_EQ(step_pid_shm_batch(&wrongSize.bank, &shm, 10), 0u);
+
+    close_pid_shm(&shm);
+    unlink_pid_shm(name.c_str());
+}
@@ -0,0 +1,174 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_instr.h"
+#include "pid_simd.h"
+}
+
+/**
+ * @brief Random bank with limits tight enough that both saturation branches and the unsaturated path are taken
+ */
+struct RandomBank : BankStorage
+{
+    std::vector<float> measurement;
+
+    RandomBank(uint32_t count, uint32_t seed) : BankStorage(count), measurement(count)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> gain(0, 4);
+        std::uniform_real_distribution<float> voltage(39.6, 52);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            kI[i] = gain(rng);
+            KP[i] = (i % 3 == 0) ? 0 : gain(rng);
+            lowerLimit[i] = 0;
+            upperLimit[i] = (i % 2 == 0) ? 3 : 100;
+            referencePoint[i] = 49.6;
+            measurement[i] = voltage(rng);
+        }
+    }
+};
+
+/**
+ * @brief Every supported instruction set must give bit-identical results to the scalar kernel, including the
+ *        scalar tail of banks that are not a multiple of the vector width.
+ */
+TEST(PID_SIMD, KERNELS_MATCH_SCALAR)
+{
+    const PIDSimdLevel_t original = get_pid_simd_level();
+    const PIDSimdLevel_t levels[] = {PID_SIMD_NEON, PID_SIMD_AVX2, PID_SIMD_AVX512};
+    const uint32_t count = 1000 + 13;
+
+    for (PIDSimdLevel_t level : levels)
+    {
+        if (!is_pid_simd_level_supported(level))
+        {
+            continue;
+        }
+
+        RandomBank reference(count, 42);
+        RandomBank vector(count, 42);
+        std::vector<float> referenceOutput(count);
+        std::vector<float> vectorOutput(count);
+
+        for (uint8_t step = 0; step < 20; step++)
+        {
+            ASSERT_EQ(set_pid_simd_level(PID_SIMD_SCALAR), 1);
+            calc_pid_output_batch(&reference.bank, reference.measurement.data(), referenceOutput.data());
+            ASSERT_EQ(set_pid_simd_level(level), 1);
+            calc_pid_output_batch(&vector.bank, vector.measurement.data(), vectorOutput.data());
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                ASSERT_EQ(referenceOutput[i], vectorOutput[i]) << "level " << level << " controller " << i;
+                ASSERT_EQ(reference.error[i], vector.error[i]);
+                ASSERT_EQ(reference.previousError[i], vector.previousError[i]);
+                ASSERT_EQ(reference.previousOutput[i], vector.previousOutput[i]);
+            }
+        }
+    }
+
+    set_pid_simd_level(original);
+}
+
+/**
+ * @brief With the hooks built in, the vector kernels count the saturation branch of every lane the way the scalar
+ *        kernel counts every controller
+ */
+TEST(PID_SIMD, KERNELS_COUNT_SATURATIONS)
+{
+    if (!is_pid_instrumentation_enabled())
+    {
+        GTEST_SKIP() << "built without PID_ENABLE_INSTRUMENTATION";
+    }
+
+    const PIDSimdLevel_t original = get_pid_simd_level();
+    const PIDSimdLevel_t levels[] = {PID_SIMD_SCALAR, PID_SIMD_NEON, PID_SIMD_AVX2, PID_SIMD_AVX512};
+    const uint32_t count = 1000 + 13;
+    auto snapshot = std::make_unique<PIDInstrumentationSnapshotTypeDef_t>();
+    uint64_t expected[PID_SATURATION_BRANCHES] = {};
+
+    for (PIDSimdLevel_t level : levels)
+    {
+        if (!set_pid_simd_level(level))
+        {
+            continue;
+        }
+
+        RandomBank bank(count, 42);
+        std::vector<float> output(count);
+        reset_pid_instrumentation();
+        for (uint8_t step = 0; step < 20; step++)
+        {
+            calc_pid_output_batch(&bank.bank, bank.measurement.data(), output.data());
+        }
+        snapshot_pid_instrumentation(snapshot.get(), 1);
+
+        // Two saturations per controller and step
+        EXPECT_EQ(snapshot->saturation[PID_SATURATION_NONE] + snapshot->saturation[PID_SATURATION_UPPER] +
+                      snapshot->saturation[PID_SATURATION_LOWER],
+                  2u * 20u * count);
+        if (level == PID_SIMD_SCALAR)
+        {
+            std::copy(snapshot->saturation, snapshot->saturation + PID_SATURATION_BRANCHES, expected);
+            EXPECT_GT(expected[PID_SATURATION_UPPER], 0u);
+            EXPECT_GT(expected[PID_SATURATION_LOWER], 0u);
+        }
+        for (uint32_t branch = 0; branch < PID_SATURATION_BRANCHES; branch++)
+        {
+            EXPECT_EQ(snapshot->saturation[branch], expected[branch]) << "level " << level << " branch " << branch;
+        }
+    }
+
+    set_pid_simd_level(original);
+}
+
+/**
+ * @brief A range step only touches the requested controllers
+ */
+TEST(PID_SIMD, RANGE_ONLY_TOUCHES_RANGE)
+{
+    const uint32_t count = 64;
+    RandomBank bank(count, 7);
+    std::vector<float> output(count, -1);
+
+    calc_pid_output_batch_range(&bank.bank, bank.measurement.data(), output.data(), 5, 37);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bool inRange = (i >= 5) && (i < 37);
+        EXPECT_EQ(output[i] != -1, inRange) << "controller " << i;
+        if (!inRange)
+        {
+            EXPECT_EQ(bank.previousOutput[i], 0);
+            EXPECT_EQ(bank.error[i], 0);
+        }
+    }
+}
+
+/**
+ * @brief Forcing an unsupported level is refused and leaves the active level alone
+ */
+TEST(PID_SIMD, UNSUPPORTED_LEVEL_REFUSED)
+{
+    const PIDSimdLevel_t original = get_pid_simd_level();
+    EXPECT_EQ(is_pid_simd_level_supported(PID_SIMD_SCALAR), 1);
+
+    const PIDSimdLevel_t levels[] = {PID_SIMD_NEON, PID_SIMD_AVX2, PID_SIMD_AVX512};
+    for (PIDSimdLevel_t level : levels)
+    {
+        if (!is_pid_simd_level_supported(level))
+        {
+            EXPECT_EQ(set_pid_simd_level(level), 0);
+            EXPECT_EQ(get_pid_simd_level(), original);
+        }
+    }
+}
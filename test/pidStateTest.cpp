@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+extern "C"
+{
+#include "pid_state.h"
+}
+
+static_assert(sizeof(PIDStateTypeDef_t) == 12, "hot state must stay compact");
+static_assert((sizeof(PIDStateTypeDef_t) * PID_STATE_GROUP) % PID_CACHE_LINE_SIZE == 0,
+              "a group of states must fill whole cache lines");
+
+/**
+ * @brief Controllers sharing a profile must step exactly like the equivalent PIDTypeDef_t objects
+ */
+TEST(CALC_PID_STATE, SHARED_PROFILE_MATCHES_SCALAR)
+{
+    std::vector<PIDGainProfileTypeDef_t> profiles(2);
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0, .referencePoint = 3};
+
+    const uint32_t count = 40;
+    std::vector<PIDTypeDef_t> scalar(count);
+    std::vector<PIDStateTypeDef_t> states(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        scalar[i] = (i % 2 == 0) ? voltageStage : currentStage;
+        scalar[i].previousOutput = 0.05f * i;
+        split_pid_object(&scalar[i], i % 2, (i < 2) ? &profiles[i] : NULL, &states[i]);
+    }
+
+    std::vector<float> measurement(count);
+    std::vector<float> output(count);
+    for (uint8_t step = 0; step < 30; step++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            measurement[i] = (i % 2 == 0) ? 47.0f + (0.1f * step) : 0.1f * step;
+        }
+
+        calc_pid_state_output_batch(profiles.data(), states.data(), count, NULL, measurement.data(), output.data());
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            EXPECT_EQ(calc_pid_output(&scalar[i], measurement[i]), output[i]);
+            EXPECT_EQ(scalar[i].previousError, states[i].previousError);
+            EXPECT_EQ(scalar[i].previousOutput, states[i].previousOutput);
+        }
+    }
+}
+
+/**
+ * @brief SIMPLE_10_LOOP_TEST with the current stage reference passed per step instead of through the profile
+ */
+TEST(CALC_PID_STATE, CASCADE_10_LOOP_TEST)
+{
+    PIDGainProfileTypeDef_t profiles[2] = {
+        {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6},
+        {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0, .referencePoint = 0},
+    };
+    PIDStateTypeDef_t voltageState = {0, 0, 0};
+    PIDStateTypeDef_t currentState = {0, 0, 1};
+
+    float currentReference = 0;
+    float phase = 0;
+    const float zero = 0;
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        currentReference = calc_pid_state_output(profiles, &voltageState, (39.6 + (0.1 * i)));
+        calc_pid_state_output_batch(profiles, &currentState, 1, &currentReference, &zero, &phase);
+    }
+
+    EXPECT_EQ(currentReference, 3);
+    EXPECT_EQ(phase, 42.75);
+
+    PIDTypeDef_t merged = {};
+    merge_pid_object(profiles, &currentState, &merged);
+    EXPECT_EQ(merged.kI, 0.75f);
+    EXPECT_EQ(merged.previousOutput, phase);
+
+    reset_pid_state_memory(&currentState, 1);
+    EXPECT_EQ(currentState.previousOutput, 0);
+    EXPECT_EQ(currentState.profile, 1);
+}
+
+/**
+ * @brief Partitions must cover every state exactly once and start on a cache line group
+ */
+TEST(CALC_PID_STATE, PARTITION_ALIGNED)
+{
+    const uint32_t counts[] = {0, 1, 15, 16, 17, 1000, 4099};
+    const uint32_t parts = 7;
+
+    for (uint32_t count : counts)
+    {
+        uint32_t expectedBegin = 0;
+        for (uint32_t part = 0; part < parts; part++)
+        {
+            uint32_t begin = 0;
+            uint32_t end = 0;
+            get_pid_state_partition(count, parts, part, &begin, &end);
+
+            EXPECT_EQ(begin, expectedBegin);
+            EXPECT_LE(begin, end);
+            EXPECT_TRUE((begin % PID_STATE_GROUP == 0) || (begin == count));
+            expectedBegin = end;
+        }
+        EXPECT_EQ(expectedBegin, count);
+    }
+}
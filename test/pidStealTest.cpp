@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <vector>
+
+extern "C"
+{
+#include "pid_steal.h"
+}
+
+/**
+ * @brief Counts how often each item is processed, with work whose cost grows along the range so that the workers
+ *        owning the end of the range fall behind and get stolen from
+ */
+static void count_items(void *context, uint32_t begin, uint32_t end, uint32_t)
+{
+    std::vector<std::atomic<uint32_t>> &seen = *static_cast<std::vector<std::atomic<uint32_t>> *>(context);
+    for (uint32_t i = begin; i < end; i++)
+    {
+        volatile uint32_t spin = 0;
+        for (uint32_t j = 0; j < i; j++)
+        {
+            spin = spin + 1;
+        }
+        seen[i].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Every item is processed exactly once whatever the thread count and grain
+ */
+TEST(PID_STEAL, PARALLEL_FOR_COVERS_EVERY_ITEM_ONCE)
+{
+    const uint32_t count = 5000;
+    const uint32_t threads[] = {1, 2, 4, 8};
+    const uint32_t grains[] = {1, 7, 64};
+
+    for (uint32_t threadCount : threads)
+    {
+        for (uint32_t grain : grains)
+        {
+            std::vector<std::atomic<uint32_t>> seen(count);
+            ASSERT_EQ(run_pid_parallel_for(count, threadCount, grain, count_items, &seen), 0);
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                ASSERT_EQ(seen[i].load(), 1u) << "item " << i << " threads " << threadCount << " grain " << grain;
+            }
+        }
+    }
+}
+
+/**
+ * @brief A worker without a range steals the upper half of the largest range, the owner keeps the lower half
+ */
+TEST(PID_STEAL, IDLE_WORKER_STEALS_HALF)
+{
+    PIDStealSchedulerTypeDef_t *scheduler = create_pid_steal_scheduler(3);
+    ASSERT_NE(scheduler, nullptr);
+
+    const uint32_t begin[] = {0, 100, 100};
+    const uint32_t end[] = {100, 100, 110};
+    reset_pid_steal_scheduler_ranges(scheduler, begin, end);
+
+    uint32_t first = 0;
+    uint32_t last = 0;
+    ASSERT_EQ(take_pid_steal_work(scheduler, 1, 10, &first, &last), 1);
+    EXPECT_EQ(first, 50u);
+    EXPECT_EQ(last, 60u);
+    EXPECT_EQ(get_pid_steal_count(scheduler, 1), 1u);
+
+    ASSERT_EQ(take_pid_steal_work(scheduler, 0, 100, &first, &last), 1);
+    EXPECT_EQ(first, 0u);
+    EXPECT_EQ(last, 50u);
+
+    // Worker 0 is now empty and steals from the larger of worker 1 (40 left) and worker 2 (10 left)
+    ASSERT_EQ(take_pid_steal_work(scheduler, 0, 100, &first, &last), 1);
+    EXPECT_EQ(first, 80u);
+    EXPECT_EQ(last, 100u);
+
+    destroy_pid_steal_scheduler(scheduler);
+}
+
+/**
+ * @brief Once every range is empty no more work is handed out
+ */
+TEST(PID_STEAL, EMPTY_SCHEDULER)
+{
+    PIDStealSchedulerTypeDef_t *scheduler = create_pid_steal_scheduler(2);
+    ASSERT_NE(scheduler, nullptr);
+    reset_pid_steal_scheduler(scheduler, 0);
+
+    uint32_t first = 0;
+    uint32_t last = 0;
+    EXPECT_EQ(take_pid_steal_work(scheduler, 0, 1, &first, &last), 0);
+    EXPECT_EQ(take_pid_steal_work(scheduler, 1, 1, &first, &last), 0);
+    EXPECT_EQ(create_pid_steal_scheduler(0), nullptr);
+
+    destroy_pid_steal_scheduler(scheduler);
+}
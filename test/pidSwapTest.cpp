@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "pid_swap.h"
+}
+
+static const PIDGainProfileTypeDef_t BULK_PROFILE = {
+    .kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+static const PIDGainProfileTypeDef_t TRANSITION_PROFILE = {
+    .kI = 0.25, .KP = 1, .upperLimit = 2, .lowerLimit = 0, .referencePoint = 49.6};
+
+TEST(PID_PROFILE_SWAP, BAD_ARGUMENTS)
+{
+    EXPECT_EQ(create_pid_profile_swap(NULL, 1), nullptr);
+    EXPECT_EQ(create_pid_profile_swap(&BULK_PROFILE, 0), nullptr);
+    EXPECT_EQ(publish_pid_profile(NULL, &BULK_PROFILE), -1);
+
+    PIDProfileSwapTypeDef_t *swap = create_pid_profile_swap(&BULK_PROFILE, 1);
+    ASSERT_NE(swap, nullptr);
+    EXPECT_EQ(publish_pid_profile(swap, NULL), -1);
+    destroy_pid_profile_swap(swap);
+}
+
+/**
+ * @brief A swap takes effect at the next step boundary and gives the same outputs as retuning the struct between
+ *        steps, memories included
+ */
+TEST(PID_PROFILE_SWAP, SWAP_AT_STEP_BOUNDARY)
+{
+    PIDProfileSwapTypeDef_t *swap = create_pid_profile_swap(&BULK_PROFILE, 1);
+    ASSERT_NE(swap, nullptr);
+
+    PIDTypeDef_t swapped = {};
+    PIDTypeDef_t retuned = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    for (uint32_t i = 0; i < 40; i++)
+    {
+        if (i == 20)
+        {
+            ASSERT_EQ(publish_pid_profile(swap, &TRANSITION_PROFILE), 0);
+            retuned.kI = 0.25;
+            retuned.KP = 1;
+            retuned.upperLimit = 2;
+        }
+
+        float measurement = 48.5f + 0.05f * i;
+        const PIDGainProfileTypeDef_t *profile = acquire_pid_profile(swap, 0);
+        ASSERT_EQ(calc_pid_output_profile(&swapped, profile, measurement), calc_pid_output(&retuned, measurement));
+        EXPECT_EQ(swapped.previousOutput, retuned.previousOutput);
+    }
+
+    destroy_pid_profile_swap(swap);
+}
+
+/**
+ * @brief A retired profile stays allocated until every reader has acquired a newer one
+ */
+TEST(PID_PROFILE_SWAP, RECLAIM_WAITS_FOR_ALL_READERS)
+{
+    PIDProfileSwapTypeDef_t *swap = create_pid_profile_swap(&BULK_PROFILE, 2);
+    ASSERT_NE(swap, nullptr);
+
+    const PIDGainProfileTypeDef_t *first = acquire_pid_profile(swap, 0);
+    EXPECT_EQ(first->KP, 4);
+    ASSERT_EQ(publish_pid_profile(swap, &TRANSITION_PROFILE), 0);
+    EXPECT_EQ(get_pid_profile_retired(swap), 1u);
+
+    EXPECT_EQ(acquire_pid_profile(swap, 0)->KP, 1);
+    EXPECT_EQ(reclaim_pid_profiles(swap), 0u);
+    EXPECT_EQ(get_pid_profile_retired(swap), 1u);
+
+    // Reader 1 still on the first profile while a third one is published
+    ASSERT_EQ(publish_pid_profile(swap, &BULK_PROFILE), 0);
+    EXPECT_EQ(get_pid_profile_retired(swap), 2u);
+
+    EXPECT_EQ(acquire_pid_profile(swap, 1)->KP, 4);
+    EXPECT_EQ(reclaim_pid_profiles(swap), 1u);
+    EXPECT_EQ(acquire_pid_profile(swap, 0)->KP, 4);
+    EXPECT_EQ(reclaim_pid_profiles(swap), 1u);
+    EXPECT_EQ(get_pid_profile_retired(swap), 0u);
+
+    destroy_pid_profile_swap(swap);
+}
+
+/**
+ * @brief Loops stepping while a tuner publishes as fast as it can must only ever see whole profiles, never go back to
+ *        an older one, and end up with everything but the current profile reclaimed. Every field of profile n
+ *        holds n.
+ */
+TEST(PID_PROFILE_SWAP, CONCURRENT_PUBLISH)
+{
+    const uint32_t publications = 50000;
+    const uint32_t readers = 3;
+    const PIDGainProfileTypeDef_t zero = {};
+    PIDProfileSwapTypeDef_t *swap = create_pid_profile_swap(&zero, readers);
+    ASSERT_NE(swap, nullptr);
+
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> torn(0);
+    std::atomic<uint64_t> reordered(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t reader = 0; reader < readers; reader++)
+    {
+        threads.emplace_back([&, reader]() {
+            float last = 0;
+            bool finished = false;
+            do
+            {
+                finished = done.load(std::memory_order_acquire);
+                const PIDGainProfileTypeDef_t *profile = acquire_pid_profile(swap, reader);
+                const float value = profile->kI;
+                if ((profile->KP != value) || (profile->upperLimit != value) || (profile->lowerLimit != value) ||
+                    (profile->referencePoint != value))
+                {
+                    torn++;
+                }
+                if (value < last)
+                {
+                    reordered++;
+                }
+                last = value;
+            } while (!finished);
+        });
+    }
+
+    for (uint32_t n = 1; n <= publications; n++)
+    {
+        const float value = (float)n;
+        const PIDGainProfileTypeDef_t profile = {value, value, value, value, value};
+        ASSERT_EQ(publish_pid_profile(swap, &profile), 0);
+    }
+    done.store(true, std::memory_order_release);
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_EQ(reordered.load(), 0u);
+
+    // Every reader acquired after the last publication
+    reclaim_pid_profiles(swap);
+    EXPECT_EQ(get_pid_profile_retired(swap), 0u);
+
+    destroy_pid_profile_swap(swap);
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+extern "C"
+{
+#include "pid_sweep.h"
+}
+
+static void default_sweep_config(PIDSweepConfigTypeDef_t &config, uint32_t threads)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+    load_cascade_stages(&config.baseline, &voltageStage, &currentStage);
+    get_pid_plant_default_config(&config.plant);
+    config.initialStateOfCharge = 0.88;
+    config.limits = {.terminationCurrent = config.plant.capacityAh / 20, .settlingBand = 0.01, .maxSteps = 2000000};
+    config.overshootPenalty = 1000;
+    config.saturationPenalty = 1;
+    config.threads = threads;
+}
+
+/**
+ * @brief The grid is the cartesian product of the ranges with the first parameter varying fastest
+ */
+TEST(PID_SWEEP, GRID)
+{
+    PIDSweepRangeTypeDef_t ranges[PID_SWEEP_PARAMETERS] = {
+        {0, 4, 3}, {0.5, 0.5, 1}, {0, 0, 0}, {0.25, 0.75, 2}, {3, 3, 1},
+    };
+
+    EXPECT_EQ(build_pid_sweep_grid(ranges, NULL, 0), 6u);
+
+    std::vector<PIDSweepCandidateTypeDef_t> candidates(6);
+    ASSERT_EQ(build_pid_sweep_grid(ranges, candidates.data(), candidates.size()), 6u);
+    EXPECT_EQ(candidates[0].value[PID_SWEEP_VOLTAGE_KP], 0);
+    EXPECT_EQ(candidates[1].value[PID_SWEEP_VOLTAGE_KP], 2);
+    EXPECT_EQ(candidates[2].value[PID_SWEEP_VOLTAGE_KP], 4);
+    EXPECT_EQ(candidates[2].value[PID_SWEEP_CURRENT_KI], 0.25);
+    EXPECT_EQ(candidates[3].value[PID_SWEEP_CURRENT_KI], 0.75);
+    EXPECT_EQ(candidates[5].value[PID_SWEEP_CHARGE_CURRENT], 3);
+}
+
+/**
+ * @brief A random sample stays within the ranges and candidate i does not depend on the sample size
+ */
+TEST(PID_SWEEP, RANDOM_SAMPLE)
+{
+    PIDSweepRangeTypeDef_t ranges[PID_SWEEP_PARAMETERS] = {
+        {0, 8, 0}, {0.05, 1.5, 0}, {0, 1, 0}, {0.1, 1.5, 0}, {2, 4, 0},
+    };
+
+    std::vector<PIDSweepCandidateTypeDef_t> small(10);
+    std::vector<PIDSweepCandidateTypeDef_t> large(100);
+    build_pid_sweep_random(ranges, 42, small.data(), small.size());
+    build_pid_sweep_random(ranges, 42, large.data(), large.size());
+
+    for (uint32_t i = 0; i < large.size(); i++)
+    {
+        for (uint32_t p = 0; p < PID_SWEEP_PARAMETERS; p++)
+        {
+            EXPECT_GE(large[i].value[p], ranges[p].min);
+            EXPECT_LE(large[i].value[p], ranges[p].max);
+            if (i < small.size())
+            {
+                EXPECT_EQ(small[i].value[p], large[i].value[p]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief The results are ranked by score, are the same on one or several threads, and a charge current that the
+ *        plant cannot reach within the step limit ranks last
+ */
+TEST(PID_SWEEP, RANKING_INDEPENDENT_OF_THREADS)
+{
+    PIDSweepRangeTypeDef_t ranges[PID_SWEEP_PARAMETERS] = {
+        {0, 8, 2}, {0.05, 1.5, 2}, {0, 0, 1}, {0.75, 0.75, 1}, {0.01, 3, 2},
+    };
+    const uint32_t count = build_pid_sweep_grid(ranges, NULL, 0);
+    std::vector<PIDSweepCandidateTypeDef_t> candidates(count);
+    build_pid_sweep_grid(ranges, candidates.data(), count);
+
+    PIDSweepConfigTypeDef_t serialConfig;
+    default_sweep_config(serialConfig, 1);
+    PIDSweepConfigTypeDef_t parallelConfig;
+    default_sweep_config(parallelConfig, 4);
+
+    std::vector<PIDSweepResultTypeDef_t> serial(count);
+    std::vector<PIDSweepResultTypeDef_t> parallel(count);
+    ASSERT_EQ(run_pid_sweep(&serialConfig, candidates.data(), count, serial.data()), 0);
+    ASSERT_EQ(run_pid_sweep(&parallelConfig, candidates.data(), count, parallel.data()), 0);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(serial[i].candidate, parallel[i].candidate);
+        EXPECT_EQ(serial[i].score, parallel[i].score);
+        if (i > 0)
+        {
+            EXPECT_LE(serial[i - 1].score, serial[i].score);
+        }
+    }
+
+    const PIDSweepResultTypeDef_t &best = serial[0];
+    EXPECT_EQ(best.charge.terminated, 1);
+    EXPECT_EQ(candidates[best.candidate].value[PID_SWEEP_CHARGE_CURRENT], 3);
+
+    const PIDSweepResultTypeDef_t &worst = serial[count - 1];
+    EXPECT_EQ(worst.charge.terminated, 0);
+    EXPECT_TRUE(std::isinf(worst.score));
+    EXPECT_EQ(candidates[worst.candidate].value[PID_SWEEP_CHARGE_CURRENT], 0.01f);
+}
@@ -22,7 +22,7 @@ extern "C"
  */
 TEST(CALC_ERROR, EP_CURRENT_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.referencePoint = 1.5;
 
     float ret = 0;
@@ -41,7 +41,7 @@ TEST(CALC_ERROR, EP_CURRENT_1)
  */
 TEST(CALC_ERROR, EP_CURRENT_2)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.referencePoint = 0;
 
     float ret = 0;
@@ -59,7 +59,7 @@ TEST(CALC_ERROR, EP_CURRENT_2)
  */
 TEST(CALC_ERROR, EQ_CURRENT_3)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.referencePoint = 1.5;
 
     calc_pid_output(&pidObject, 1.5);
@@ -75,7 +75,7 @@ TEST(CALC_ERROR, EQ_CURRENT_3)
  */
 TEST(CALC_ERROR, FAULT_INJECTION_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.referencePoint = 2;
 
     calc_pid_output(&pidObject, 10);
@@ -91,7 +91,7 @@ TEST(CALC_ERROR, FAULT_INJECTION_1)
 
 TEST(CALC_ERROR, FAULT_INJECTION_2)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.referencePoint = 10;
 
     calc_pid_output(&pidObject, 3);
@@ -105,7 +105,7 @@ TEST(CALC_ERROR, FAULT_INJECTION_2)
  */
 TEST(CALC_PROPORTIONAL, PROPORTIONAL_POSITIVE_TEST)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0;
     pidObject.referencePoint = 50.4;
@@ -125,7 +125,7 @@ TEST(CALC_PROPORTIONAL, PROPORTIONAL_POSITIVE_TEST)
  */
 TEST(CALC_PROPORTIONAL, PROPORTIONAL_NEGATIVE_TEST)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0;
     pidObject.upperLimit = 2000;
@@ -145,7 +145,7 @@ TEST(CALC_PROPORTIONAL, PROPORTIONAL_NEGATIVE_TEST)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_TEST)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 46.8;
@@ -161,7 +161,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_TEST)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_TEST)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.upperLimit = 2000;
@@ -178,7 +178,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_TEST)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_SATURATION)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 46.8;
@@ -197,7 +197,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_SATURATION)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_SATURATION)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 46.8;
@@ -217,7 +217,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_SATURATION)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 50.4;
@@ -240,7 +240,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_1)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_2)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 50.4;
@@ -263,7 +263,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_2)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_3)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 50.4;
@@ -287,7 +287,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_3)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_SATURATION_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 50.4;
@@ -310,7 +310,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_SATURATION_1)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_PHASE_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.75;
     pidObject.referencePoint = 3;
@@ -334,7 +334,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_PHASE_1)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_PHASE_2)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.75;
     pidObject.referencePoint = 3;
@@ -358,7 +358,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_PHASE_2)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_SATURATION_PHASE_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.75;
     pidObject.referencePoint = 3;
@@ -382,7 +382,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_ACCUMULATION_PARTITION_SATURATION_PHASE_1)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_ACCUMULATION_PARTITION_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 0;
@@ -407,7 +407,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_ACCUMULATION_PARTITION_1)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_ACCUMULATION_PARTITION_2)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 0;
@@ -432,7 +432,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_ACCUMULATION_PARTITION_2)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_ACCUMULATION_PARTITION_3)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 0;
@@ -457,7 +457,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_NEGATIVE_ACCUMULATION_PARTITION_3)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_BOUNDARY_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.5;
     pidObject.referencePoint = 50.4;
@@ -476,7 +476,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_BOUNDARY_1)
  */
 TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_BOUNDARY_2)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 0;
     pidObject.kI = 0.75;
     pidObject.referencePoint = 3;
@@ -495,7 +495,7 @@ TEST(CALC_INTEGRAL, INTEGRAL_POSITIVE_BOUNDARY_2)
  */
 TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_POSITIVE_TEST)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.5;
     pidObject.upperLimit = 3;
@@ -515,7 +515,7 @@ TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_POSITIVE_TEST)
  */
 TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_FAULT_INJECTION)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.5;
     pidObject.upperLimit = 3;
@@ -535,7 +535,7 @@ TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_FAULT_INJECTION)
  */
 TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_NEGATIVE_TEST)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.5;
     pidObject.upperLimit = 3;
@@ -555,7 +555,7 @@ TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_NEGATIVE_TEST)
  */
 TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_NEGATIVE_FAULT_INJECTION)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.5;
     pidObject.upperLimit = 3;
@@ -575,8 +575,8 @@ TEST(CALC_PROPORTIONAL_INTEGRAL, SATURATION_NEGATIVE_FAULT_INJECTION)
  */
 TEST(PID_INTEGRATION_TEST, SIMPLE_1_LOOP_TEST)
 {
-    PIDTypeDef_t voltageStage;
-    PIDTypeDef_t currentStage;
+    PIDTypeDef_t voltageStage = {};
+    PIDTypeDef_t currentStage = {};
 
     voltageStage = {
         .kI = 0.5,
@@ -614,8 +614,8 @@ TEST(PID_INTEGRATION_TEST, SIMPLE_1_LOOP_TEST)
  */
 TEST(PID_INTEGRATION_TEST, SIMPLE_10_LOOP_TEST)
 {
-    PIDTypeDef_t voltageStage;
-    PIDTypeDef_t currentStage;
+    PIDTypeDef_t voltageStage = {};
+    PIDTypeDef_t currentStage = {};
 
     voltageStage = {
         .kI = 0.75,
@@ -662,8 +662,8 @@ TEST(PID_INTEGRATION_TEST, SIMPLE_10_LOOP_TEST)
  */
 TEST(PID_INTEGRATION_TEST, SIMPLE_50_LOOP_TEST)
 {
-    PIDTypeDef_t voltageStage;
-    PIDTypeDef_t currentStage;
+    PIDTypeDef_t voltageStage = {};
+    PIDTypeDef_t currentStage = {};
 
     voltageStage = {
         .kI = 0.75,
@@ -710,8 +710,8 @@ TEST(PID_INTEGRATION_TEST, SIMPLE_50_LOOP_TEST)
  */
 TEST(PID_INTEGRATION_TEST, CC_CV_TRANSITION_TEST)
 {
-    PIDTypeDef_t voltageStage;
-    PIDTypeDef_t currentStage;
+    PIDTypeDef_t voltageStage = {};
+    PIDTypeDef_t currentStage = {};
 
     voltageStage = {
         .kI = 0.75,
@@ -763,7 +763,7 @@ TEST(PID_INTEGRATION_TEST, CC_CV_TRANSITION_TEST)
  */
 TEST(FAULT_INJECTION, FAULT_NEGATIVE_VOLTAGE)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.75;
     pidObject.lowerLimit = 0;
@@ -780,14 +780,14 @@ TEST(FAULT_INJECTION, FAULT_NEGATIVE_VOLTAGE)
  */
 TEST(FAULT_INJECTION, FAULT_NEGATIVE_VOLTAGE_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.75;
     pidObject.lowerLimit = 0;
     pidObject.upperLimit = 3;
     pidObject.referencePoint = 50.4;
 
-    PIDTypeDef_t currentStage;
+    PIDTypeDef_t currentStage = {};
     currentStage.kI = 0.5;
     currentStage.lowerLimit = 0;
     currentStage.upperLimit = 100;
@@ -807,7 +807,7 @@ TEST(FAULT_INJECTION, FAULT_NEGATIVE_VOLTAGE_1)
  */
 TEST(INTEGRAL_RESET, INTEGRAL_RESET_1)
 {
-    PIDTypeDef_t pidObject;
+    PIDTypeDef_t pidObject = {};
     pidObject.KP = 4;
     pidObject.kI = 0.75;
     pidObject.lowerLimit = 0;
@@ -825,4 +825,288 @@ TEST(INTEGRAL_RESET, INTEGRAL_RESET_1)
     EXPECT_EQ(pidObject.error, 0);
     EXPECT_EQ(pidObject.previousError, 0);
     EXPECT_EQ(pidObject.previousOutput, 0);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief With kD = 0 the derivative path must give exactly the proportional-integral output
+ *
+ */
+TEST(CALC_DERIVATIVE, ZERO_KD_MATCHES_PI)
+{
+    PIDTypeDef_t piStage = {.kI = 0.75, .KP = 4, .kD = 0, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t pidStage = piStage;
+    PIDDerivativeTypeDef_t derivative = {.filterCoefficient = 0.5};
+    reset_pid_derivative_memory(&derivative, 39.6);
+
+    for (uint8_t i = 0; i < 50; i++)
+    {
+        float operatingPoint = 39.6 + (0.1 * i);
+        EXPECT_EQ(calc_pid_output(&piStage, operatingPoint),
+                  calc_pid_output_derivative(&pidStage, &derivative, operatingPoint));
+    }
+}
+
+/**
+ * @brief The unfiltered derivative opposes a rising measurement by kD times the measurement change
+ *
+ */
+TEST(CALC_DERIVATIVE, DERIVATIVE_ON_MEASUREMENT)
+{
+    PIDTypeDef_t pidObject = {
+        .kI = 0, .KP = 0, .kD = 2, .upperLimit = 2000, .lowerLimit = -2000, .referencePoint = 50};
+    PIDDerivativeTypeDef_t derivative = {.filterCoefficient = 1};
+    reset_pid_derivative_memory(&derivative, 49);
+
+    float ret = calc_pid_output_derivative(&pidObject, &derivative, 49.5);
+    EXPECT_FLOAT_EQ(ret, -1);
+
+    // A reference step does not kick the output since only the measurement is differentiated
+    pidObject.referencePoint = 60;
+    ret = calc_pid_output_derivative(&pidObject, &derivative, 49.5);
+    EXPECT_EQ(ret, 0);
+}
+
+/**
+ * @brief The filtered derivative approaches the raw derivative geometrically with the filter coefficient
+ *
+ */
+TEST(CALC_DERIVATIVE, FILTERED_DERIVATIVE)
+{
+    PIDTypeDef_t pidObject = {
+        .kI = 0, .KP = 0, .kD = 1, .upperLimit = 2000, .lowerLimit = -2000, .referencePoint = 0};
+    PIDDerivativeTypeDef_t derivative = {.filterCoefficient = 0.25};
+    reset_pid_derivative_memory(&derivative, 0);
+
+    float ret = 0;
+    float measurement = 0;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        measurement -= 1;
+        ret = calc_pid_output_derivative(&pidObject, &derivative, measurement);
+    }
+
+    // raw derivative is 1 every step: 0.25, 0.4375, 0.578125
+    EXPECT_FLOAT_EQ(ret, 0.578125);
+
+    reset_pid_derivative_memory(&derivative, measurement);
+    EXPECT_EQ(derivative.derivative, 0);
+    EXPECT_EQ(derivative.previousMeasurement, measurement);
+    EXPECT_EQ(derivative.filterCoefficient, 0.25);
+}
+
+/**
+ * @brief The derivative term is added before the output saturation
+ *
+ */
+TEST(CALC_DERIVATIVE, DERIVATIVE_SATURATION)
+{
+    PIDTypeDef_t pidObject = {
+        .kI = 0.5, .KP = 4, .kD = 100, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDDerivativeTypeDef_t derivative = {.filterCoefficient = 1};
+    reset_pid_derivative_memory(&derivative, 49.6);
+
+    float ret = calc_pid_output_derivative(&pidObject, &derivative, 45);
+    EXPECT_EQ(ret, 3);
+
+    ret = calc_pid_output_derivative(&pidObject, &derivative, 50);
+    EXPECT_EQ(ret, 0);
+}
+
+/**
+ * @brief Steps a copy of the controller one call at a time, the reference for advance_pid_output
+ *
+ */
+static float step_pid_output(PIDTypeDef_t *pidObject, float currentOutput, uint64_t steps)
+{
+    float ret = 0;
+    for (uint64_t i = 0; i < steps; i++)
+    {
+        ret = calc_pid_output(pidObject, currentOutput);
+    }
+    return ret;
+}
+
+/**
+ * @brief A stage pinned at its limit, or with no error at all, advances exactly like the stepped controller
+ *
+ */
+TEST(ADVANCE_PID_OUTPUT, SATURATED_AND_CONSTANT_ARE_EXACT)
+{
+    PIDTypeDef_t advanced = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t stepped = advanced;
+
+    // CC: the voltage is far below the reference and the stage saturates on the first step
+    EXPECT_EQ(advance_pid_output(&advanced, 45, 100000), step_pid_output(&stepped, 45, 100000));
+    EXPECT_EQ(advanced.previousOutput, stepped.previousOutput);
+    EXPECT_EQ(advanced.previousError, stepped.previousError);
+    EXPECT_EQ(advanced.error, stepped.error);
+
+    // Over voltage: driven to the lower limit
+    EXPECT_EQ(advance_pid_output(&advanced, 52, 5000), step_pid_output(&stepped, 52, 5000));
+    EXPECT_EQ(advanced.previousOutput, stepped.previousOutput);
+
+    // Settled: no error keeps the integral where it is
+    advanced.previousOutput = stepped.previousOutput = 1.25;
+    EXPECT_EQ(advance_pid_output(&advanced, 49.6f, 777), step_pid_output(&stepped, 49.6f, 777));
+    EXPECT_EQ(advanced.previousOutput, stepped.previousOutput);
+}
+
+/**
+ * @brief While the integral ramps toward a limit the result is the float result of stepping, to the last ulp,
+ *        whether or not the limit is reached within the steps and across changes of binade
+ *
+ */
+TEST(ADVANCE_PID_OUTPUT, RAMP_MATCHES_STEPPING)
+{
+    const float measurements[] = {49.59f, 49.5f, 49.61f, 49.0f, 49.6f, 45.0f};
+    const uint64_t steps[] = {1, 2, 3, 10, 1000, 20000, 300000};
+    const float previousOutputs[] = {1, -0.75f, 1e-6f};
+
+    for (float measurement : measurements)
+    {
+        for (uint64_t count : steps)
+        {
+            for (float previousOutput : previousOutputs)
+            {
+                PIDTypeDef_t advanced = {.kI = 0.001,
+                                         .KP = 2,
+                                         .upperLimit = 3,
+                                         .lowerLimit = -1,
+                                         .referencePoint = 49.6,
+                                         .previousOutput = previousOutput};
+                PIDTypeDef_t stepped = advanced;
+
+                float expected = step_pid_output(&stepped, measurement, count);
+                EXPECT_EQ(advance_pid_output(&advanced, measurement, count), expected) << measurement << " " << count;
+                EXPECT_EQ(advanced.previousOutput, stepped.previousOutput) << measurement << " " << count;
+                EXPECT_EQ(advanced.previousError, stepped.previousError);
+                EXPECT_EQ(advanced.error, stepped.error);
+            }
+        }
+    }
+}
+
+/**
+ * @brief In a long CV tail the increment of the integral can be below half an ulp of the integral, every stepped
+ *        addition rounds back and the integral never moves
+ *
+ */
+TEST(ADVANCE_PID_OUTPUT, STALLED_INCREMENT)
+{
+    PIDTypeDef_t advanced = {
+        .kI = 0.001, .KP = 2, .upperLimit = 100, .lowerLimit = -100, .referencePoint = 49.6, .previousOutput = 50};
+    PIDTypeDef_t stepped = advanced;
+
+    float expected = step_pid_output(&stepped, 49.5999f, 1000000);
+    EXPECT_EQ(stepped.previousOutput, 50);
+    EXPECT_EQ(advance_pid_output(&advanced, 49.5999f, 1000000), expected);
+    EXPECT_EQ(advanced.previousOutput, 50);
+
+    // The same increment moves a smaller integral, by a rounded amount that changes from binade to binade
+    advanced.previousOutput = stepped.previousOutput = 0.01f;
+    expected = step_pid_output(&stepped, 49.5999f, 1000000);
+    EXPECT_EQ(advance_pid_output(&advanced, 49.5999f, 1000000), expected);
+    EXPECT_EQ(advanced.previousOutput, stepped.previousOutput);
+}
+
+/**
+ * @brief With a constant measurement the filtered derivative decays geometrically after its first step
+ *
+ */
+TEST(ADVANCE_PID_OUTPUT, DERIVATIVE_DECAYS)
+{
+    PIDTypeDef_t advanced = {
+        .kI = 0.01, .KP = 1, .kD = 5, .upperLimit = 100, .lowerLimit = -100, .referencePoint = 10};
+    PIDDerivativeTypeDef_t advancedDerivative = {.filterCoefficient = 0.25};
+    reset_pid_derivative_memory(&advancedDerivative, 8);
+    PIDTypeDef_t stepped = advanced;
+    PIDDerivativeTypeDef_t steppedDerivative = advancedDerivative;
+
+    const uint64_t steps[] = {1, 2, 5, 40};
+    for (uint64_t count : steps)
+    {
+        float expected = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            expected = calc_pid_output_derivative(&stepped, &steppedDerivative, 9);
+        }
+
+        float ret = advance_pid_output_derivative(&advanced, &advancedDerivative, 9, count);
+        EXPECT_NEAR(ret, expected, 1e-5f) << count;
+        EXPECT_NEAR(advancedDerivative.derivative, steppedDerivative.derivative, 1e-5f) << count;
+        EXPECT_EQ(advancedDerivative.previousMeasurement, steppedDerivative.previousMeasurement);
+    }
+}
+
+TEST(ADVANCE_PID_OUTPUT, ZERO_STEPS_AND_INVERTED_LIMITS)
+{
+    PIDTypeDef_t advanced = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    EXPECT_EQ(advance_pid_output(&advanced, 45, 0), 0);
+    EXPECT_EQ(advanced.previousOutput, 0);
+    EXPECT_EQ(advance_pid_output(NULL, 45, 10), 0);
+
+    // Inverted limits fall back to stepping
+    advanced.upperLimit = -1;
+    advanced.lowerLimit = 1;
+    PIDTypeDef_t stepped = advanced;
+    EXPECT_EQ(advance_pid_output(&advanced, 45, 25), step_pid_output(&stepped, 45, 25));
+    EXPECT_EQ(advanced.previousOutput, stepped.previousOutput);
+}
+
+/**
+ * @brief With no deadband the quiescent step gives exactly the outputs and memories of calc_pid_output, and skips
+ *        the steps once the stage is pinned at a limit with a constant measurement
+ *
+ */
+TEST(CALC_PID_OUTPUT_QUIESCENT, MATCHES_CALC_PID_OUTPUT)
+{
+    PIDTypeDef_t plain = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t quiet = plain;
+    PIDQuiescenceTypeDef_t quiescence = {.deadband = 0};
+
+    const float measurements[] = {45, 45, 45, 45, 49.59, 49.59, 49.6, 49.6, 49.6, 52, 52, 52, 45};
+    // A saturated or settled stage is at a fixed point right after the step that got it there
+    const uint8_t expectRecomputed[] = {1, 0, 0, 0, 1, 0, 1, 0, 0, 1, 1, 0, 1};
+    for (uint32_t i = 0; i < sizeof(measurements) / sizeof(measurements[0]); i++)
+    {
+        uint8_t recomputed = 2;
+        EXPECT_EQ(calc_pid_output_quiescent(&quiet, &quiescence, measurements[i], &recomputed),
+                  calc_pid_output(&plain, measurements[i]))
+            << "step " << i;
+        EXPECT_EQ(recomputed, expectRecomputed[i]) << "step " << i;
+        EXPECT_EQ(quiet.previousOutput, plain.previousOutput);
+        EXPECT_EQ(quiet.previousError, plain.previousError);
+    }
+
+    // A reference change wakes the controller
+    plain.referencePoint = quiet.referencePoint = 50;
+    uint8_t recomputed = 0;
+    calc_pid_output_quiescent(&quiet, &quiescence, 45, &recomputed);
+    EXPECT_EQ(recomputed, 1);
+}
+
+/**
+ * @brief Measurement noise within the deadband of a saturated stage is not recomputed
+ *
+ */
+TEST(CALC_PID_OUTPUT_QUIESCENT, DEADBAND)
+{
+    PIDTypeDef_t pidObject = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDQuiescenceTypeDef_t quiescence = {.deadband = 0.05};
+
+    uint32_t recomputes = 0;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        uint8_t recomputed = 0;
+        float ret = calc_pid_output_quiescent(&pidObject, &quiescence, 45.0f + ((i & 1) ? 0.02f : -0.02f), &recomputed);
+        EXPECT_EQ(ret, 3);
+        recomputes += recomputed;
+    }
+    EXPECT_EQ(recomputes, 1u);
+
+    // After a gain change the reset forces a recompute
+    reset_pid_quiescence(&quiescence);
+    uint8_t recomputed = 0;
+    calc_pid_output_quiescent(&pidObject, &quiescence, 45, &recomputed);
+    EXPECT_EQ(recomputed, 1);
+}
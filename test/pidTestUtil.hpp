@@ -0,0 +1,66 @@
+#ifndef PID_TEST_UTIL_HPP
+#define PID_TEST_UTIL_HPP
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "pid_bank.h"
+}
+
+/**
+ * @brief Voltage stage of the cascade in pidTest.cpp
+ */
+inline const PIDTypeDef_t VOLTAGE_STAGE = {
+    .kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+
+inline std::string temp_path(const char *name)
+{
+    return testing::TempDir() + name;
+}
+
+/**
+ * @brief Measurement of a channel at a tick, drifting around the VOLTAGE_STAGE reference so that both limits and the
+ *        unsaturated path are taken
+ */
+inline float measurement_at(uint32_t tick, uint32_t channel)
+{
+    return 45.0f + (0.01f * float(tick % 500)) + (0.1f * float(channel % 97));
+}
+
+/**
+ * @brief Owns the columns of a PIDBankTypeDef_t for the duration of a test
+ */
+struct BankStorage
+{
+    std::vector<float> kI, KP, upperLimit, lowerLimit, error, referencePoint, previousError, previousOutput;
+    PIDBankTypeDef_t bank;
+
+    explicit BankStorage(uint32_t count)
+        : kI(count), KP(count), upperLimit(count), lowerLimit(count), error(count), referencePoint(count),
+          previousError(count), previousOutput(count)
+    {
+        bank = {kI.data(), KP.data(), upperLimit.data(), lowerLimit.data(), error.data(), referencePoint.data(),
+                previousError.data(), previousOutput.data(), count};
+    }
+
+    /**
+     * @brief every entry loaded with pidObject
+     */
+    BankStorage(uint32_t count, const PIDTypeDef_t &pidObject) : BankStorage(count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            load_pid_bank_entry(&bank, i, &pidObject);
+        }
+    }
+
+    // bank points into the vectors of this instance
+    BankStorage(const BankStorage &) = delete;
+    BankStorage &operator=(const BankStorage &) = delete;
+};
+
+#endif
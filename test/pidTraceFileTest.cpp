@@ -0,0 +1,262 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_plant.h"
+#include "pid_trace_file.h"
+}
+
+static bool same_bits(float a, float b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+/**
+ * @brief Traces the current stage of a closed-loop charge, the kind of data the format is meant for
+ */
+static std::vector<PIDTraceStepTypeDef_t> trace_charge(uint32_t steps, PIDTypeDef_t *traced)
+{
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+    PIDCascadeTypeDef_t cascade;
+    load_cascade_stages(&cascade, &voltageStage, &currentStage);
+
+    PIDPlantConfigTypeDef_t config;
+    get_pid_plant_default_config(&config);
+    PIDPlantTypeDef_t plant;
+    init_pid_plant(&plant, &config, 0.9f);
+
+    std::vector<PIDTraceStepTypeDef_t> trace(steps);
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        float current = plant.current;
+        float phase = calc_cascade_output(&cascade, plant.voltage, current);
+        store_cascade_stages(&cascade, &voltageStage, &currentStage);
+        fill_pid_trace_step(&currentStage, current, phase, &trace[i]);
+        step_pid_plant(&plant, phase);
+    }
+
+    *traced = currentStage;
+    return trace;
+}
+
+/**
+ * @brief Every value reads back bit for bit, from any row and through either access path, and the file is at least
+ *        5x smaller than the raw floats
+ */
+TEST(PID_TRACE_FILE, ROUND_TRIP)
+{
+    const uint32_t steps = 50000;
+    PIDTypeDef_t gains;
+    std::vector<PIDTraceStepTypeDef_t> trace = trace_charge(steps, &gains);
+
+    const std::string path = temp_path("pid_trace_round_trip.ptrc");
+    PIDTraceWriterTypeDef_t *writer = create_pid_trace_writer(path.c_str(), &gains, 1000);
+    ASSERT_NE(writer, nullptr);
+    for (const PIDTraceStepTypeDef_t &step : trace)
+    {
+        ASSERT_EQ(append_pid_trace_step(writer, &step), 0);
+    }
+    ASSERT_EQ(close_pid_trace_writer(writer), 0);
+
+    PIDTraceReaderTypeDef_t *reader = open_pid_trace_reader(path.c_str());
+    ASSERT_NE(reader, nullptr);
+    const PIDTraceFileHeaderTypeDef_t *header = get_pid_trace_header(reader);
+    EXPECT_EQ(header->rows, steps);
+    EXPECT_EQ(header->blocks, 50u);
+    EXPECT_EQ(header->kI, gains.kI);
+    EXPECT_EQ(header->upperLimit, gains.upperLimit);
+
+    std::vector<PIDTraceStepTypeDef_t> read(steps);
+    ASSERT_EQ(read_pid_trace_steps(reader, 0, steps, read.data()), steps);
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        for (uint32_t column = 0; column < PID_TRACE_COLUMNS; column++)
+        {
+            ASSERT_TRUE(same_bits(read[i].value[column], trace[i].value[column])) << "row " << i << " column " << column;
+        }
+    }
+
+    // A window straddling two blocks, and one running past the end
+    std::vector<float> output(3000);
+    ASSERT_EQ(read_pid_trace_column(reader, PID_TRACE_OUTPUT, 12345, 3000, output.data()), 3000u);
+    for (uint32_t i = 0; i < 3000; i++)
+    {
+        ASSERT_TRUE(same_bits(output[i], trace[12345 + i].value[PID_TRACE_OUTPUT]));
+    }
+    EXPECT_EQ(read_pid_trace_column(reader, PID_TRACE_MEASUREMENT, steps - 10, 3000, output.data()), 10u);
+    EXPECT_EQ(read_pid_trace_steps(reader, steps, 1, read.data()), 0u);
+    close_pid_trace_reader(reader);
+
+    FILE *file = fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    EXPECT_LT(size, long(steps * sizeof(PIDTraceStepTypeDef_t) / 5));
+
+    remove(path.c_str());
+}
+
+/**
+ * @brief Special values and abrupt changes survive the encoding
+ */
+TEST(PID_TRACE_FILE, SPECIAL_VALUES)
+{
+    const float values[] = {0.0f, -0.0f, 1.0f, 1.0f, -1e30f, 1e-40f, INFINITY, -INFINITY, NAN, 3.5f, 3.5f, 3.25f};
+    const std::string path = temp_path("pid_trace_special.ptrc");
+    PIDTraceWriterTypeDef_t *writer = create_pid_trace_writer(path.c_str(), NULL, 5);
+    ASSERT_NE(writer, nullptr);
+    for (float value : values)
+    {
+        PIDTraceStepTypeDef_t step;
+        for (uint32_t column = 0; column < PID_TRACE_COLUMNS; column++)
+        {
+            step.value[column] = (column & 1) ? value : -value;
+        }
+        ASSERT_EQ(append_pid_trace_step(writer, &step), 0);
+    }
+    ASSERT_EQ(close_pid_trace_writer(writer), 0);
+
+    PIDTraceReaderTypeDef_t *reader = open_pid_trace_reader(path.c_str());
+    ASSERT_NE(reader, nullptr);
+    const uint32_t count = sizeof(values) / sizeof(values[0]);
+    EXPECT_EQ(get_pid_trace_header(reader)->blocks, 3u);
+    std::vector<PIDTraceStepTypeDef_t> read(count);
+    ASSERT_EQ(read_pid_trace_steps(reader, 0, count, read.data()), count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (uint32_t column = 0; column < PID_TRACE_COLUMNS; column++)
+        {
+            ASSERT_TRUE(same_bits(read[i].value[column], (column & 1) ? values[i] : -values[i])) << "row " << i;
+        }
+    }
+    close_pid_trace_reader(reader);
+    remove(path.c_str());
+
+    EXPECT_EQ(open_pid_trace_reader(temp_path("pid_trace_missing.ptrc").c_str()), nullptr);
+}
+
+/**
+ * @brief Overwrites size bytes at offset of a copy of the trace at source
+ */
+static void write_corrupt_copy(const std::string &source, const std::string &path, long offset, const void *bytes,
+                               size_t size)
+{
+    std::vector<char> contents;
+    FILE *file = fopen(source.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    char buffer[4096];
+    size_t read = 0;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        contents.insert(contents.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    memcpy(&contents[offset], bytes, size);
+    file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fwrite(contents.data(), 1, contents.size(), file), contents.size());
+    fclose(file);
+}
+
+/**
+ * @brief An index that does not cover the rows of the header exactly once, in order and within blockRows, is
+ *        rejected when the trace is opened rather than read out of bounds later
+ */
+TEST(PID_TRACE_FILE, CORRUPT_INDEX)
+{
+    const std::string path = temp_path("pid_trace_index.ptrc");
+    const std::string corrupt = temp_path("pid_trace_index_corrupt.ptrc");
+    PIDTraceWriterTypeDef_t *writer = create_pid_trace_writer(path.c_str(), NULL, 4);
+    ASSERT_NE(writer, nullptr);
+    PIDTraceStepTypeDef_t step = {};
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        step.value[PID_TRACE_MEASUREMENT] = float(i);
+        ASSERT_EQ(append_pid_trace_step(writer, &step), 0);
+    }
+    ASSERT_EQ(close_pid_trace_writer(writer), 0);
+
+    PIDTraceReaderTypeDef_t *reader = open_pid_trace_reader(path.c_str());
+    ASSERT_NE(reader, nullptr);
+    const PIDTraceFileHeaderTypeDef_t header = *get_pid_trace_header(reader);
+    close_pid_trace_reader(reader);
+    ASSERT_EQ(header.blocks, 3u);
+
+    const long blocksOffset = long(offsetof(PIDTraceFileHeaderTypeDef_t, blocks));
+    const long rowsOffset = long(offsetof(PIDTraceFileHeaderTypeDef_t, rows));
+    const long secondBlock = long(header.indexOffset + sizeof(PIDTraceFileBlockTypeDef_t));
+    const uint32_t noBlocks = 0;
+    const uint64_t moreRows = 11;
+    const uint64_t farRow = 1000000;
+    const uint32_t largeBlock = 5;
+
+    write_corrupt_copy(path, corrupt, blocksOffset, &noBlocks, sizeof(noBlocks));
+    EXPECT_EQ(open_pid_trace_reader(corrupt.c_str()), nullptr);
+    write_corrupt_copy(path, corrupt, rowsOffset, &moreRows, sizeof(moreRows));
+    EXPECT_EQ(open_pid_trace_reader(corrupt.c_str()), nullptr);
+    write_corrupt_copy(path, corrupt, secondBlock + long(offsetof(PIDTraceFileBlockTypeDef_t, firstRow)), &farRow,
+                       sizeof(farRow));
+    EXPECT_EQ(open_pid_trace_reader(corrupt.c_str()), nullptr);
+    write_corrupt_copy(path, corrupt, secondBlock + long(offsetof(PIDTraceFileBlockTypeDef_t, rows)), &largeBlock,
+                       sizeof(largeBlock));
+    EXPECT_EQ(open_pid_trace_reader(corrupt.c_str()), nullptr);
+
+    // The untouched copy still opens
+    write_corrupt_copy(path, corrupt, rowsOffset, &header.rows, sizeof(header.rows));
+    reader = open_pid_trace_reader(corrupt.c_str());
+    ASSERT_NE(reader, nullptr);
+    close_pid_trace_reader(reader);
+
+    remove(corrupt.c_str());
+    remove(path.c_str());
+}
+
+/**
+ * @brief A file without a position, here a pipe, cannot be indexed: the first block fails the writer and close
+ *        reports it
+ */
+TEST(PID_TRACE_FILE, UNSEEKABLE_FILE)
+{
+    const std::string path = temp_path("pid_trace_pipe.ptrc");
+    remove(path.c_str());
+    ASSERT_EQ(mkfifo(path.c_str(), 0600), 0);
+
+    // Drains the pipe so that the writer never blocks
+    std::thread reader([&path]() {
+        int fd = open(path.c_str(), O_RDONLY);
+        char buffer[4096];
+        while ((fd >= 0) && (read(fd, buffer, sizeof(buffer)) > 0))
+        {
+        }
+        close(fd);
+    });
+
+    PIDTraceWriterTypeDef_t *writer = create_pid_trace_writer(path.c_str(), NULL, 4);
+    ASSERT_NE(writer, nullptr);
+    PIDTraceStepTypeDef_t step = {};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(append_pid_trace_step(writer, &step), 0);
+    }
+    EXPECT_EQ(append_pid_trace_step(writer, &step), -1);
+    EXPECT_EQ(append_pid_trace_step(writer, &step), -1);
+    EXPECT_EQ(close_pid_trace_writer(writer), -1);
+
+    reader.join();
+    remove(path.c_str());
+}
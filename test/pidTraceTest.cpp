@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+#include "pidTestUtil.hpp"
+
+extern "C"
+{
+#include "pid_trace.h"
+}
+
+TEST(PID_TRACE, CAPACITY_MUST_BE_POWER_OF_TWO)
+{
+    EXPECT_EQ(create_pid_trace_ring(0), nullptr);
+    EXPECT_EQ(create_pid_trace_ring(1), nullptr);
+    EXPECT_EQ(create_pid_trace_ring(100), nullptr);
+
+    PIDTraceRingTypeDef_t *ring = create_pid_trace_ring(128);
+    EXPECT_NE(ring, nullptr);
+    destroy_pid_trace_ring(ring);
+}
+
+/**
+ * @brief Tracing does not change the output, and the records hold the state right after each step
+ */
+TEST(PID_TRACE, RECORDS_MATCH_STEPS)
+{
+    PIDTraceRingTypeDef_t *ring = create_pid_trace_ring(16);
+    ASSERT_NE(ring, nullptr);
+
+    PIDTypeDef_t traced = VOLTAGE_STAGE;
+    PIDTypeDef_t plain = VOLTAGE_STAGE;
+    std::vector<PIDTraceRecordTypeDef_t> records(16);
+
+    // Several wraps of the ring
+    for (uint32_t round = 0; round < 5; round++)
+    {
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            float measurement = 45.0f + 0.1f * i;
+            float output = calc_pid_output_traced(&traced, measurement, ring, 7);
+            ASSERT_EQ(output, calc_pid_output(&plain, measurement));
+        }
+
+        ASSERT_EQ(pop_pid_trace_batch(ring, records.data(), records.size()), 10u);
+        const PIDTraceRecordTypeDef_t &last = records[9];
+        EXPECT_EQ(last.sequence, round * 10 + 9u);
+        EXPECT_EQ(last.id, 7u);
+        EXPECT_EQ(last.measurement, 45.9f);
+        EXPECT_EQ(last.error, plain.error);
+        EXPECT_EQ(last.previousError, plain.previousError);
+        EXPECT_EQ(last.previousOutput, plain.previousOutput);
+        EXPECT_EQ(last.output, plain.previousOutput);
+    }
+
+    EXPECT_EQ(pop_pid_trace_batch(ring, records.data(), records.size()), 0u);
+    EXPECT_EQ(calc_pid_output_traced(&traced, 45, NULL, 0), calc_pid_output(&plain, 45));
+
+    destroy_pid_trace_ring(ring);
+}
+
+/**
+ * @brief A full ring drops and counts new records, leaving a gap in the sequence numbers
+ */
+TEST(PID_TRACE, FULL_RING_DROPS)
+{
+    PIDTraceRingTypeDef_t *ring = create_pid_trace_ring(4);
+    ASSERT_NE(ring, nullptr);
+
+    PIDTypeDef_t pid = VOLTAGE_STAGE;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        EXPECT_EQ(push_pid_trace(ring, i, 0, &pid, 0), (i < 4) ? 1 : 0);
+    }
+
+    EXPECT_EQ(get_pid_trace_pushed(ring), 6u);
+    EXPECT_EQ(get_pid_trace_dropped(ring), 2u);
+
+    PIDTraceRecordTypeDef_t records[4];
+    ASSERT_EQ(pop_pid_trace_batch(ring, records, 1), 1u);
+    EXPECT_EQ(push_pid_trace(ring, 6, 0, &pid, 0), 1);
+
+    ASSERT_EQ(pop_pid_trace_batch(ring, records, 4), 4u);
+    EXPECT_EQ(records[2].id, 3u);
+    EXPECT_EQ(records[3].id, 6u);
+    EXPECT_EQ(records[3].sequence, 6u);
+
+    destroy_pid_trace_ring(ring);
+}
+
+struct Collected
+{
+    uint64_t count = 0;
+    uint64_t lastSequence = 0;
+    bool ordered = true;
+};
+
+static void collect(void *context, const PIDTraceRecordTypeDef_t *records, uint32_t count)
+{
+    Collected &collected = *static_cast<Collected *>(context);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if ((collected.count > 0) && (records[i].sequence <= collected.lastSequence))
+        {
+            collected.ordered = false;
+        }
+        collected.lastSequence = records[i].sequence;
+        collected.count++;
+    }
+}
+
+/**
+ * @brief The consumer thread delivers every record that was not dropped, in order, before stop returns
+ */
+TEST(PID_TRACE, CONSUMER_THREAD)
+{
+    PIDTraceRingTypeDef_t *ring = create_pid_trace_ring(1024);
+    ASSERT_NE(ring, nullptr);
+
+    Collected collected;
+    ASSERT_EQ(start_pid_trace_consumer(ring, collect, &collected, 256, 50), 0);
+    EXPECT_EQ(start_pid_trace_consumer(ring, collect, &collected, 256, 50), -1);
+
+    PIDTypeDef_t pid = VOLTAGE_STAGE;
+    const uint32_t steps = 200000;
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        calc_pid_output_traced(&pid, 45.0f + (i % 100) * 0.01f, ring, 0);
+        if ((i % 1000) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    stop_pid_trace_consumer(ring);
+
+    EXPECT_EQ(get_pid_trace_pushed(ring), steps);
+    EXPECT_EQ(collected.count + get_pid_trace_dropped(ring), steps);
+    EXPECT_TRUE(collected.ordered);
+
+    destroy_pid_trace_ring(ring);
+}
@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pid_replay.h"
+
+/**
+ * @brief Replays a binary sample log through one controller per channel and writes the outputs to a result log of
+ *        the same shape. Both files are memory mapped, rows outside the replayed window are left at zero.
+ *
+ *        pidReplay <input> <output> [--batch] [--from SECONDS] [--duration SECONDS]
+ *                  [--kp X] [--ki X] [--upper X] [--lower X] [--reference X]
+ */
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s <input> <output> [--batch] [--from SECONDS] [--duration SECONDS] [--kp X] [--ki X] "
+            "[--upper X] [--lower X] [--reference X]\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *inputPath = argv[1];
+    const char *outputPath = argv[2];
+    uint8_t batch = 0;
+    double from = 0;
+    double duration = -1;
+    PIDTypeDef_t controller = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--batch") == 0)
+        {
+            batch = 1;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        if (strcmp(argv[i], "--from") == 0)
+        {
+            from = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--duration") == 0)
+        {
+            duration = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--kp") == 0)
+        {
+            controller.KP = strtof(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--ki") == 0)
+        {
+            controller.kI = strtof(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--upper") == 0)
+        {
+            controller.upperLimit = strtof(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--lower") == 0)
+        {
+            controller.lowerLimit = strtof(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--reference") == 0)
+        {
+            controller.referencePoint = strtof(argv[++i], NULL);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    PIDSampleLogTypeDef_t input;
+    if (open_pid_sample_log(inputPath, &input) != 0)
+    {
+        fprintf(stderr, "cannot open sample log %s\n", inputPath);
+        return 1;
+    }
+
+    const PIDSampleLogHeaderTypeDef_t *header = input.header;
+    PIDSampleLogTypeDef_t output;
+    if (create_pid_sample_log(outputPath, header->channels, header->samples, header->startTimeNs,
+                              header->samplePeriodNs, &output) != 0)
+    {
+        fprintf(stderr, "cannot create result log %s\n", outputPath);
+        close_pid_sample_log(&input);
+        return 1;
+    }
+
+    uint64_t first = find_pid_sample_index(&input, header->startTimeNs + (uint64_t)(from * 1e9));
+    uint64_t last = (duration < 0) ? header->samples
+                                   : find_pid_sample_index(&input, header->startTimeNs +
+                                                                       (uint64_t)((from + duration) * 1e9));
+    uint64_t count = last - first;
+
+    const uint32_t channels = header->channels;
+    PIDTypeDef_t *controllers = malloc(sizeof(*controllers) * channels);
+    float *columns = malloc(sizeof(float) * channels * 8);
+    if ((controllers == NULL) || (columns == NULL))
+    {
+        fprintf(stderr, "cannot allocate %u controllers\n", channels);
+        return 1;
+    }
+
+    PIDBankTypeDef_t bank = {columns, columns + channels, columns + (2 * channels), columns + (3 * channels),
+                             columns + (4 * channels), columns + (5 * channels), columns + (6 * channels),
+                             columns + (7 * channels), channels};
+    for (uint32_t i = 0; i < channels; i++)
+    {
+        controllers[i] = controller;
+        load_pid_bank_entry(&bank, i, &controller);
+    }
+
+    struct timespec start;
+    struct timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int status = batch ? replay_pid_samples_batch(&bank, &input, &output, first, count)
+                       : replay_pid_samples(controllers, &input, &output, first, count);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    if (status != 0)
+    {
+        fprintf(stderr, "replay failed\n");
+        return 1;
+    }
+
+    double seconds = (double)(stop.tv_sec - start.tv_sec) + ((double)(stop.tv_nsec - start.tv_nsec) * 1e-9);
+    double bytes = 2.0 * (double)count * channels * sizeof(float);
+    fprintf(stderr, "%llu rows of %u channels from row %llu in %.3f s, %.2f GB/s\n", (unsigned long long)count,
+            channels, (unsigned long long)first, seconds, (seconds > 0) ? bytes / seconds * 1e-9 : 0.0);
+
+    free(controllers);
+    free(columns);
+    close_pid_sample_log(&output);
+    close_pid_sample_log(&input);
+    return 0;
+}
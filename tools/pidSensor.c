@@ -0,0 +1,174 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pid_shm.h"
+
+/**
+ * @brief Stand-in for the acquisition process, and a control process to pair it with, over a shared-memory segment.
+ *
+ *        pidSensor serve <name> <channels> <frames>
+ *            creates the segment, steps one voltage stage per channel for every measurement frame and exits after
+ *            frames frames
+ *        pidSensor produce <name> <frames> [--rate HZ]
+ *            attaches to the segment, produces frames of a slowly rising pack voltage, as fast as possible unless a
+ *            rate is given, drains the outputs after every frame and reports drops and the round-trip latency
+ */
+
+#define PID_SENSOR_CAPACITY 1024
+#define PID_SENSOR_TIMEOUT_NS 5000000000u
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s serve <name> <channels> <frames>\n       %s produce <name> <frames> [--rate HZ]\n",
+            name, name);
+}
+
+static uint64_t get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+static int serve(const char *name, uint32_t channels, uint64_t frames)
+{
+    PIDShmTypeDef_t shm;
+    if (create_pid_shm(name, channels, PID_SENSOR_CAPACITY, &shm) != 0)
+    {
+        fprintf(stderr, "cannot create segment %s\n", name);
+        return 1;
+    }
+
+    const PIDTypeDef_t controller = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    float *columns = malloc(sizeof(float) * channels * 8);
+    if (columns == NULL)
+    {
+        fprintf(stderr, "cannot allocate %u controllers\n", channels);
+        close_pid_shm(&shm);
+        unlink_pid_shm(name);
+        return 1;
+    }
+
+    PIDBankTypeDef_t bank = {columns, columns + channels, columns + (2 * channels), columns + (3 * channels),
+                             columns + (4 * channels), columns + (5 * channels), columns + (6 * channels),
+                             columns + (7 * channels), channels};
+    for (uint32_t i = 0; i < channels; i++)
+    {
+        load_pid_bank_entry(&bank, i, &controller);
+    }
+
+    fprintf(stderr, "serving %u channels on %s\n", channels, name);
+    uint64_t processed = 0;
+    while (processed < frames)
+    {
+        if (wait_pid_shm_frame(&shm, PID_SHM_MEASUREMENT, PID_SENSOR_TIMEOUT_NS) != 0)
+        {
+            fprintf(stderr, "no measurement for 5 s, giving up after %llu frames\n", (unsigned long long)processed);
+            break;
+        }
+        processed += step_pid_shm_batch(&bank, &shm, PID_SENSOR_CAPACITY);
+    }
+
+    free(columns);
+    close_pid_shm(&shm);
+    unlink_pid_shm(name);
+    return 0;
+}
+
+static void drain(PIDShmTypeDef_t *shm, uint64_t *received, uint64_t *latencySum, uint64_t *latencyMax)
+{
+    const PIDShmFrameTypeDef_t *output;
+    while ((output = peek_pid_shm_frame(shm, PID_SHM_OUTPUT)) != NULL)
+    {
+        uint64_t latency = get_monotonic_ns() - output->timestampNs;
+        *latencySum += latency;
+        *latencyMax = (latency > *latencyMax) ? latency : *latencyMax;
+        (*received)++;
+        release_pid_shm_frame(shm, PID_SHM_OUTPUT);
+    }
+}
+
+static int produce(const char *name, uint64_t frames, double rate)
+{
+    PIDShmTypeDef_t shm;
+    if (open_pid_shm(name, &shm) != 0)
+    {
+        fprintf(stderr, "cannot open segment %s\n", name);
+        return 1;
+    }
+
+    const uint64_t periodNs = (rate > 0) ? (uint64_t)(1e9 / rate) : 0;
+    uint64_t received = 0;
+    uint64_t latencySum = 0;
+    uint64_t latencyMax = 0;
+    const uint64_t start = get_monotonic_ns();
+    for (uint64_t frame = 0; frame < frames; frame++)
+    {
+        if (periodNs > 0)
+        {
+            const uint64_t due = start + (frame * periodNs);
+            const struct timespec wake = {.tv_sec = (time_t)(due / 1000000000u), .tv_nsec = (long)(due % 1000000000u)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+        }
+
+        PIDShmFrameTypeDef_t *slot = begin_pid_shm_write(&shm, PID_SHM_MEASUREMENT);
+        if (slot != NULL)
+        {
+            float *values = pid_shm_frame_values(slot);
+            for (uint32_t channel = 0; channel < shm.channels; channel++)
+            {
+                values[channel] = 45.0f + (0.001f * (float)(frame % 5000)) + (0.01f * (float)channel);
+            }
+            commit_pid_shm_write(&shm, PID_SHM_MEASUREMENT, get_monotonic_ns());
+        }
+
+        drain(&shm, &received, &latencySum, &latencyMax);
+    }
+
+    const uint64_t sent = frames - get_pid_shm_dropped(&shm, PID_SHM_MEASUREMENT);
+    while ((received < sent) && (wait_pid_shm_frame(&shm, PID_SHM_OUTPUT, PID_SENSOR_TIMEOUT_NS) == 0))
+    {
+        drain(&shm, &received, &latencySum, &latencyMax);
+    }
+
+    const double seconds = (double)(get_monotonic_ns() - start) * 1e-9;
+    fprintf(stderr, "%llu frames of %u channels sent, %llu dropped, %llu outputs in %.3f s (%.0f frames/s)\n",
+            (unsigned long long)sent, shm.channels, (unsigned long long)get_pid_shm_dropped(&shm, PID_SHM_MEASUREMENT),
+            (unsigned long long)received, seconds, (seconds > 0) ? (double)received / seconds : 0.0);
+    if (received > 0)
+    {
+        fprintf(stderr, "round trip: mean %.0f ns, max %llu ns\n", (double)latencySum / (double)received,
+                (unsigned long long)latencyMax);
+    }
+
+    close_pid_shm(&shm);
+    return (received == sent) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if ((argc >= 5) && (strcmp(argv[1], "serve") == 0))
+    {
+        return serve(argv[2], (uint32_t)strtoul(argv[3], NULL, 10), strtoull(argv[4], NULL, 10));
+    }
+
+    if ((argc >= 4) && (strcmp(argv[1], "produce") == 0))
+    {
+        double rate = 0;
+        if ((argc == 6) && (strcmp(argv[4], "--rate") == 0))
+        {
+            rate = strtod(argv[5], NULL);
+        }
+        else if (argc != 4)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        return produce(argv[2], strtoull(argv[3], NULL, 10), rate);
+    }
+
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pid_steal.h"
+#include "pid_sweep.h"
+
+/**
+ * @brief Gain sweep over the closed-loop CC/CV simulation. Runs a grid (default) or a random sample of gain sets on
+ *        every core and prints the best candidates as CSV.
+ *
+ *        pidSweep [--threads N] [--points N] [--random N] [--seed S] [--top K] [--soc X]
+ */
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [--threads N] [--points N] [--random N] [--seed S] [--top K] [--soc X]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t threads = 0;
+    uint32_t points = 4;
+    uint32_t randomCount = 0;
+    uint64_t seed = 1;
+    uint32_t top = 10;
+    float stateOfCharge = 0.1f;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        if (strcmp(argv[i], "--threads") == 0)
+        {
+            threads = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--points") == 0)
+        {
+            points = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--random") == 0)
+        {
+            randomCount = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            seed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--top") == 0)
+        {
+            top = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--soc") == 0)
+        {
+            stateOfCharge = strtof(argv[++i], NULL);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Around the gains of CC_CV_TRANSITION_TEST
+    PIDSweepRangeTypeDef_t ranges[PID_SWEEP_PARAMETERS] = {
+        [PID_SWEEP_VOLTAGE_KP] = {0, 8, points},
+        [PID_SWEEP_VOLTAGE_KI] = {0.05f, 1.5f, points},
+        [PID_SWEEP_CURRENT_KP] = {0, 0, 1},
+        [PID_SWEEP_CURRENT_KI] = {0.1f, 1.5f, points},
+        [PID_SWEEP_CHARGE_CURRENT] = {2, 4, points},
+    };
+
+    PIDTypeDef_t voltageStage = {.kI = 0.75, .KP = 4, .upperLimit = 3, .lowerLimit = 0, .referencePoint = 49.6};
+    PIDTypeDef_t currentStage = {.kI = 0.75, .KP = 0, .upperLimit = 100, .lowerLimit = 0};
+
+    PIDSweepConfigTypeDef_t config;
+    load_cascade_stages(&config.baseline, &voltageStage, &currentStage);
+    get_pid_plant_default_config(&config.plant);
+    config.initialStateOfCharge = stateOfCharge;
+    config.limits.terminationCurrent = config.plant.capacityAh / 20;
+    config.limits.settlingBand = 0.01f;
+    config.limits.maxSteps = 20000000;
+    config.overshootPenalty = 1000;
+    config.saturationPenalty = 1;
+    config.threads = threads;
+
+    uint32_t count = (randomCount > 0) ? randomCount : build_pid_sweep_grid(ranges, NULL, 0);
+    PIDSweepCandidateTypeDef_t *candidates = malloc(sizeof(*candidates) * count);
+    PIDSweepResultTypeDef_t *results = malloc(sizeof(*results) * count);
+    if ((candidates == NULL) || (results == NULL))
+    {
+        fprintf(stderr, "cannot allocate %u candidates\n", count);
+        return 1;
+    }
+
+    if (randomCount > 0)
+    {
+        build_pid_sweep_random(ranges, seed, candidates, count);
+    }
+    else
+    {
+        build_pid_sweep_grid(ranges, candidates, count);
+    }
+
+    struct timespec start;
+    struct timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (run_pid_sweep(&config, candidates, count, results) != 0)
+    {
+        fprintf(stderr, "sweep failed\n");
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    double seconds = (double)(stop.tv_sec - start.tv_sec) + ((double)(stop.tv_nsec - start.tv_nsec) * 1e-9);
+    fprintf(stderr, "%u candidates on %u threads in %.3f s\n", count,
+            (threads > 0) ? threads : get_pid_hardware_threads(), seconds);
+
+    printf("rank,voltage_kp,voltage_ki,current_kp,current_ki,charge_current,score,charge_time,settling_time,"
+           "overshoot,saturation_time,terminated\n");
+    for (uint32_t i = 0; (i < count) && (i < top); i++)
+    {
+        const PIDSweepResultTypeDef_t *result = &results[i];
+        const float *value = candidates[result->candidate].value;
+        printf("%u,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%u\n", i + 1, value[PID_SWEEP_VOLTAGE_KP],
+               value[PID_SWEEP_VOLTAGE_KI], value[PID_SWEEP_CURRENT_KP], value[PID_SWEEP_CURRENT_KI],
+               value[PID_SWEEP_CHARGE_CURRENT], result->score, result->charge.chargeTime,
+               result->charge.settlingTime, result->charge.overshoot, result->charge.saturationTime,
+               result->charge.terminated);
+    }
+
+    free(candidates);
+    free(results);
+    return 0;
+}
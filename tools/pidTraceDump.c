@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pid_trace_file.h"
+
+/**
+ * @brief Prints a window of a columnar trace file as CSV, either every column or a single one.
+ *
+ *        pidTraceDump <trace> [--from ROW] [--count N] [--column NAME]
+ */
+
+static const char *const COLUMN_NAMES[PID_TRACE_COLUMNS] = {
+    [PID_TRACE_REFERENCE] = "reference",
+    [PID_TRACE_MEASUREMENT] = "measurement",
+    [PID_TRACE_ERROR] = "error",
+    [PID_TRACE_PREVIOUS_ERROR] = "previous_error",
+    [PID_TRACE_PREVIOUS_OUTPUT] = "previous_output",
+    [PID_TRACE_OUTPUT] = "output",
+};
+
+#define DUMP_CHUNK 4096
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s <trace> [--from ROW] [--count N] [--column NAME]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint64_t from = 0;
+    uint64_t count = UINT64_MAX;
+    int column = -1;
+    for (int i = 2; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        if (strcmp(argv[i], "--from") == 0)
+        {
+            from = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--count") == 0)
+        {
+            count = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--column") == 0)
+        {
+            const char *name = argv[++i];
+            for (int c = 0; c < PID_TRACE_COLUMNS; c++)
+            {
+                if (strcmp(name, COLUMN_NAMES[c]) == 0)
+                {
+                    column = c;
+                }
+            }
+
+            if (column < 0)
+            {
+                fprintf(stderr, "unknown column %s\n", name);
+                return 1;
+            }
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    PIDTraceReaderTypeDef_t *reader = open_pid_trace_reader(argv[1]);
+    if (reader == NULL)
+    {
+        fprintf(stderr, "cannot open trace %s\n", argv[1]);
+        return 1;
+    }
+
+    const PIDTraceFileHeaderTypeDef_t *header = get_pid_trace_header(reader);
+    fprintf(stderr, "%llu rows in %u blocks, kI %g KP %g kD %g limits [%g, %g]\n", (unsigned long long)header->rows,
+            header->blocks, header->kI, header->KP, header->kD, header->lowerLimit, header->upperLimit);
+
+    printf("row");
+    for (int c = 0; c < PID_TRACE_COLUMNS; c++)
+    {
+        if ((column < 0) || (column == c))
+        {
+            printf(",%s", COLUMN_NAMES[c]);
+        }
+    }
+    printf("\n");
+
+    static PIDTraceStepTypeDef_t steps[DUMP_CHUNK];
+    static float values[DUMP_CHUNK];
+    uint64_t row = from;
+    while (count > 0)
+    {
+        uint64_t want = (count < DUMP_CHUNK) ? count : DUMP_CHUNK;
+        uint64_t got = (column < 0) ? read_pid_trace_steps(reader, row, want, steps)
+                                    : read_pid_trace_column(reader, (PIDTraceColumn_t)column, row, want, values);
+        if (got == 0)
+        {
+            break;
+        }
+
+        for (uint64_t i = 0; i < got; i++)
+        {
+            printf("%llu", (unsigned long long)(row + i));
+            if (column < 0)
+            {
+                for (int c = 0; c < PID_TRACE_COLUMNS; c++)
+                {
+                    printf(",%.9g", steps[i].value[c]);
+                }
+            }
+            else
+            {
+                printf(",%.9g", values[i]);
+            }
+            printf("\n");
+        }
+
+        row += got;
+        count -= got;
+    }
+
+    close_pid_trace_reader(reader);
+    return 0;
+}